@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file    audio_capture.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for audio_capture.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_CAPTURE_H
+#define __AUDIO_CAPTURE_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_type.h"
+#include "usb_desc.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* ADC samples ring filled by the circular DMA (power of 2) */
+#define AUDIO_CAP_RING              256
+/* Samples left in the ring after each packet, and the distance from it
+   before one sample more or less is sent */
+#define AUDIO_CAP_TARGET            64
+#define AUDIO_CAP_SLACK             8
+/* Frames without IN transfer after which the ring is read again from the
+   target level */
+#define AUDIO_CAP_IDLE              2
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported variables --------------------------------------------------------*/
+extern uint16_t Audio_Capture_Buffer[AUDIO_CAP_RING];
+
+/* Exported functions ------------------------------------------------------- */
+void Audio_Capture_Init(uint32_t Freq);
+void Audio_Capture_SOF(void);
+void Audio_Capture_Sent(void);
+
+#endif /* __AUDIO_CAPTURE_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
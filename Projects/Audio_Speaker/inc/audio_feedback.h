@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file    audio_feedback.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for audio_feedback.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_FEEDBACK_H
+#define __AUDIO_FEEDBACK_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_type.h"
+#include "usb_desc.h"
+#include "audio_ring.h"
+#include "audio_play.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* Feedback period, 2^AUDIO_FB_REFRESH frames (bRefresh of the endpoint) */
+#define AUDIO_FB_REFRESH            6
+#define AUDIO_FB_PERIOD             (1 << AUDIO_FB_REFRESH)
+
+/* Nominal rate of a sampling frequency in 10.14 frames per USB frame */
+#define AUDIO_FB_NOMINAL(Freq)      (((uint32_t) (Freq) << 14) / 1000)
+/* The reported rate stays within one frame per ms of the nominal one */
+#define AUDIO_FB_RANGE              (1 << 14)
+/* Playback level aimed at: the ring at its target, the DMA buffer holding
+   one half to two halves */
+#define AUDIO_FB_TARGET             (AUDIO_RING_TARGET + (3 * AUDIO_PLAY_FRAMES) / 2)
+/* Level error to feedback: 1/512 frame per ms per frame */
+#define AUDIO_FB_GAIN_SHIFT         5
+/* Frames without OUT packet after which the stream is seen as stopped */
+#define AUDIO_FB_IDLE               2
+
+#define AUDIO_FB_SIZE               3	/* 10.14 value on 3 bytes */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void Audio_Feedback_Init(uint32_t Freq);
+void Audio_Feedback_SOF(void);
+void Audio_Feedback_Sent(void);
+
+#endif /* __AUDIO_FEEDBACK_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,62 @@
+/**
+  ******************************************************************************
+  * @file    audio_play.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for audio_play.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_PLAY_H
+#define __AUDIO_PLAY_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "platform_config.h"
+#include "usb_type.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* Output words per frame: the I2S plays the left and right channels, the PWM
+   and the DAC their mean */
+#if defined (USE_STM3210E_EVAL)
+#define AUDIO_PLAY_CHANNELS         2
+#else
+#define AUDIO_PLAY_CHANNELS         1
+#endif /* USE_STM3210E_EVAL */
+
+/* Frames taken from the jitter ring per half of the DMA buffer */
+#define AUDIO_PLAY_FRAMES           48
+#define AUDIO_PLAY_HALF             (AUDIO_PLAY_FRAMES * AUDIO_PLAY_CHANNELS)
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported variables --------------------------------------------------------*/
+extern int16_t Audio_Play_Buffer[2 * AUDIO_PLAY_HALF];
+
+/* Exported functions ------------------------------------------------------- */
+void Audio_Play_Init(void);
+void Audio_Play_Fill(uint8_t Half);
+uint32_t Audio_Play_Clock(void);
+uint32_t Audio_Play_Level(void);
+
+#endif /* __AUDIO_PLAY_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file    audio_ring.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for audio_ring.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_RING_H
+#define __AUDIO_RING_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_type.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Statistics returned by AUDIO_REQ_GET_STATS, all fields little endian */
+typedef struct _AUDIO_RING_STATS {
+	uint32_t Packets;	/* OUT packets stored */
+	uint32_t Overruns;	/* OUT packets dropped, the ring was full */
+	uint32_t Underruns;	/* ring found empty while playing */
+	uint32_t Level;		/* frames in the ring */
+	uint32_t Target;	/* fill level reached before playing */
+} AUDIO_RING_STATS;
+
+/* Exported constants --------------------------------------------------------*/
+/* Ring size in stereo frames (power of 2): 512 frames are 10.7 ms at 48 kHz,
+   32 ms at 16 kHz */
+#define AUDIO_RING_SIZE             512
+/* Frames buffered before playing starts or resumes after an underrun */
+#define AUDIO_RING_TARGET           (AUDIO_RING_SIZE / 2)
+/* A frame holds the left 16-bit sample in its low half, the right one in its
+   high half */
+#define AUDIO_RING_SILENCE          0
+
+/* Vendor requests, device recipient */
+#define AUDIO_REQ_GET_STATS         0x01	/* wLength: sizeof(AUDIO_RING_STATS) */
+#define AUDIO_REQ_CLEAR_STATS       0x02
+
+#if (AUDIO_RING_SIZE & (AUDIO_RING_SIZE - 1)) \
+    || (AUDIO_RING_TARGET >= AUDIO_RING_SIZE)
+#error "AUDIO_RING_SIZE must be a power of 2 above AUDIO_RING_TARGET"
+#endif
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void Audio_Ring_Init(void);
+void Audio_Ring_Put(uint16_t wPMABufAddr, uint16_t wNBytes);
+uint32_t Audio_Ring_Get(void);
+uint32_t Audio_Ring_Level(void);
+void Audio_Ring_ClearStats(void);
+uint8_t *Audio_Ring_GetStats(uint16_t Length);
+
+#endif /* __AUDIO_RING_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file    audio_volume.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for audio_volume.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_VOLUME_H
+#define __AUDIO_VOLUME_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "platform_config.h"
+#include "usb_type.h"
+#include "audio_play.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* Feature unit volume range in 1/256 dB */
+#define AUDIO_VOL_MIN               ((int16_t) -48 * 256)
+#define AUDIO_VOL_MAX               ((int16_t) 0)
+#define AUDIO_VOL_RES               ((int16_t) 256)
+#define AUDIO_VOL_SILENCE           ((int16_t) 0x8000)	/* -infinity */
+
+/* Q15 gain of AUDIO_VOL_MAX */
+#define AUDIO_VOL_UNITY             0x7FFF
+
+/* Gain steps per refilled half: each segment is scaled with its own gain */
+#define AUDIO_VOL_SEGMENTS          8
+/* Largest gain change between two segments, a full mute ramp lasting
+   0x8000 / AUDIO_VOL_STEP segments (4 ms at 48 kHz) */
+#define AUDIO_VOL_STEP              1024
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void Audio_Volume_Init(void);
+void Audio_Volume_Apply(int16_t * pBlock, uint32_t Frames);
+#if (AUDIO_PLAY_CHANNELS == 1)
+void Audio_Volume_Convert(int16_t * pBlock, uint32_t Samples);
+#endif /* AUDIO_PLAY_CHANNELS */
+
+#endif /* __AUDIO_VOLUME_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -60,6 +60,9 @@ void USB_Config(void);
 void Audio_Config(void);
 void USB_Cable_Config(FunctionalState NewState);
 void Speaker_Config(void);
+void Speaker_SetFreq(uint32_t Freq);
+void Capture_Config(void);
+void Capture_SetFreq(uint32_t Freq);
 void NVIC_Config(void);
 void GPIO_Config(void);
 uint32_t Sound_release(uint16_t Standard, uint16_t MCLKOutput,
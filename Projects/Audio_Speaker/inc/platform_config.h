@@ -120,6 +120,53 @@
 
 #endif /* USE_STM3210B_EVAL */
 
+/* DMA1 channel feeding the audio output and the register it writes: the I2S
+   data register, the TIM4 channel 3 8-bit PWM duty cycle on TIM2 update, or
+   the DAC channel 1 12-bit right aligned holding register on TIM6 trigger.
+   The shift scales a 16-bit sample to the register width. */
+#if defined (USE_STM3210E_EVAL)
+#define AUDIO_OUT_DMA_CHANNEL               DMA1_Channel5
+#define AUDIO_OUT_DMA_IRQn                  DMA1_Channel5_IRQn
+#define AUDIO_OUT_DMA_IRQHandler            DMA1_Channel5_IRQHandler
+#define AUDIO_OUT_DMA_IT_HT                 DMA1_IT_HT5
+#define AUDIO_OUT_DMA_IT_TC                 DMA1_IT_TC5
+#define AUDIO_OUT_DATA_ADDRESS              ((uint32_t)&SPI2->DR)
+#define AUDIO_OUT_DATA_SIZE                 DMA_PeripheralDataSize_HalfWord
+#else
+#define AUDIO_OUT_DMA_CHANNEL               DMA1_Channel2
+#define AUDIO_OUT_DMA_IRQn                  DMA1_Channel2_IRQn
+#define AUDIO_OUT_DMA_IRQHandler            DMA1_Channel2_IRQHandler
+#define AUDIO_OUT_DMA_IT_HT                 DMA1_IT_HT2
+#define AUDIO_OUT_DMA_IT_TC                 DMA1_IT_TC2
+#if defined (USE_STM3210B_EVAL)
+#define AUDIO_OUT_DATA_ADDRESS              ((uint32_t)&TIM4->CCR3)
+#define AUDIO_OUT_DATA_SIZE                 DMA_PeripheralDataSize_HalfWord
+#define AUDIO_OUT_DATA_SHIFT                8
+#else
+#define AUDIO_OUT_DATA_ADDRESS              ((uint32_t)&DAC->DHR12R1)
+#define AUDIO_OUT_DATA_SIZE                 DMA_PeripheralDataSize_Word
+#define AUDIO_OUT_DATA_SHIFT                4
+#endif /* USE_STM3210B_EVAL */
+#endif /* USE_STM3210E_EVAL */
+
+/* Analog input captured by ADC1 on each TIM3 update (TRGO), read by DMA1
+   channel 1: the potentiometer input of the evaluation board */
+#define AUDIO_IN_DMA_CHANNEL                DMA1_Channel1
+#define AUDIO_IN_DATA_ADDRESS               ((uint32_t)&ADC1->DR)
+#if defined (USE_STM32L152_EVAL)
+#define RCC_AHBPeriph_GPIO_AUDIO_IN         RCC_AHBPeriph_GPIOB
+#define AUDIO_IN_GPIO                       GPIOB
+#define AUDIO_IN_PIN                        GPIO_Pin_12	/* PB.12 */
+#define AUDIO_IN_CHANNEL                    ADC_Channel_18
+#define AUDIO_IN_SAMPLE_TIME                ADC_SampleTime_48Cycles
+#else
+#define RCC_APB2Periph_GPIO_AUDIO_IN        RCC_APB2Periph_GPIOC
+#define AUDIO_IN_GPIO                       GPIOC
+#define AUDIO_IN_PIN                        GPIO_Pin_4	/* PC.04 */
+#define AUDIO_IN_CHANNEL                    ADC_Channel_14
+#define AUDIO_IN_SAMPLE_TIME                ADC_SampleTime_55Cycles5
+#endif /* USE_STM32L152_EVAL */
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 
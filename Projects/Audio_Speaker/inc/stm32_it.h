@@ -50,9 +50,7 @@ void USB_HP_CAN1_TX_IRQHandler(void);
 void USB_LP_CAN1_RX0_IRQHandler(void);
 void USBWakeUp_IRQHandler(void);
 void USB_FS_WKUP_IRQHandler(void);
-#ifdef USE_STM3210B_EVAL
-void TIM2_IRQHandler(void);
-#endif /* USE_STM3210B_EVAL */
+void AUDIO_OUT_DMA_IRQHandler(void);
 #if defined (USE_STM3210E_EVAL)
 void SPI2_IRQHandler(void);
 #endif /* USE_STM3210E_EVAL */
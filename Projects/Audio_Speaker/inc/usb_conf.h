@@ -29,12 +29,26 @@
 #ifndef __USB_CONF_H
 #define __USB_CONF_H
 
+/*-------------------------------------------------------------*/
+/* AUDIO_CAPTURE */
+/* adds the analog input capture function (EP3 IN, 16 or 32 kHz) */
+/* next to the speaker. The 512-byte packet memory does not */
+/* hold both streams at 44.1 or 48 kHz: defining it limits the */
+/* speaker to 16 and 32 kHz too. Left undefined, the speaker */
+/* alone offers 16, 32, 44.1 and 48 kHz. */
+/*-------------------------------------------------------------*/
+/* #define AUDIO_CAPTURE */
+
 /*-------------------------------------------------------------*/
 /* EP_NUM */
 /* defines how many endpoints are used by the device */
 /*-------------------------------------------------------------*/
 
-#define EP_NUM              (2)
+#ifdef AUDIO_CAPTURE
+#define EP_NUM              (4)
+#else
+#define EP_NUM              (3)
+#endif /* AUDIO_CAPTURE */
 
 /*-------------------------------------------------------------*/
 /* --------------   Buffer Description Table  -----------------*/
@@ -43,15 +57,43 @@
 /* buffer table base address */
 #define BTABLE_ADDRESS      (0x00)
 
+#ifdef AUDIO_CAPTURE
 /* EP0  */
 /* rx/tx buffer base address */
-#define ENDP0_RXADDR        (0x10)
-#define ENDP0_TXADDR        (0x50)
+#define ENDP0_RXADDR        (0x20)
+#define ENDP0_TXADDR        (0x40)
 
 /* EP1  */
-/* buffer base address */
-#define ENDP1_BUF0Addr      (0x90)
-#define ENDP1_BUF1Addr      (0xC0)
+/* buffer base address, 132-byte packets at 32 kHz */
+#define ENDP1_BUF0Addr      (0x60)
+#define ENDP1_BUF1Addr      (0xE8)
+
+/* EP2  */
+/* feedback buffers base address */
+#define ENDP2_BUF0Addr      (0x170)
+#define ENDP2_BUF1Addr      (0x174)
+
+/* EP3  */
+/* capture buffers base address, 66-byte packets at 32 kHz */
+#define ENDP3_BUF0Addr      (0x178)
+#define ENDP3_BUF1Addr      (0x1BC)
+
+#else
+/* EP0  */
+/* rx/tx buffer base address */
+#define ENDP0_RXADDR        (0x18)
+#define ENDP0_TXADDR        (0x38)
+
+/* EP1  */
+/* buffer base address, 196-byte packets at 48 kHz */
+#define ENDP1_BUF0Addr      (0x58)
+#define ENDP1_BUF1Addr      (0x120)
+
+/* EP2  */
+/* feedback buffers base address */
+#define ENDP2_BUF0Addr      (0x1E8)
+#define ENDP2_BUF1Addr      (0x1EC)
+#endif /* AUDIO_CAPTURE */
 
 /*-------------------------------------------------------------*/
 /* -------------------   ISTR events  -------------------------*/
@@ -74,8 +116,10 @@
 /* CTR service routines */
 /* associated to defined endpoints */
 #define  EP1_IN_Callback   NOP_Process
-#define  EP2_IN_Callback   NOP_Process
+/*#define  EP2_IN_Callback   NOP_Process*/
+#ifndef AUDIO_CAPTURE
 #define  EP3_IN_Callback   NOP_Process
+#endif /* AUDIO_CAPTURE */
 #define  EP4_IN_Callback   NOP_Process
 #define  EP5_IN_Callback   NOP_Process
 #define  EP6_IN_Callback   NOP_Process
@@ -30,13 +30,22 @@
 #define __USB_DESC_H
 
 /* Includes ------------------------------------------------------------------*/
+#include "usb_conf.h"
+
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /* Exported define -----------------------------------------------------------*/
 
 #define SPEAKER_SIZ_DEVICE_DESC                       18
-#define SPEAKER_SIZ_CONFIG_DESC                       109
+#ifdef AUDIO_CAPTURE
+/* The capture adds its two terminals and streaming interface */
+#define SPEAKER_SIZ_CONFIG_DESC                       199
+#define AUDIO_NUM_INTERFACES                          3
+#else
+#define SPEAKER_SIZ_CONFIG_DESC                       128
+#define AUDIO_NUM_INTERFACES                          2
+#endif /* AUDIO_CAPTURE */
 #define SPEAKER_SIZ_INTERFACE_DESC_SIZE               9
 
 #define SPEAKER_SIZ_STRING_LANGID                     0x04
@@ -75,12 +84,63 @@
 #define AUDIO_STREAMING_INTERFACE_DESC_SIZE           0x07
 
 #define AUDIO_CONTROL_MUTE                            0x0001
+#define AUDIO_CONTROL_VOLUME                          0x0002
+
+/* Audio Feature Unit Control Selectors */
+#define AUDIO_FU_MUTE_CONTROL                         0x01
+#define AUDIO_FU_VOLUME_CONTROL                       0x02
+
+/* Audio Endpoint Control Selectors */
+#define AUDIO_CONTROL_SAMPLING_FREQ                   0x01
 
 #define AUDIO_FORMAT_TYPE_I                           0x01
+#define AUDIO_FORMAT_PCM                              0x0001
 
 #define USB_ENDPOINT_TYPE_ISOCHRONOUS                 0x01
+#define USB_ENDPOINT_SYNC_ASYNCHRONOUS                0x04
 #define AUDIO_ENDPOINT_GENERAL                        0x01
 
+/* Sampling frequencies */
+#define AUDIO_FREQ_16K                                16000
+#define AUDIO_FREQ_32K                                32000
+#define AUDIO_FREQ_44K                                44100
+#define AUDIO_FREQ_48K                                48000
+
+/* tSamFreq, 3 bytes little endian */
+#define AUDIO_FREQ_BYTES(Freq)                        (uint8_t) (Freq), (uint8_t) ((Freq) >> 8), (uint8_t) ((Freq) >> 16)
+
+/* Speaker stream format: 16-bit signed stereo at one of the rates up to
+   SPEAKER_MAX_FREQ, the packet memory left by the capture stream allowing
+   32 kHz only */
+#define SPEAKER_CHANNELS                              2
+#define SPEAKER_SUBFRAME_SIZE                         2
+#define SPEAKER_FRAME_SIZE                            (SPEAKER_CHANNELS * SPEAKER_SUBFRAME_SIZE)
+
+#ifdef AUDIO_CAPTURE
+#define SPEAKER_MAX_FREQ                              AUDIO_FREQ_32K
+#else
+#define SPEAKER_MAX_FREQ                              AUDIO_FREQ_48K
+#endif /* AUDIO_CAPTURE */
+#define SPEAKER_DEFAULT_FREQ                          SPEAKER_MAX_FREQ
+
+/* Largest OUT packet at a rate: the asynchronous host may send one frame
+   more than the rate rounded up */
+#define SPEAKER_PACKET_SIZE(Freq)                     ((((Freq) + 999) / 1000 + 1) * SPEAKER_FRAME_SIZE)
+#define SPEAKER_MAX_PACKET                            SPEAKER_PACKET_SIZE(SPEAKER_MAX_FREQ)
+
+/* Capture stream format: 16-bit signed mono at 16 or 32 kHz */
+#define CAPTURE_CHANNELS                              1
+#define CAPTURE_SUBFRAME_SIZE                         2
+#define CAPTURE_FRAME_SIZE                            (CAPTURE_CHANNELS * CAPTURE_SUBFRAME_SIZE)
+#define CAPTURE_MAX_FREQ                              AUDIO_FREQ_32K
+#define CAPTURE_DEFAULT_FREQ                          CAPTURE_MAX_FREQ
+
+/* Largest IN packet at a rate: one frame more than the rate rounded up, sent
+   when the ADC clock runs ahead of the host */
+#define CAPTURE_PACKET_SIZE(Freq)                     ((((Freq) + 999) / 1000 + 1) * CAPTURE_FRAME_SIZE)
+#define CAPTURE_MAX_PACKET                            CAPTURE_PACKET_SIZE(CAPTURE_MAX_FREQ)
+#define CAPTURE_EP_ADDRESS                            0x83
+
 /* Exported functions ------------------------------------------------------- */
 extern const uint8_t Speaker_DeviceDescriptor[SPEAKER_SIZ_DEVICE_DESC];
 extern const uint8_t Speaker_ConfigDescriptor[SPEAKER_SIZ_CONFIG_DESC];
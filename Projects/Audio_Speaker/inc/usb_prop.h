@@ -48,6 +48,8 @@ uint8_t *Speaker_GetDeviceDescriptor(uint16_t);
 uint8_t *Speaker_GetConfigDescriptor(uint16_t);
 uint8_t *Speaker_GetStringDescriptor(uint16_t);
 uint8_t *Mute_Command(uint16_t Length);
+uint8_t *Volume_Command(uint16_t Length);
+uint8_t *Freq_Command(uint16_t Length);
 
 /* Exported define -----------------------------------------------------------*/
 #define Speaker_GetConfiguration          NOP_Process
@@ -61,6 +63,9 @@ uint8_t *Mute_Command(uint16_t Length);
 //#define Speaker_SetDeviceAddress          NOP_Process
 #define GET_CUR                           0x81
 #define SET_CUR                           0x01
+#define GET_MIN                           0x82
+#define GET_MAX                           0x83
+#define GET_RES                           0x84
 
 #endif /* __usb_prop_H */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
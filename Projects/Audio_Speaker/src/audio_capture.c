@@ -0,0 +1,179 @@
+/**
+  ******************************************************************************
+  * @file    audio_capture.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Analog input capture: the ADC, triggered at the sampling rate,
+  *          fills a ring by circular DMA and each isochronous IN packet takes
+  *          one frame worth of samples from it. The ADC clock is the master
+  *          (asynchronous source): the packet sizes follow it.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "audio_capture.h"
+
+#ifdef AUDIO_CAPTURE
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define AUDIO_CAP_MASK              (AUDIO_CAP_RING - 1)
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+uint16_t Audio_Capture_Buffer[AUDIO_CAP_RING];	/* left aligned ADC values */
+
+static uint32_t Audio_Cap_Freq = CAPTURE_DEFAULT_FREQ;
+static uint32_t Audio_Cap_Acc = 0;	/* fraction of sample in 1/1000 */
+static uint32_t Audio_Cap_Read = 0;	/* ring index of the next sample sent */
+static uint8_t Audio_Cap_Idle = 0xFF;	/* frames since the last IN transfer */
+
+/* Extern variables ----------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t Audio_Capture_Write(void);
+static uint32_t Audio_Capture_Count(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : Audio_Capture_Init
+* Description    : Set the sampling frequency, the next packet restarting
+*                  from the target level. Called on USB reset and on a
+*                  sampling frequency change.
+* Input          : Freq: sampling frequency in Hz.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Capture_Init(uint32_t Freq)
+{
+	Audio_Cap_Freq = Freq;
+	Audio_Cap_Idle = 0xFF;
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Capture_SOF
+* Description    : Count the frames since the last IN transfer, called on
+*                  each SOF.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Capture_SOF(void)
+{
+	if (Audio_Cap_Idle <= AUDIO_CAP_IDLE) {
+		Audio_Cap_Idle++;
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Capture_Sent
+* Description    : Refill the buffer the capture endpoint has just sent, the
+*                  hardware now works on the other one. The samples are
+*                  converted to signed on the way. Called on EP3 IN
+*                  completion, once per frame while the host streams.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Capture_Sent(void)
+{
+	uint16_t Packet[CAPTURE_MAX_PACKET / CAPTURE_FRAME_SIZE];
+	uint32_t wFrames = 0;
+	uint32_t i;
+
+	if (Audio_Cap_Idle > AUDIO_CAP_IDLE) {
+		/* Stream starting: skip the samples taken meanwhile */
+		Audio_Cap_Read = (Audio_Capture_Write() - AUDIO_CAP_TARGET)
+		    & AUDIO_CAP_MASK;
+		Audio_Cap_Acc = 0;
+	}
+	Audio_Cap_Idle = 0;
+
+	wFrames = Audio_Capture_Count();
+	for (i = 0; i < wFrames; i++) {
+		Packet[i] = Audio_Capture_Buffer[Audio_Cap_Read] ^ 0x8000;
+		Audio_Cap_Read = (Audio_Cap_Read + 1) & AUDIO_CAP_MASK;
+	}
+
+	if (GetENDPOINT(ENDP3) & EP_DTOG_TX) {
+		UserToPMABufferCopy((uint8_t *) Packet, ENDP3_BUF0Addr,
+				    wFrames * CAPTURE_FRAME_SIZE);
+		SetEPDblBuf0Count(ENDP3, EP_DBUF_IN,
+				  wFrames * CAPTURE_FRAME_SIZE);
+	} else {
+		UserToPMABufferCopy((uint8_t *) Packet, ENDP3_BUF1Addr,
+				    wFrames * CAPTURE_FRAME_SIZE);
+		SetEPDblBuf1Count(ENDP3, EP_DBUF_IN,
+				  wFrames * CAPTURE_FRAME_SIZE);
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Capture_Write
+* Description    : Ring index the DMA writes next.
+* Input          : None.
+* Output         : None.
+* Return         : The write index.
+*******************************************************************************/
+static uint32_t Audio_Capture_Write(void)
+{
+	return (AUDIO_CAP_RING - DMA_GetCurrDataCounter(AUDIO_IN_DMA_CHANNEL))
+	    & AUDIO_CAP_MASK;
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Capture_Count
+* Description    : Samples to send in the next packet: the nominal count of a
+*                  frame, its fraction carried over, plus or minus one when
+*                  the ring level drifts from AUDIO_CAP_TARGET because the
+*                  ADC and the host clocks differ.
+* Input          : None.
+* Output         : None.
+* Return         : The sample count.
+*******************************************************************************/
+static uint32_t Audio_Capture_Count(void)
+{
+	uint32_t wLevel = (Audio_Capture_Write() - Audio_Cap_Read)
+	    & AUDIO_CAP_MASK;
+	uint32_t wFrames = 0;
+
+	Audio_Cap_Acc += Audio_Cap_Freq;
+	wFrames = Audio_Cap_Acc / 1000;
+	Audio_Cap_Acc -= wFrames * 1000;
+
+	if (wLevel > (wFrames + AUDIO_CAP_TARGET + AUDIO_CAP_SLACK)) {
+		wFrames++;
+	} else if ((wFrames != 0)
+		   && (wLevel < (wFrames + AUDIO_CAP_TARGET - AUDIO_CAP_SLACK))) {
+		wFrames--;
+	}
+
+	if (wFrames > wLevel) {
+		wFrames = wLevel;
+	}
+
+	return wFrames;
+}
+
+#endif /* AUDIO_CAPTURE */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,160 @@
+/**
+  ******************************************************************************
+  * @file    audio_feedback.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Explicit feedback of the asynchronous speaker: the sample rate
+  *          clock is measured against the USB frames and reported to the
+  *          host on the feedback IN endpoint.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "audio_feedback.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static uint32_t Audio_Fb_Nominal = AUDIO_FB_NOMINAL(SPEAKER_DEFAULT_FREQ);
+static uint32_t Audio_Fb_Value = AUDIO_FB_NOMINAL(SPEAKER_DEFAULT_FREQ);
+static uint16_t Audio_Fb_Frame;	/* frame number starting the period */
+static uint32_t Audio_Fb_Clock;	/* frames played at the period start */
+static uint8_t Audio_Fb_Running = 0;
+
+/* Extern variables ----------------------------------------------------------*/
+extern __IO uint8_t bIntPackSOF;
+
+/* Private function prototypes -----------------------------------------------*/
+static void Audio_Feedback_Write(uint16_t wPMABufAddr);
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : Audio_Feedback_Init
+* Description    : Report the nominal rate until a period has been measured,
+*                  called on USB reset and on a sampling frequency change.
+* Input          : Freq: sampling frequency in Hz.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Feedback_Init(uint32_t Freq)
+{
+	Audio_Fb_Nominal = AUDIO_FB_NOMINAL(Freq);
+	Audio_Fb_Value = Audio_Fb_Nominal;
+	Audio_Fb_Running = 0;
+
+	Audio_Feedback_Write(ENDP2_BUF0Addr);
+	Audio_Feedback_Write(ENDP2_BUF1Addr);
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Feedback_SOF
+* Description    : Measure the frames played over AUDIO_FB_PERIOD USB frames.
+*                  The frames are counted on the FNR frame number, so a SOF
+*                  interrupt served late or missed does not skew the period.
+*                  The measure restarts when the SOFs are not locked or the
+*                  OUT packets stopped (bIntPackSOF). A term pulling the
+*                  playback level back to its target is added. Called on
+*                  each SOF, at the priority of the DMA interrupt.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Feedback_SOF(void)
+{
+	uint16_t wFrame = GetFNR();
+	uint32_t wClock = Audio_Play_Clock();
+	uint16_t wFrames = 0;
+	int32_t lValue = 0;
+
+	if (((wFrame & FNR_LCK) == 0) || (bIntPackSOF > AUDIO_FB_IDLE)) {
+		Audio_Fb_Running = 0;
+		return;
+	}
+
+	wFrame &= FNR_FN;
+	if (Audio_Fb_Running == 0) {
+		Audio_Fb_Frame = wFrame;
+		Audio_Fb_Clock = wClock;
+		Audio_Fb_Running = 1;
+		return;
+	}
+
+	wFrames = (wFrame - Audio_Fb_Frame) & FNR_FN;
+	if (wFrames < AUDIO_FB_PERIOD) {
+		return;
+	}
+
+	lValue = (int32_t) (((wClock - Audio_Fb_Clock) << 14) / wFrames);
+	lValue += ((int32_t) AUDIO_FB_TARGET - (int32_t) Audio_Play_Level())
+	    << AUDIO_FB_GAIN_SHIFT;
+
+	if (lValue > (int32_t) (Audio_Fb_Nominal + AUDIO_FB_RANGE)) {
+		lValue = Audio_Fb_Nominal + AUDIO_FB_RANGE;
+	} else if (lValue < (int32_t) (Audio_Fb_Nominal - AUDIO_FB_RANGE)) {
+		lValue = Audio_Fb_Nominal - AUDIO_FB_RANGE;
+	}
+
+	Audio_Fb_Value = (uint32_t) lValue;
+	Audio_Fb_Frame = wFrame;
+	Audio_Fb_Clock = wClock;
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Feedback_Sent
+* Description    : Refresh the buffer the feedback endpoint has just sent, the
+*                  hardware now works on the other one. Called on EP2 IN
+*                  completion.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Feedback_Sent(void)
+{
+	if (GetENDPOINT(ENDP2) & EP_DTOG_TX) {
+		Audio_Feedback_Write(ENDP2_BUF0Addr);
+	} else {
+		Audio_Feedback_Write(ENDP2_BUF1Addr);
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Feedback_Write
+* Description    : Copy the current feedback value in a packet buffer.
+* Input          : wPMABufAddr: packet memory address of the buffer.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Audio_Feedback_Write(uint16_t wPMABufAddr)
+{
+	uint8_t Buffer[AUDIO_FB_SIZE + 1];
+
+	Buffer[0] = (uint8_t) Audio_Fb_Value;
+	Buffer[1] = (uint8_t) (Audio_Fb_Value >> 8);
+	Buffer[2] = (uint8_t) (Audio_Fb_Value >> 16);
+	Buffer[3] = 0;
+
+	UserToPMABufferCopy(Buffer, wPMABufAddr, AUDIO_FB_SIZE);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,154 @@
+/**
+  ******************************************************************************
+  * @file    audio_play.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   DMA playback: a circular buffer is sent to the audio output at
+  *          the sample rate, each half being refilled from the jitter ring
+  *          while the DMA sends the other one. Each half is processed as a
+  *          block: volume, then conversion to the output format.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "platform_config.h"
+#include "usb_desc.h"
+#include "audio_ring.h"
+#include "audio_play.h"
+#include "audio_volume.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+int16_t Audio_Play_Buffer[2 * AUDIO_PLAY_HALF];
+
+/* Written by the DMA interrupt only */
+static __IO uint32_t Audio_Play_Wraps = 0;	/* DMA buffer rounds */
+static __IO uint32_t Audio_Play_Fetched = 0;	/* frames put in the buffer */
+
+/* Extern variables ----------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : Audio_Play_Init
+* Description    : Fill the DMA buffer with silence, called before the DMA is
+*                  started.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Play_Init(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < (2 * AUDIO_PLAY_HALF); i++) {
+		Audio_Play_Buffer[i] = 0;
+	}
+#if (AUDIO_PLAY_CHANNELS == 1)
+	Audio_Volume_Convert(Audio_Play_Buffer, 2 * AUDIO_PLAY_HALF);
+#endif
+	Audio_Volume_Init();
+
+	Audio_Play_Wraps = 0;
+	Audio_Play_Fetched = 2 * AUDIO_PLAY_FRAMES;
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Play_Fill
+* Description    : Refill the half of the DMA buffer just sent: the frames
+*                  are taken from the ring, mixed down to mono for the PWM and
+*                  the DAC, scaled by the volume and converted. The ring keeps
+*                  draining while muted. Called on the DMA half transfer and
+*                  transfer complete interrupts.
+* Input          : Half: 0 for the first half, 1 for the second one.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Play_Fill(uint8_t Half)
+{
+	int16_t *pBlock = &Audio_Play_Buffer[Half * AUDIO_PLAY_HALF];
+	int16_t *pBuf = pBlock;
+	uint32_t wFrame = 0;
+	uint32_t i;
+
+	for (i = 0; i < AUDIO_PLAY_FRAMES; i++) {
+		wFrame = Audio_Ring_Get();
+#if (AUDIO_PLAY_CHANNELS == 2)
+		*pBuf++ = (int16_t) wFrame;
+		*pBuf++ = (int16_t) (wFrame >> 16);
+#else
+		*pBuf++ = (int16_t) (((int32_t) (int16_t) wFrame
+				      + (int32_t) (int16_t) (wFrame >> 16)) >> 1);
+#endif /* AUDIO_PLAY_CHANNELS */
+	}
+
+	Audio_Volume_Apply(pBlock, AUDIO_PLAY_FRAMES);
+#if (AUDIO_PLAY_CHANNELS == 1)
+	Audio_Volume_Convert(pBlock, AUDIO_PLAY_HALF);
+#endif
+
+	Audio_Play_Fetched += AUDIO_PLAY_FRAMES;
+	if (Half != 0) {
+		Audio_Play_Wraps++;
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Play_Clock
+* Description    : Count of the frames sent to the output, from the DMA
+*                  position. A buffer round whose interrupt is still pending
+*                  is accounted. Must not be preempted by the DMA interrupt.
+* Input          : None.
+* Output         : None.
+* Return         : Frames sent since the DMA was started, free running.
+*******************************************************************************/
+uint32_t Audio_Play_Clock(void)
+{
+	uint32_t wraps = Audio_Play_Wraps;
+	uint32_t left = DMA_GetCurrDataCounter(AUDIO_OUT_DMA_CHANNEL);
+
+	/* The counter was read before the flag: a wrap seen by the flag may
+	   have happened after the read, so read it again */
+	if (DMA_GetITStatus(AUDIO_OUT_DMA_IT_TC) != RESET) {
+		wraps++;
+		left = DMA_GetCurrDataCounter(AUDIO_OUT_DMA_CHANNEL);
+	}
+
+	return (wraps * 2 * AUDIO_PLAY_FRAMES)
+	    + (((2 * AUDIO_PLAY_HALF) - left) / AUDIO_PLAY_CHANNELS);
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Play_Level
+* Description    : Frames waiting to be played, in the jitter ring and in the
+*                  DMA buffer. Same context as Audio_Play_Clock.
+* Input          : None.
+* Output         : None.
+* Return         : The playback level.
+*******************************************************************************/
+uint32_t Audio_Play_Level(void)
+{
+	return Audio_Ring_Level() + (Audio_Play_Fetched - Audio_Play_Clock());
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
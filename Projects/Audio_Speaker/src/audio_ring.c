@@ -0,0 +1,205 @@
+/**
+  ******************************************************************************
+  * @file    audio_ring.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Jitter buffer between the isochronous OUT endpoint and the
+  *          playback: a single producer, single consumer ring of frames
+  *          filled from the packet memory and played once a target level
+  *          is reached.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "usb_desc.h"
+#include "audio_ring.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define AUDIO_RING_MASK             (AUDIO_RING_SIZE - 1)
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+AUDIO_RING_STATS Audio_Ring_Stats;
+
+static uint32_t Audio_Ring[AUDIO_RING_SIZE];
+/* Free running indexes: In is only written by the USB interrupt, Out and
+   Playing only by the playback */
+static __IO uint32_t Audio_Ring_in = 0;
+static __IO uint32_t Audio_Ring_out = 0;
+static __IO uint8_t Audio_Ring_Playing = 0;
+static uint32_t Audio_Ring_Last = AUDIO_RING_SILENCE;
+static __IO uint32_t Audio_Ring_Packets = 0;
+static __IO uint32_t Audio_Ring_Overruns = 0;
+static __IO uint32_t Audio_Ring_Underruns = 0;
+
+/* Extern variables ----------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : Audio_Ring_Init
+* Description    : Empty the ring and wait for the target level again, called
+*                  on USB reset.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Ring_Init(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	Audio_Ring_in = 0;
+	Audio_Ring_out = 0;
+	Audio_Ring_Playing = 0;
+	Audio_Ring_Last = AUDIO_RING_SILENCE;
+
+	__set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Ring_Put
+* Description    : Store an OUT packet straight from the packet memory, an
+*                  incomplete last frame is ignored. A packet not fitting in
+*                  the free room is dropped whole. Producer side, USB
+*                  interrupt only.
+* Input          : wPMABufAddr: packet memory address of the packet.
+*                  wNBytes: packet length.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Ring_Put(uint16_t wPMABufAddr, uint16_t wNBytes)
+{
+	uint32_t *pdwVal = (uint32_t *) (wPMABufAddr * 2 + PMAAddr);
+	uint32_t in = Audio_Ring_in;
+	uint32_t wFrames = wNBytes / SPEAKER_FRAME_SIZE;
+	uint32_t i;
+
+	if ((AUDIO_RING_SIZE - (in - Audio_Ring_out)) < wFrames) {
+		Audio_Ring_Overruns++;
+		return;
+	}
+
+	/* The packet memory holds 2 bytes, one sample, per 32-bit word */
+	for (i = 0; i < wFrames; i++) {
+		Audio_Ring[(in + i) & AUDIO_RING_MASK] =
+		    (uint16_t) pdwVal[0] | ((uint32_t) (uint16_t) pdwVal[1] << 16);
+		pdwVal += 2;
+	}
+
+	/* Publish the frames once they are all in place */
+	Audio_Ring_in = in + wFrames;
+	Audio_Ring_Packets++;
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Ring_Get
+* Description    : Take the next frame to play. Nothing is taken until the
+*                  target level is reached; an empty ring while playing is an
+*                  underrun and waits for the target level again. Meanwhile
+*                  the last frame is held so the output does not click.
+*                  Consumer side, playback only.
+* Input          : None.
+* Output         : None.
+* Return         : The frame to play.
+*******************************************************************************/
+uint32_t Audio_Ring_Get(void)
+{
+	uint32_t out = Audio_Ring_out;
+	uint32_t level = Audio_Ring_in - out;
+
+	if (Audio_Ring_Playing == 0) {
+		if (level < AUDIO_RING_TARGET) {
+			return Audio_Ring_Last;
+		}
+		Audio_Ring_Playing = 1;
+	} else if (level == 0) {
+		Audio_Ring_Playing = 0;
+		Audio_Ring_Underruns++;
+		return Audio_Ring_Last;
+	}
+
+	Audio_Ring_Last = Audio_Ring[out & AUDIO_RING_MASK];
+	Audio_Ring_out = out + 1;
+
+	return Audio_Ring_Last;
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Ring_Level
+* Description    : Frames waiting in the ring.
+* Input          : None.
+* Output         : None.
+* Return         : The ring level.
+*******************************************************************************/
+uint32_t Audio_Ring_Level(void)
+{
+	return Audio_Ring_in - Audio_Ring_out;
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Ring_ClearStats
+* Description    : AUDIO_REQ_CLEAR_STATS handler.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Ring_ClearStats(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	Audio_Ring_Packets = 0;
+	Audio_Ring_Overruns = 0;
+	Audio_Ring_Underruns = 0;
+
+	__set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Ring_GetStats
+* Description    : AUDIO_REQ_GET_STATS data stage, the counters are sampled
+*                  when the request is received.
+* Input          : Length.
+* Output         : None.
+* Return         : Address of the statistics.
+*******************************************************************************/
+uint8_t *Audio_Ring_GetStats(uint16_t Length)
+{
+	if (Length == 0) {
+		Audio_Ring_Stats.Packets = Audio_Ring_Packets;
+		Audio_Ring_Stats.Overruns = Audio_Ring_Overruns;
+		Audio_Ring_Stats.Underruns = Audio_Ring_Underruns;
+		Audio_Ring_Stats.Level = Audio_Ring_Level();
+		Audio_Ring_Stats.Target = AUDIO_RING_TARGET;
+
+		pInformation->Ctrl_Info.Usb_wLength = sizeof(Audio_Ring_Stats);
+		return NULL;
+	}
+	return (uint8_t *) & Audio_Ring_Stats +
+	    pInformation->Ctrl_Info.Usb_wOffset;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,265 @@
+/**
+  ******************************************************************************
+  * @file    audio_volume.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Feature unit volume and mute applied to the refilled blocks, with
+  *          gain ramps, and conversion to the PWM and DAC formats. Built on
+  *          the CMSIS-DSP kernels when ARM_MATH_CM3 is defined, on portable
+  *          C versions of them otherwise.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "audio_play.h"
+#include "audio_volume.h"
+
+#if defined (ARM_MATH_CM3)
+#include "arm_math.h"
+#endif /* ARM_MATH_CM3 */
+
+/* Private typedef -----------------------------------------------------------*/
+#if !defined (ARM_MATH_CM3)
+typedef int16_t q15_t;
+#endif /* ARM_MATH_CM3 */
+
+/* Private define ------------------------------------------------------------*/
+#define AUDIO_VOL_SEGMENT_FRAMES    (AUDIO_PLAY_FRAMES / AUDIO_VOL_SEGMENTS)
+
+#if ((AUDIO_VOL_SEGMENT_FRAMES * AUDIO_VOL_SEGMENTS) != AUDIO_PLAY_FRAMES)
+#error "The refilled half must split in AUDIO_VOL_SEGMENTS equal segments"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Q15 gain of each 1 dB step from 0 dB down to AUDIO_VOL_MIN */
+static const q15_t Audio_Vol_Table[(-AUDIO_VOL_MIN / AUDIO_VOL_RES) + 1] = {
+	32767, 29204, 26028, 23197, 20675, 18426, 16422, 14636,
+	13045, 11626, 10362, 9235, 8231, 7336, 6538, 5827,
+	5193, 4628, 4125, 3677, 3277, 2920, 2603, 2320,
+	2067, 1843, 1642, 1464, 1304, 1163, 1036, 923,
+	823, 734, 654, 583, 519, 463, 413, 368,
+	328, 292, 260, 232, 207, 184, 164, 146,
+	130
+};
+
+static int32_t Audio_Vol_Gain = AUDIO_VOL_UNITY;	/* Q15, current segment */
+
+/* Extern variables ----------------------------------------------------------*/
+extern uint32_t MUTE_DATA;
+extern int16_t VOLUME_DATA;
+
+/* Private function prototypes -----------------------------------------------*/
+static int32_t Audio_Volume_Target(void);
+
+#if !defined (ARM_MATH_CM3)
+static void arm_scale_q15(q15_t * pSrc, q15_t scaleFract, int8_t shift,
+			  q15_t * pDst, uint32_t blockSize);
+#if (AUDIO_PLAY_CHANNELS == 1)
+static void arm_shift_q15(q15_t * pSrc, int8_t shiftBits, q15_t * pDst,
+			  uint32_t blockSize);
+static void arm_offset_q15(q15_t * pSrc, q15_t offset, q15_t * pDst,
+			   uint32_t blockSize);
+#endif /* AUDIO_PLAY_CHANNELS */
+#endif /* ARM_MATH_CM3 */
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : Audio_Volume_Init
+* Description    : Start at the current volume without ramp.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Volume_Init(void)
+{
+	Audio_Vol_Gain = Audio_Volume_Target();
+}
+
+/*******************************************************************************
+* Function Name  : Audio_Volume_Apply
+* Description    : Scale a block of frames by the volume. The gain moves
+*                  toward the volume, or toward zero when muted, by at most
+*                  AUDIO_VOL_STEP per segment so that changes do not click.
+*                  A block at unity gain is left untouched.
+* Input          : pBlock: samples, AUDIO_PLAY_CHANNELS per frame.
+*                  Frames: frames in the block, AUDIO_PLAY_FRAMES.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Volume_Apply(int16_t * pBlock, uint32_t Frames)
+{
+	int32_t lTarget = Audio_Volume_Target();
+	uint32_t wSamples = (Frames / AUDIO_VOL_SEGMENTS) * AUDIO_PLAY_CHANNELS;
+	uint32_t i;
+
+	if ((lTarget == AUDIO_VOL_UNITY) && (Audio_Vol_Gain == AUDIO_VOL_UNITY)) {
+		return;
+	}
+
+	for (i = 0; i < AUDIO_VOL_SEGMENTS; i++) {
+		if (Audio_Vol_Gain < (lTarget - AUDIO_VOL_STEP)) {
+			Audio_Vol_Gain += AUDIO_VOL_STEP;
+		} else if (Audio_Vol_Gain > (lTarget + AUDIO_VOL_STEP)) {
+			Audio_Vol_Gain -= AUDIO_VOL_STEP;
+		} else {
+			Audio_Vol_Gain = lTarget;
+		}
+
+		arm_scale_q15(pBlock, (q15_t) Audio_Vol_Gain, 0, pBlock,
+			      wSamples);
+		pBlock += wSamples;
+	}
+}
+
+#if (AUDIO_PLAY_CHANNELS == 1)
+/*******************************************************************************
+* Function Name  : Audio_Volume_Convert
+* Description    : Convert signed 16-bit samples in place to the unsigned
+*                  PWM duty cycle or DAC value, on 16 - AUDIO_OUT_DATA_SHIFT
+*                  bits. The I2S takes the signed samples as they are.
+* Input          : pBlock: samples.
+*                  Samples: samples in the block.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Volume_Convert(int16_t * pBlock, uint32_t Samples)
+{
+	arm_shift_q15(pBlock, -AUDIO_OUT_DATA_SHIFT, pBlock, Samples);
+	arm_offset_q15(pBlock, (q15_t) (1 << (15 - AUDIO_OUT_DATA_SHIFT)),
+		       pBlock, Samples);
+}
+#endif /* AUDIO_PLAY_CHANNELS */
+
+/*******************************************************************************
+* Function Name  : Audio_Volume_Target
+* Description    : Gain of the feature unit controls, the volume rounded down
+*                  to a 1 dB step.
+* Input          : None.
+* Output         : None.
+* Return         : Q15 gain.
+*******************************************************************************/
+static int32_t Audio_Volume_Target(void)
+{
+	int32_t lVolume = VOLUME_DATA;
+
+	if (((uint8_t) (MUTE_DATA) != 0) || (lVolume == AUDIO_VOL_SILENCE)) {
+		return 0;
+	}
+
+	if (lVolume > AUDIO_VOL_MAX) {
+		lVolume = AUDIO_VOL_MAX;
+	} else if (lVolume < AUDIO_VOL_MIN) {
+		lVolume = AUDIO_VOL_MIN;
+	}
+
+	return Audio_Vol_Table[(AUDIO_VOL_MAX - lVolume) / AUDIO_VOL_RES];
+}
+
+#if !defined (ARM_MATH_CM3)
+/*******************************************************************************
+* Function Name  : arm_scale_q15
+* Description    : Portable version of the CMSIS-DSP kernel: multiply by a
+*                  Q15 scale and 2^shift, with saturation.
+* Input          : pSrc: input samples.
+*                  scaleFract: Q15 scale.
+*                  shift: additional left shift.
+*                  blockSize: samples to process.
+* Output         : pDst: output samples.
+* Return         : None.
+*******************************************************************************/
+static void arm_scale_q15(q15_t * pSrc, q15_t scaleFract, int8_t shift,
+			  q15_t * pDst, uint32_t blockSize)
+{
+	int32_t lOut;
+
+	while (blockSize-- != 0) {
+		lOut = ((int32_t) *pSrc++ * scaleFract) >> (15 - shift);
+		if (lOut > 0x7FFF) {
+			lOut = 0x7FFF;
+		} else if (lOut < -0x8000) {
+			lOut = -0x8000;
+		}
+		*pDst++ = (q15_t) lOut;
+	}
+}
+
+#if (AUDIO_PLAY_CHANNELS == 1)
+/*******************************************************************************
+* Function Name  : arm_shift_q15
+* Description    : Portable version of the CMSIS-DSP kernel: shift left by
+*                  shiftBits, right when negative, with saturation.
+* Input          : pSrc: input samples.
+*                  shiftBits: shift, positive to the left.
+*                  blockSize: samples to process.
+* Output         : pDst: output samples.
+* Return         : None.
+*******************************************************************************/
+static void arm_shift_q15(q15_t * pSrc, int8_t shiftBits, q15_t * pDst,
+			  uint32_t blockSize)
+{
+	int32_t lOut;
+
+	while (blockSize-- != 0) {
+		if (shiftBits >= 0) {
+			lOut = (int32_t) *pSrc++ << shiftBits;
+		} else {
+			lOut = (int32_t) *pSrc++ >> -shiftBits;
+		}
+		if (lOut > 0x7FFF) {
+			lOut = 0x7FFF;
+		} else if (lOut < -0x8000) {
+			lOut = -0x8000;
+		}
+		*pDst++ = (q15_t) lOut;
+	}
+}
+
+/*******************************************************************************
+* Function Name  : arm_offset_q15
+* Description    : Portable version of the CMSIS-DSP kernel: add an offset,
+*                  with saturation.
+* Input          : pSrc: input samples.
+*                  offset: value added.
+*                  blockSize: samples to process.
+* Output         : pDst: output samples.
+* Return         : None.
+*******************************************************************************/
+static void arm_offset_q15(q15_t * pSrc, q15_t offset, q15_t * pDst,
+			   uint32_t blockSize)
+{
+	int32_t lOut;
+
+	while (blockSize-- != 0) {
+		lOut = (int32_t) *pSrc++ + offset;
+		if (lOut > 0x7FFF) {
+			lOut = 0x7FFF;
+		} else if (lOut < -0x8000) {
+			lOut = -0x8000;
+		}
+		*pDst++ = (q15_t) lOut;
+	}
+}
+#endif /* AUDIO_PLAY_CHANNELS */
+#endif /* ARM_MATH_CM3 */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -32,10 +32,13 @@
 #include "usb_desc.h"
 #include "usb_pwr.h"
 #include "usb_prop.h"
+#include "audio_play.h"
+#include "audio_capture.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
-#define TIM2ARRValue    3273	/* 22KHz = 72MHz / 3273 */
+/* Timer auto reload value updating at a sampling frequency */
+#define AUDIO_TIMER_PERIOD(Freq)  ((SystemCoreClock / (Freq)) - 1)
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 ErrorStatus HSEStartUpStatus;
@@ -44,6 +47,7 @@ EXTI_InitTypeDef EXTI_InitStructure;
 /* Extern variables ----------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
 static void IntToUnicode(uint32_t value, uint8_t * pbuf, uint8_t len);
+static void Speaker_DMA_Config(void);
 /* Private functions ---------------------------------------------------------*/
 
 /*******************************************************************************
@@ -234,24 +238,15 @@ void Audio_Config(void)
 {
 	NVIC_InitTypeDef NVIC_InitStructure;
 
-#if defined(USE_STM32L152_EVAL)
-	/* Enable the TIM2 Interrupt */
-	NVIC_InitStructure.NVIC_IRQChannel = TIM6_IRQn;
+	/* Enable the audio output DMA Interrupt */
+	NVIC_InitStructure.NVIC_IRQChannel = AUDIO_OUT_DMA_IRQn;
 	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
 	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
 	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
 	NVIC_Init(&NVIC_InitStructure);
 
-#elif defined(USE_STM3210B_EVAL)
-	/* Enable the TIM2 Interrupt */
-	NVIC_InitStructure.NVIC_IRQChannel = TIM2_IRQn;
-	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
-	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
-	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-	NVIC_Init(&NVIC_InitStructure);
-
-#elif defined(USE_STM3210E_EVAL)
-	/* SPI2 IRQ Channel configuration */
+#if defined(USE_STM3210E_EVAL)
+	/* SPI2 IRQ Channel configuration, clocks the codec configuration */
 	NVIC_InitStructure.NVIC_IRQChannel = SPI2_IRQn;
 	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
 	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
@@ -295,8 +290,6 @@ void Speaker_Config(void)
 #ifdef USE_STM32L152_EVAL
 	DAC_InitTypeDef DAC_InitStructure;
 	GPIO_InitTypeDef GPIO_InitStructure;
-	uint16_t TIM6ARRValue = 4000;
-
 	/* TIM6 and DAC clocks enable */
 	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM6 | RCC_APB1Periph_DAC,
 			       ENABLE);
@@ -314,17 +307,12 @@ void Speaker_Config(void)
 	/* TIM6 Configuration */
 	TIM_DeInit(TIM6);
 
-	TIM6ARRValue = (uint32_t) (SystemCoreClock / 22000);	/* Audio Sample Rate = 22KHz */
-
 	/* Set the timer auto reload value dependent on the audio frequency */
-	TIM_SetAutoreload(TIM6, TIM6ARRValue);	/* 22.KHz = 32MHz / 1454 */
+	TIM_SetAutoreload(TIM6, AUDIO_TIMER_PERIOD(SPEAKER_DEFAULT_FREQ));
 
 	/* TIM6 TRGO selection */
 	TIM_SelectOutputTrigger(TIM6, TIM_TRGOSource_Update);
 
-	/* Enable TIM6 update interrupt */
-	TIM_ITConfig(TIM6, TIM_IT_Update, ENABLE);
-
 	/* DAC deinitialize */
 	DAC_DeInit();
 	DAC_StructInit(&DAC_InitStructure);
@@ -334,13 +322,17 @@ void Speaker_Config(void)
 	DAC_InitStructure.DAC_WaveGeneration = DAC_WaveGeneration_None;
 	DAC_InitStructure.DAC_OutputBuffer = DAC_OutputBuffer_Disable;
 
-/* DAC Channel1: 8bit right---------------------------------------------------*/
+/* DAC Channel1: 12bit right--------------------------------------------------*/
 	/* DAC Channel1 Init */
 	DAC_Init(DAC_Channel_1, &DAC_InitStructure);
 
 	/* Enable DAC Channel1 */
 	DAC_Cmd(DAC_Channel_1, ENABLE);
 
+	/* Each TIM6 trigger loads the next sample by DMA */
+	Speaker_DMA_Config();
+	DAC_DMACmd(DAC_Channel_1, ENABLE);
+
 	/* Start TIM6 */
 	TIM_Cmd(TIM6, ENABLE);
 
@@ -370,7 +362,8 @@ void Speaker_Config(void)
 	TIM_OC3PreloadConfig(TIM4, TIM_OCPreload_Enable);
 
 	/* TIM2 configuration */
-	TIM_TimeBaseStructure.TIM_Period = TIM2ARRValue;
+	TIM_TimeBaseStructure.TIM_Period =
+	    AUDIO_TIMER_PERIOD(SPEAKER_DEFAULT_FREQ);
 	TIM_TimeBaseStructure.TIM_Prescaler = 0x00;	/* TIM2CLK = 72 MHz */
 	TIM_TimeBaseStructure.TIM_ClockDivision = 0x0;
 	TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
@@ -381,27 +374,214 @@ void Speaker_Config(void)
 	TIM_OC1Init(TIM2, &TIM_OCInitStructure);
 	TIM_OC1PreloadConfig(TIM2, TIM_OCPreload_Disable);
 
+	/* Each TIM2 update loads the next sample in TIM4 CCR3 by DMA */
+	Speaker_DMA_Config();
+	TIM_DMACmd(TIM2, TIM_DMA_Update, ENABLE);
+
 	/* Start TIM4 */
 	TIM_Cmd(TIM4, ENABLE);
 
 	/* Start TIM2 */
 	TIM_Cmd(TIM2, ENABLE);
 
-	/* Enable TIM2 update interrupt */
-	TIM_ITConfig(TIM2, TIM_IT_Update, ENABLE);
-
 #else
 	/* Configure the initialization parameters */
 	I2S_GPIO_Config();
 	I2S_Config(I2S_Standard_Phillips, I2S_MCLKOutput_Enable,
-		   I2S_AudioFreq_22k);
+		   SPEAKER_DEFAULT_FREQ);
 	CODEC_Config(OutputDevice_SPEAKER, I2S_Standard_Phillips,
 		     I2S_MCLKOutput_Enable, 0x08);
-	SPI_I2S_ITConfig(SPI2, SPI_I2S_IT_TXE, ENABLE);
+
+	/* Each I2S TXE request loads the next channel by DMA */
+	Speaker_DMA_Config();
+	SPI_I2S_DMACmd(SPI2, SPI_I2S_DMAReq_Tx, ENABLE);
 
 #endif
 }
 
+/*******************************************************************************
+* Function Name  : Speaker_SetFreq
+* Description    : Clock the audio output at a new sampling frequency and
+*                  restart its DMA from silence.
+* Input          : Freq: sampling frequency in Hz.
+* Return         : None.
+*******************************************************************************/
+void Speaker_SetFreq(uint32_t Freq)
+{
+	DMA_Cmd(AUDIO_OUT_DMA_CHANNEL, DISABLE);
+
+#ifdef USE_STM32L152_EVAL
+	TIM_SetAutoreload(TIM6, AUDIO_TIMER_PERIOD(Freq));
+	Speaker_DMA_Config();
+
+#elif defined(USE_STM3210B_EVAL)
+	TIM_SetAutoreload(TIM2, AUDIO_TIMER_PERIOD(Freq));
+	Speaker_DMA_Config();
+
+#else
+	/* The I2S is reset by its configuration, codec left running */
+	I2S_Config(I2S_Standard_Phillips, I2S_MCLKOutput_Enable,
+		   (uint16_t) Freq);
+	Speaker_DMA_Config();
+	SPI_I2S_DMACmd(SPI2, SPI_I2S_DMAReq_Tx, ENABLE);
+
+#endif
+}
+
+#ifdef AUDIO_CAPTURE
+/*******************************************************************************
+* Function Name  : Capture_Config
+* Description    : Configure the analog input capture: ADC1 converts on each
+*                  TIM3 update into the capture ring by circular DMA.
+* Input          : None.
+* Return         : None.
+*******************************************************************************/
+void Capture_Config(void)
+{
+	ADC_InitTypeDef ADC_InitStructure;
+	DMA_InitTypeDef DMA_InitStructure;
+	GPIO_InitTypeDef GPIO_InitStructure;
+
+	/* Configure the analog input pin */
+#ifdef USE_STM32L152_EVAL
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_GPIO_AUDIO_IN, ENABLE);
+	GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_NOPULL;
+#else
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIO_AUDIO_IN, ENABLE);
+#endif /* USE_STM32L152_EVAL */
+	GPIO_InitStructure.GPIO_Pin = AUDIO_IN_PIN;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AIN;
+	GPIO_Init(AUDIO_IN_GPIO, &GPIO_InitStructure);
+
+	/* DMA1 channel1: ADC1 to the capture ring */
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+	DMA_DeInit(AUDIO_IN_DMA_CHANNEL);
+	DMA_InitStructure.DMA_PeripheralBaseAddr = AUDIO_IN_DATA_ADDRESS;
+	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) Audio_Capture_Buffer;
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+	DMA_InitStructure.DMA_BufferSize = AUDIO_CAP_RING;
+	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize =
+	    DMA_PeripheralDataSize_HalfWord;
+	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+	DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+	DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+	DMA_Init(AUDIO_IN_DMA_CHANNEL, &DMA_InitStructure);
+	DMA_Cmd(AUDIO_IN_DMA_CHANNEL, ENABLE);
+
+#ifdef USE_STM32L152_EVAL
+	/* Enable the HSI for the ADC operations */
+	RCC_HSICmd(ENABLE);
+	while (RCC_GetFlagStatus(RCC_FLAG_HSIRDY) == RESET) ;
+
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC1, ENABLE);
+
+	/* ADC1: one left aligned conversion per TIM3 TRGO */
+	ADC_StructInit(&ADC_InitStructure);
+	ADC_InitStructure.ADC_ScanConvMode = DISABLE;
+	ADC_InitStructure.ADC_ContinuousConvMode = DISABLE;
+	ADC_InitStructure.ADC_ExternalTrigConvEdge =
+	    ADC_ExternalTrigConvEdge_Rising;
+	ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_T3_TRGO;
+	ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Left;
+	ADC_InitStructure.ADC_NbrOfConversion = 1;
+	ADC_Init(ADC1, &ADC_InitStructure);
+	ADC_RegularChannelConfig(ADC1, AUDIO_IN_CHANNEL, 1,
+				 AUDIO_IN_SAMPLE_TIME);
+
+	/* Enable the request after last transfer for DMA Circular mode */
+	ADC_DMARequestAfterLastTransferCmd(ADC1, ENABLE);
+	ADC_DMACmd(ADC1, ENABLE);
+	ADC_Cmd(ADC1, ENABLE);
+
+#else
+	/* ADCCLK = PCLK2/6 = 12 MHz */
+	RCC_ADCCLKConfig(RCC_PCLK2_Div6);
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC1, ENABLE);
+
+	/* ADC1: one left aligned conversion per TIM3 TRGO */
+	ADC_InitStructure.ADC_Mode = ADC_Mode_Independent;
+	ADC_InitStructure.ADC_ScanConvMode = DISABLE;
+	ADC_InitStructure.ADC_ContinuousConvMode = DISABLE;
+	ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_T3_TRGO;
+	ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Left;
+	ADC_InitStructure.ADC_NbrOfChannel = 1;
+	ADC_Init(ADC1, &ADC_InitStructure);
+	ADC_RegularChannelConfig(ADC1, AUDIO_IN_CHANNEL, 1,
+				 AUDIO_IN_SAMPLE_TIME);
+	ADC_ExternalTrigConvCmd(ADC1, ENABLE);
+
+	ADC_DMACmd(ADC1, ENABLE);
+	ADC_Cmd(ADC1, ENABLE);
+
+	/* Calibrate ADC1 */
+	ADC_ResetCalibration(ADC1);
+	while (ADC_GetResetCalibrationStatus(ADC1)) ;
+	ADC_StartCalibration(ADC1);
+	while (ADC_GetCalibrationStatus(ADC1)) ;
+
+#endif /* USE_STM32L152_EVAL */
+
+	/* TIM3 update at the sampling rate as TRGO */
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
+	TIM_DeInit(TIM3);
+	TIM_SetAutoreload(TIM3, AUDIO_TIMER_PERIOD(CAPTURE_DEFAULT_FREQ));
+	TIM_SelectOutputTrigger(TIM3, TIM_TRGOSource_Update);
+	TIM_Cmd(TIM3, ENABLE);
+}
+
+/*******************************************************************************
+* Function Name  : Capture_SetFreq
+* Description    : Trigger the analog input conversions at a new sampling
+*                  frequency.
+* Input          : Freq: sampling frequency in Hz.
+* Return         : None.
+*******************************************************************************/
+void Capture_SetFreq(uint32_t Freq)
+{
+	TIM_SetAutoreload(TIM3, AUDIO_TIMER_PERIOD(Freq));
+}
+#endif /* AUDIO_CAPTURE */
+
+/*******************************************************************************
+* Function Name  : Speaker_DMA_Config
+* Description    : Configure the circular DMA feeding the audio output, with
+*                  the half transfer and transfer complete interrupts.
+* Input          : None.
+* Return         : None.
+*******************************************************************************/
+static void Speaker_DMA_Config(void)
+{
+	DMA_InitTypeDef DMA_InitStructure;
+
+	/* Enable DMA1 clock */
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+	Audio_Play_Init();
+
+	DMA_DeInit(AUDIO_OUT_DMA_CHANNEL);
+	DMA_InitStructure.DMA_PeripheralBaseAddr = AUDIO_OUT_DATA_ADDRESS;
+	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) Audio_Play_Buffer;
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+	DMA_InitStructure.DMA_BufferSize = 2 * AUDIO_PLAY_HALF;
+	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize = AUDIO_OUT_DATA_SIZE;
+	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+	DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+	DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+	DMA_Init(AUDIO_OUT_DMA_CHANNEL, &DMA_InitStructure);
+
+	/* One half is refilled while the other one is sent */
+	DMA_ITConfig(AUDIO_OUT_DMA_CHANNEL, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+	DMA_Cmd(AUDIO_OUT_DMA_CHANNEL, ENABLE);
+}
+
 /*******************************************************************************
 * Function Name  : Get_SerialNum.
 * Description    : Create the serial number string descriptor.
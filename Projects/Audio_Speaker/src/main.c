@@ -38,9 +38,6 @@
 /* Private variables ---------------------------------------------------------*/
 /* Extern variables ----------------------------------------------------------*/
 extern uint32_t MUTE_DATA;
-extern uint16_t In_Data_Offset;
-extern uint16_t Out_Data_Offset;
-extern uint8_t Stream_Buff[24];
 extern uint8_t IT_Clock_Sent;
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -58,6 +55,9 @@ int main(void)
 	USB_Config();
 	USB_Init();
 	Speaker_Config();
+#ifdef AUDIO_CAPTURE
+	Capture_Config();
+#endif /* AUDIO_CAPTURE */
 	while (1) {
 	}
 }
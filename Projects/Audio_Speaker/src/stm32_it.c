@@ -33,6 +33,7 @@
 #include "usb_istr.h"
 #include "usb_lib.h"
 #include "usb_pwr.h"
+#include "audio_play.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -40,10 +41,6 @@
 
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-uint16_t Out_Data_Offset;
-extern uint16_t In_Data_Offset;
-extern uint8_t Stream_Buff[24];
-extern uint32_t MUTE_DATA;
 
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -197,28 +194,26 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
 	USB_Istr();
 }
 
-#ifdef USE_STM3210B_EVAL
 /*******************************************************************************
-* Function Name  : TIM2_IRQHandler
-* Description    : This function handles TIM2 global interrupt request.
+* Function Name  : AUDIO_OUT_DMA_IRQHandler
+* Description    : This function handles the audio output DMA interrupt
+*                  request: the half just sent is refilled.
 * Input          : None
 * Output         : None
 * Return         : None
 *******************************************************************************/
-void TIM2_IRQHandler(void)
+void AUDIO_OUT_DMA_IRQHandler(void)
 {
-	if (TIM_GetITStatus(TIM2, TIM_IT_Update) != RESET) {
-		/* Clear TIM2 update interrupt */
-		TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+	if (DMA_GetITStatus(AUDIO_OUT_DMA_IT_HT) != RESET) {
+		DMA_ClearITPendingBit(AUDIO_OUT_DMA_IT_HT);
+		Audio_Play_Fill(0);
+	}
 
-		if ((Out_Data_Offset < In_Data_Offset)
-		    && ((uint8_t) (MUTE_DATA) == 0)) {
-			TIM_SetCompare3(TIM4, Stream_Buff[Out_Data_Offset]);
-			Out_Data_Offset++;
-		}
+	if (DMA_GetITStatus(AUDIO_OUT_DMA_IT_TC) != RESET) {
+		DMA_ClearITPendingBit(AUDIO_OUT_DMA_IT_TC);
+		Audio_Play_Fill(1);
 	}
 }
-#endif /* USE_STM3210B_EVAL */
 
 #if defined (USE_STM3210E_EVAL)
 /*******************************************************************************
@@ -230,58 +225,18 @@ void TIM2_IRQHandler(void)
 *******************************************************************************/
 void SPI2_IRQHandler(void)
 {
-	static uint8_t channel = 0;
-
 	if ((SPI_I2S_GetITStatus(SPI2, SPI_I2S_IT_TXE) == SET)) {
-		/* Audio codec configuration section */
+		/* Audio codec configuration section, the samples are sent by
+		   DMA once it is done */
 		if (GetVar_SendDummyData() == 1) {
 			/* Send a dummy data just to generate the I2S clock */
 			SPI_I2S_SendData(SPI2, DUMMYDATA);
 		}
-
-		else if ((Out_Data_Offset < In_Data_Offset)
-			 && ((uint8_t) (MUTE_DATA) == 0)) {
-			if ((channel++) & 1) {
-				SPI_I2S_SendData(SPI2,
-						 (uint16_t)
-						 Stream_Buff
-						 [Out_Data_Offset++]);
-			} else {
-				SPI_I2S_SendData(SPI2,
-						 (uint16_t)
-						 Stream_Buff[Out_Data_Offset]);
-			}
-		}
 	}
 }
 
 #endif /* USE_STM3210E_EVAL */
 
-#if defined(STM32L1XX_MD)
-
-/**
-  * @brief  This function handles TIM6 global interrupt request.
-  * @param  None
-  * @retval None
-  */
-void TIM6_IRQHandler(void)
-{
-	if (TIM_GetITStatus(TIM6, TIM_IT_Update) != RESET) {
-		/* Clear TIM6 update interrupt */
-		TIM_ClearITPendingBit(TIM6, TIM_IT_Update);
-
-		if ((Out_Data_Offset < In_Data_Offset)
-		    && ((uint8_t) (MUTE_DATA) == 0)) {
-			/* Set DAC Channel1 DHR register */
-			DAC_SetChannel1Data(DAC_Align_8b_R,
-					    Stream_Buff[Out_Data_Offset]);
-			Out_Data_Offset++;
-		}
-	}
-}
-
-#endif /* STM32L1XX_XD */
-
 /*******************************************************************************
 * Function Name  : USB_HP_IRQHandler
 * Description    : This function handles USB High Priority interrupts  requests.
@@ -28,6 +28,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "usb_lib.h"
 #include "usb_desc.h"
+#include "audio_feedback.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -43,7 +44,7 @@ const uint8_t Speaker_DeviceDescriptor[] = {
 	0x00,			/* bDeviceClass */
 	0x00,			/* bDeviceSubClass */
 	0x00,			/* bDeviceProtocol */
-	0x40,			/* bMaxPacketSize 40 */
+	0x20,			/* bMaxPacketSize 32 */
 	0x83,			/* idVendor */
 	0x04,
 	0x30,			/* idProduct  = 0x5730 */
@@ -62,9 +63,9 @@ const uint8_t Speaker_ConfigDescriptor[] = {
 	/* Configuration 1 */
 	0x09,			/* bLength */
 	USB_CONFIGURATION_DESCRIPTOR_TYPE,	/* bDescriptorType */
-	0x6D,			/* wTotalLength  110 bytes */
-	0x00,
-	0x02,			/* bNumInterfaces */
+	(uint8_t) SPEAKER_SIZ_CONFIG_DESC,	/* wTotalLength */
+	(uint8_t) (SPEAKER_SIZ_CONFIG_DESC >> 8),
+	AUDIO_NUM_INTERFACES,	/* bNumInterfaces */
 	0x01,			/* bConfigurationValue */
 	0x00,			/* iConfiguration */
 	0xC0,			/* bmAttributes Self Powred */
@@ -84,16 +85,29 @@ const uint8_t Speaker_ConfigDescriptor[] = {
 	/* 09 byte */
 
 	/* USB Speaker Class-specific AC Interface Descriptor */
+#ifdef AUDIO_CAPTURE
+	0x0A,			/* bLength */
+#else
 	SPEAKER_SIZ_INTERFACE_DESC_SIZE,	/* bLength */
+#endif /* AUDIO_CAPTURE */
 	AUDIO_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	AUDIO_CONTROL_HEADER,	/* bDescriptorSubtype */
 	0x00,			/* 1.00 *//* bcdADC */
 	0x01,
-	0x27,			/* wTotalLength = 39 */
+#ifdef AUDIO_CAPTURE
+	0x3E,			/* wTotalLength = 62 */
+	0x00,
+	0x02,			/* bInCollection */
+	0x01,			/* baInterfaceNr(1) speaker stream */
+	0x02,			/* baInterfaceNr(2) capture stream */
+	/* 10 byte */
+#else
+	0x28,			/* wTotalLength = 40 */
 	0x00,
 	0x01,			/* bInCollection */
 	0x01,			/* baInterfaceNr */
 	/* 09 byte */
+#endif /* AUDIO_CAPTURE */
 
 	/* USB Speaker Input Terminal Descriptor */
 	AUDIO_INPUT_TERMINAL_DESC_SIZE,	/* bLength */
@@ -103,24 +117,25 @@ const uint8_t Speaker_ConfigDescriptor[] = {
 	0x01,			/* wTerminalType AUDIO_TERMINAL_USB_STREAMING   0x0101 */
 	0x01,
 	0x00,			/* bAssocTerminal */
-	0x01,			/* bNrChannels */
-	0x00,			/* wChannelConfig 0x0000  Mono */
+	SPEAKER_CHANNELS,	/* bNrChannels */
+	0x03,			/* wChannelConfig 0x0003  Left Front, Right Front */
 	0x00,
 	0x00,			/* iChannelNames */
 	0x00,			/* iTerminal */
 	/* 12 byte */
 
 	/* USB Speaker Audio Feature Unit Descriptor */
-	0x09,			/* bLength */
+	0x0A,			/* bLength */
 	AUDIO_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	AUDIO_CONTROL_FEATURE_UNIT,	/* bDescriptorSubtype */
 	0x02,			/* bUnitID */
 	0x01,			/* bSourceID */
 	0x01,			/* bControlSize */
-	AUDIO_CONTROL_MUTE,	/* bmaControls(0) */
+	AUDIO_CONTROL_MUTE | AUDIO_CONTROL_VOLUME,	/* bmaControls(0) */
 	0x00,			/* bmaControls(1) */
+	0x00,			/* bmaControls(2) */
 	0x00,			/* iTerminal */
-	/* 09 byte */
+	/* 10 byte */
 
 	/*USB Speaker Output Terminal Descriptor */
 	0x09,			/* bLength */
@@ -134,6 +149,35 @@ const uint8_t Speaker_ConfigDescriptor[] = {
 	0x00,			/* iTerminal */
 	/* 09 byte */
 
+#ifdef AUDIO_CAPTURE
+	/* USB Capture Input Terminal Descriptor */
+	AUDIO_INPUT_TERMINAL_DESC_SIZE,	/* bLength */
+	AUDIO_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
+	AUDIO_CONTROL_INPUT_TERMINAL,	/* bDescriptorSubtype */
+	0x04,			/* bTerminalID */
+	0x01,			/* wTerminalType Microphone 0x0201 */
+	0x02,
+	0x00,			/* bAssocTerminal */
+	CAPTURE_CHANNELS,	/* bNrChannels */
+	0x00,			/* wChannelConfig 0x0000  Mono */
+	0x00,
+	0x00,			/* iChannelNames */
+	0x00,			/* iTerminal */
+	/* 12 byte */
+
+	/* USB Capture Output Terminal Descriptor */
+	0x09,			/* bLength */
+	AUDIO_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
+	AUDIO_CONTROL_OUTPUT_TERMINAL,	/* bDescriptorSubtype */
+	0x05,			/* bTerminalID */
+	0x01,			/* wTerminalType AUDIO_TERMINAL_USB_STREAMING   0x0101 */
+	0x01,
+	0x00,			/* bAssocTerminal */
+	0x04,			/* bSourceID */
+	0x00,			/* iTerminal */
+	/* 09 byte */
+#endif /* AUDIO_CAPTURE */
+
 	/* USB Speaker Standard AS Interface Descriptor - Audio Streaming Zero Bandwith */
 	/* Interface 1, Alternate Setting 0                                             */
 	SPEAKER_SIZ_INTERFACE_DESC_SIZE,	/* bLength */
@@ -153,7 +197,7 @@ const uint8_t Speaker_ConfigDescriptor[] = {
 	USB_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	0x01,			/* bInterfaceNumber */
 	0x01,			/* bAlternateSetting */
-	0x01,			/* bNumEndpoints */
+	0x02,			/* bNumEndpoints */
 	USB_DEVICE_CLASS_AUDIO,	/* bInterfaceClass */
 	AUDIO_SUBCLASS_AUDIOSTREAMING,	/* bInterfaceSubClass */
 	AUDIO_PROTOCOL_UNDEFINED,	/* bInterfaceProtocol */
@@ -166,32 +210,128 @@ const uint8_t Speaker_ConfigDescriptor[] = {
 	AUDIO_STREAMING_GENERAL,	/* bDescriptorSubtype */
 	0x01,			/* bTerminalLink */
 	0x01,			/* bDelay */
-	0x02,			/* wFormatTag AUDIO_FORMAT_PCM8  0x0002 */
-	0x00,
+	(uint8_t) AUDIO_FORMAT_PCM,	/* wFormatTag AUDIO_FORMAT_PCM  0x0001 */
+	(uint8_t) (AUDIO_FORMAT_PCM >> 8),
 	/* 07 byte */
 
 	/* USB Speaker Audio Type I Format Interface Descriptor */
-	0x0B,			/* bLength */
+#ifdef AUDIO_CAPTURE
+	0x0E,			/* bLength */
+#else
+	0x14,			/* bLength */
+#endif /* AUDIO_CAPTURE */
 	AUDIO_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	AUDIO_STREAMING_FORMAT_TYPE,	/* bDescriptorSubtype */
 	AUDIO_FORMAT_TYPE_I,	/* bFormatType */
-	0x01,			/* bNrChannels */
-	0x01,			/* bSubFrameSize */
-	8,			/* bBitResolution */
-	0x01,			/* bSamFreqType */
-	0xF0,			/* tSamFreq 22000 = 0x55F0 */
-	0x55,
-	0x00,
-	/* 11 byte */
+	SPEAKER_CHANNELS,	/* bNrChannels */
+	SPEAKER_SUBFRAME_SIZE,	/* bSubFrameSize */
+	16,			/* bBitResolution */
+#ifdef AUDIO_CAPTURE
+	0x02,			/* bSamFreqType */
+	AUDIO_FREQ_BYTES(AUDIO_FREQ_16K),	/* tSamFreq[1] */
+	AUDIO_FREQ_BYTES(AUDIO_FREQ_32K),	/* tSamFreq[2] */
+	/* 14 byte */
+#else
+	0x04,			/* bSamFreqType */
+	AUDIO_FREQ_BYTES(AUDIO_FREQ_16K),	/* tSamFreq[1] */
+	AUDIO_FREQ_BYTES(AUDIO_FREQ_32K),	/* tSamFreq[2] */
+	AUDIO_FREQ_BYTES(AUDIO_FREQ_44K),	/* tSamFreq[3] */
+	AUDIO_FREQ_BYTES(AUDIO_FREQ_48K),	/* tSamFreq[4] */
+	/* 20 byte */
+#endif /* AUDIO_CAPTURE */
 
 	/* Endpoint 1 - Standard Descriptor */
 	AUDIO_STANDARD_ENDPOINT_DESC_SIZE,	/* bLength */
 	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	0x01,			/* bEndpointAddress 1 out endpoint */
+	USB_ENDPOINT_TYPE_ISOCHRONOUS | USB_ENDPOINT_SYNC_ASYNCHRONOUS,	/* bmAttributes */
+	(uint8_t) SPEAKER_MAX_PACKET,	/* wMaxPacketSize, one frame more than nominal at SPEAKER_MAX_FREQ */
+	(uint8_t) (SPEAKER_MAX_PACKET >> 8),
+	0x01,			/* bInterval */
+	0x00,			/* bRefresh */
+	0x82,			/* bSynchAddress feedback endpoint */
+	/* 09 byte */
+
+	/* Endpoint - Audio Streaming Descriptor */
+	AUDIO_STREAMING_ENDPOINT_DESC_SIZE,	/* bLength */
+	AUDIO_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
+	AUDIO_ENDPOINT_GENERAL,	/* bDescriptor */
+	0x01,			/* bmAttributes Sampling Frequency control */
+	0x00,			/* bLockDelayUnits */
+	0x00,			/* wLockDelay */
+	0x00,
+	/* 07 byte */
+
+	/* Endpoint 2 - Standard Descriptor, explicit feedback */
+	AUDIO_STANDARD_ENDPOINT_DESC_SIZE,	/* bLength */
+	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
+	0x82,			/* bEndpointAddress 2 in endpoint */
 	USB_ENDPOINT_TYPE_ISOCHRONOUS,	/* bmAttributes */
-	0x16,			/* wMaxPacketSize 22 bytes */
+	AUDIO_FB_SIZE,		/* wMaxPacketSize 3 bytes, 10.14 format */
 	0x00,
 	0x01,			/* bInterval */
+	AUDIO_FB_REFRESH,	/* bRefresh 2^6 = 64 ms */
+	0x00,			/* bSynchAddress */
+	/* 09 byte */
+
+#ifdef AUDIO_CAPTURE
+	/* USB Capture Standard AS Interface Descriptor - Audio Streaming Zero Bandwith */
+	/* Interface 2, Alternate Setting 0                                             */
+	SPEAKER_SIZ_INTERFACE_DESC_SIZE,	/* bLength */
+	USB_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
+	0x02,			/* bInterfaceNumber */
+	0x00,			/* bAlternateSetting */
+	0x00,			/* bNumEndpoints */
+	USB_DEVICE_CLASS_AUDIO,	/* bInterfaceClass */
+	AUDIO_SUBCLASS_AUDIOSTREAMING,	/* bInterfaceSubClass */
+	AUDIO_PROTOCOL_UNDEFINED,	/* bInterfaceProtocol */
+	0x00,			/* iInterface */
+	/* 09 byte */
+
+	/* USB Capture Standard AS Interface Descriptor - Audio Streaming Operational */
+	/* Interface 2, Alternate Setting 1                                           */
+	SPEAKER_SIZ_INTERFACE_DESC_SIZE,	/* bLength */
+	USB_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
+	0x02,			/* bInterfaceNumber */
+	0x01,			/* bAlternateSetting */
+	0x01,			/* bNumEndpoints */
+	USB_DEVICE_CLASS_AUDIO,	/* bInterfaceClass */
+	AUDIO_SUBCLASS_AUDIOSTREAMING,	/* bInterfaceSubClass */
+	AUDIO_PROTOCOL_UNDEFINED,	/* bInterfaceProtocol */
+	0x00,			/* iInterface */
+	/* 09 byte */
+
+	/* USB Capture Audio Streaming Interface Descriptor */
+	AUDIO_STREAMING_INTERFACE_DESC_SIZE,	/* bLength */
+	AUDIO_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
+	AUDIO_STREAMING_GENERAL,	/* bDescriptorSubtype */
+	0x05,			/* bTerminalLink */
+	0x01,			/* bDelay */
+	(uint8_t) AUDIO_FORMAT_PCM,	/* wFormatTag AUDIO_FORMAT_PCM  0x0001 */
+	(uint8_t) (AUDIO_FORMAT_PCM >> 8),
+	/* 07 byte */
+
+	/* USB Capture Audio Type I Format Interface Descriptor */
+	0x0E,			/* bLength */
+	AUDIO_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType */
+	AUDIO_STREAMING_FORMAT_TYPE,	/* bDescriptorSubtype */
+	AUDIO_FORMAT_TYPE_I,	/* bFormatType */
+	CAPTURE_CHANNELS,	/* bNrChannels */
+	CAPTURE_SUBFRAME_SIZE,	/* bSubFrameSize */
+	16,			/* bBitResolution */
+	0x02,			/* bSamFreqType */
+	AUDIO_FREQ_BYTES(AUDIO_FREQ_16K),	/* tSamFreq[1] */
+	AUDIO_FREQ_BYTES(AUDIO_FREQ_32K),	/* tSamFreq[2] */
+	/* 14 byte */
+
+	/* Endpoint 3 - Standard Descriptor */
+	AUDIO_STANDARD_ENDPOINT_DESC_SIZE,	/* bLength */
+	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
+	CAPTURE_EP_ADDRESS,	/* bEndpointAddress 3 in endpoint */
+	USB_ENDPOINT_TYPE_ISOCHRONOUS | USB_ENDPOINT_SYNC_ASYNCHRONOUS,	/* bmAttributes */
+	(uint8_t) CAPTURE_MAX_PACKET,	/* wMaxPacketSize, one sample more than nominal at CAPTURE_MAX_FREQ */
+	(uint8_t) (CAPTURE_MAX_PACKET >> 8),
+	0x01,			/* bInterval */
 	0x00,			/* bRefresh */
 	0x00,			/* bSynchAddress */
 	/* 09 byte */
@@ -200,11 +340,12 @@ const uint8_t Speaker_ConfigDescriptor[] = {
 	AUDIO_STREAMING_ENDPOINT_DESC_SIZE,	/* bLength */
 	AUDIO_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	AUDIO_ENDPOINT_GENERAL,	/* bDescriptor */
-	0x00,			/* bmAttributes */
+	0x01,			/* bmAttributes Sampling Frequency control */
 	0x00,			/* bLockDelayUnits */
 	0x00,			/* wLockDelay */
 	0x00,
 	/* 07 byte */
+#endif /* AUDIO_CAPTURE */
 };
 
 /* USB String Descriptor (optional) */
@@ -28,15 +28,17 @@
 /* Includes ------------------------------------------------------------------*/
 #include "usb_lib.h"
 #include "usb_istr.h"
+#include "audio_ring.h"
+#include "audio_feedback.h"
+#include "audio_capture.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-uint8_t Stream_Buff[24];
-uint16_t In_Data_Offset;
-
 /* Extern variables ----------------------------------------------------------*/
+extern __IO uint8_t bIntPackSOF;
+
 /* Private function prototypes -----------------------------------------------*/
 /* Extern function prototypes ------------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -54,14 +56,40 @@ void EP1_OUT_Callback(void)
 	if (GetENDPOINT(ENDP1) & EP_DTOG_TX) {
 		/*read from ENDP1_BUF0Addr buffer */
 		Data_Len = GetEPDblBuf0Count(ENDP1);
-		PMAToUserBufferCopy(Stream_Buff, ENDP1_BUF0Addr, Data_Len);
+		Audio_Ring_Put(ENDP1_BUF0Addr, Data_Len);
 	} else {
 		/*read from ENDP1_BUF1Addr buffer */
 		Data_Len = GetEPDblBuf1Count(ENDP1);
-		PMAToUserBufferCopy(Stream_Buff, ENDP1_BUF1Addr, Data_Len);
+		Audio_Ring_Put(ENDP1_BUF1Addr, Data_Len);
 	}
 	FreeUserBuffer(ENDP1, EP_DBUF_OUT);
-	In_Data_Offset += Data_Len;
+	bIntPackSOF = 0;
+}
+
+/*******************************************************************************
+* Function Name  : EP2_IN_Callback
+* Description    : Endpoint 2 in callback routine, feedback sent.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void EP2_IN_Callback(void)
+{
+	Audio_Feedback_Sent();
+}
+
+#ifdef AUDIO_CAPTURE
+/*******************************************************************************
+* Function Name  : EP3_IN_Callback
+* Description    : Endpoint 3 in callback routine, capture packet sent.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void EP3_IN_Callback(void)
+{
+	Audio_Capture_Sent();
 }
+#endif /* AUDIO_CAPTURE */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
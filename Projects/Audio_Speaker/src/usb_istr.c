@@ -30,6 +30,8 @@
 #include "usb_prop.h"
 #include "usb_pwr.h"
 #include "usb_istr.h"
+#include "audio_feedback.h"
+#include "audio_capture.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -41,8 +43,6 @@ __IO uint32_t esof_counter = 0;	/* expected SOF counter */
 __IO uint32_t wCNTR = 0;
 
 /* Extern variables ----------------------------------------------------------*/
-extern uint16_t In_Data_Offset;
-extern uint16_t Out_Data_Offset;
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 /* function pointers to non-control endpoints service routines */
@@ -209,7 +209,7 @@ void USB_Istr(void)
 }				/* USB_Istr */
 
 /*******************************************************************************
-* Function Name  : USB_Istr
+* Function Name  : SOF_Callback
 * Description    : Start of frame callback function.
 * Input          : None.
 * Output         : None.
@@ -217,8 +217,12 @@ void USB_Istr(void)
 *******************************************************************************/
 void SOF_Callback(void)
 {
-	In_Data_Offset = 0;
-	Out_Data_Offset = 0;
+	if (bDeviceState == CONFIGURED) {
+		Audio_Feedback_SOF();
+#ifdef AUDIO_CAPTURE
+		Audio_Capture_SOF();
+#endif /* AUDIO_CAPTURE */
+	}
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -32,12 +32,30 @@
 #include "usb_prop.h"
 #include "usb_desc.h"
 #include "usb_pwr.h"
+#include "audio_ring.h"
+#include "audio_feedback.h"
+#include "audio_volume.h"
+#include "audio_capture.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 uint32_t MUTE_DATA = 0;
+int16_t VOLUME_DATA = AUDIO_VOL_MAX;	/* 1/256 dB */
+uint32_t Speaker_Freq = SPEAKER_DEFAULT_FREQ;	/* sampling frequency in Hz */
+#ifdef AUDIO_CAPTURE
+uint32_t Capture_Freq = CAPTURE_DEFAULT_FREQ;	/* sampling frequency in Hz */
+#endif /* AUDIO_CAPTURE */
+
+static uint8_t Freq_Data[4];	/* 3-byte tSamFreq of the last request */
+static uint8_t Freq_Endpoint = 0;	/* endpoint of the last request */
+static uint8_t Request = 0;
+
+/* GET_MIN, GET_MAX and GET_RES of the volume control */
+static const int16_t Volume_Range[3] = {
+	AUDIO_VOL_MIN, AUDIO_VOL_MAX, AUDIO_VOL_RES
+};
 
 DEVICE Device_Table = {
 	EP_NUM,
@@ -56,7 +74,7 @@ DEVICE_PROP Device_Property = {
 	Speaker_GetConfigDescriptor,
 	Speaker_GetStringDescriptor,
 	0,
-	0x40			/*MAX PACKET SIZE */
+	0x20			/*MAX PACKET SIZE */
 };
 
 USER_STANDARD_REQUESTS User_Standard_Requests = {
@@ -93,10 +111,6 @@ ONE_DESCRIPTOR String_Descriptor[4] = {
 };
 
 /* Extern variables ----------------------------------------------------------*/
-/* Extern variables ----------------------------------------------------------*/
-extern uint16_t In_Data_Offset;
-extern uint16_t Out_Data_Offset;
-
 /* Private function prototypes -----------------------------------------------*/
 /* Extern function prototypes ------------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -155,21 +169,44 @@ void Speaker_Reset()
 	/* Initialize Endpoint 1 */
 	SetEPType(ENDP1, EP_ISOCHRONOUS);
 	SetEPDblBuffAddr(ENDP1, ENDP1_BUF0Addr, ENDP1_BUF1Addr);
-	SetEPDblBuffCount(ENDP1, EP_DBUF_OUT, 0x40);
+	SetEPDblBuffCount(ENDP1, EP_DBUF_OUT, SPEAKER_PACKET_SIZE(Speaker_Freq));
 	ClearDTOG_RX(ENDP1);
 	ClearDTOG_TX(ENDP1);
 	ToggleDTOG_TX(ENDP1);
 	SetEPRxStatus(ENDP1, EP_RX_VALID);
 	SetEPTxStatus(ENDP1, EP_TX_DIS);
 
+	/* Initialize Endpoint 2 */
+	SetEPType(ENDP2, EP_ISOCHRONOUS);
+	SetEPDblBuffAddr(ENDP2, ENDP2_BUF0Addr, ENDP2_BUF1Addr);
+	SetEPDblBuffCount(ENDP2, EP_DBUF_IN, AUDIO_FB_SIZE);
+	ClearDTOG_RX(ENDP2);
+	ClearDTOG_TX(ENDP2);
+	SetEPRxStatus(ENDP2, EP_RX_DIS);
+	SetEPTxStatus(ENDP2, EP_TX_VALID);
+
+#ifdef AUDIO_CAPTURE
+	/* Initialize Endpoint 3 */
+	SetEPType(ENDP3, EP_ISOCHRONOUS);
+	SetEPDblBuffAddr(ENDP3, ENDP3_BUF0Addr, ENDP3_BUF1Addr);
+	SetEPDblBuffCount(ENDP3, EP_DBUF_IN, 0);
+	ClearDTOG_RX(ENDP3);
+	ClearDTOG_TX(ENDP3);
+	SetEPRxStatus(ENDP3, EP_RX_DIS);
+	SetEPTxStatus(ENDP3, EP_TX_VALID);
+#endif /* AUDIO_CAPTURE */
+
 	SetEPRxValid(ENDP0);
 	/* Set this device to response on default address */
 	SetDeviceAddress(0);
 
 	bDeviceState = ATTACHED;
 
-	In_Data_Offset = 0;
-	Out_Data_Offset = 0;
+	Audio_Ring_Init();
+	Audio_Feedback_Init(Speaker_Freq);
+#ifdef AUDIO_CAPTURE
+	Audio_Capture_Init(Capture_Freq);
+#endif /* AUDIO_CAPTURE */
 }
 
 /*******************************************************************************
@@ -203,13 +240,57 @@ void Speaker_SetDeviceAddress(void)
 
 /*******************************************************************************
 * Function Name  : Speaker_Status_In.
-* Description    : Speaker Status In routine.
+* Description    : Speaker Status In routine: apply a SET_CUR sampling
+*                  frequency once its data stage is over. The stream restarts
+*                  from an empty ring with packets sized for the new rate.
+*                  The capture endpoint only retimes the ADC trigger.
 * Input          : None.
 * Output         : None.
 * Return         : None.
 *******************************************************************************/
 void Speaker_Status_In(void)
 {
+	uint32_t Freq = 0;
+	uint8_t RequestNo = Request;
+
+	Request = 0;
+	if (RequestNo != SET_CUR) {
+		return;
+	}
+
+	Freq = Freq_Data[0] | ((uint32_t) Freq_Data[1] << 8)
+	    | ((uint32_t) Freq_Data[2] << 16);
+
+	switch (Freq) {
+	case AUDIO_FREQ_16K:
+	case AUDIO_FREQ_32K:
+	case AUDIO_FREQ_44K:
+	case AUDIO_FREQ_48K:
+		break;
+	default:
+		return;
+	}
+
+#ifdef AUDIO_CAPTURE
+	if (Freq_Endpoint == CAPTURE_EP_ADDRESS) {
+		if (Freq <= CAPTURE_MAX_FREQ) {
+			Capture_Freq = Freq;
+			Capture_SetFreq(Freq);
+			Audio_Capture_Init(Freq);
+		}
+		return;
+	}
+#endif /* AUDIO_CAPTURE */
+
+	if (Freq > SPEAKER_MAX_FREQ) {
+		return;
+	}
+
+	Speaker_Freq = Freq;
+	SetEPDblBuffCount(ENDP1, EP_DBUF_OUT, SPEAKER_PACKET_SIZE(Freq));
+	Audio_Ring_Init();
+	Speaker_SetFreq(Freq);
+	Audio_Feedback_Init(Freq);
 }
 
 /*******************************************************************************
@@ -235,7 +316,31 @@ RESULT Speaker_Data_Setup(uint8_t RequestNo)
 	uint8_t *(*CopyRoutine) (uint16_t);
 	CopyRoutine = NULL;
 
-	if ((RequestNo == GET_CUR) || (RequestNo == SET_CUR)) {
+	if (Type_Recipient == (VENDOR_REQUEST | DEVICE_RECIPIENT)) {
+		if (RequestNo == AUDIO_REQ_GET_STATS) {
+			CopyRoutine = Audio_Ring_GetStats;
+		} else {
+			return USB_UNSUPPORT;
+		}
+	}
+
+	else if ((Type_Recipient == (CLASS_REQUEST | ENDPOINT_RECIPIENT))
+		 && (pInformation->USBwValue1 == AUDIO_CONTROL_SAMPLING_FREQ)
+		 && ((RequestNo == GET_CUR) || (RequestNo == SET_CUR))) {
+		CopyRoutine = Freq_Command;
+		Request = RequestNo;
+		Freq_Endpoint = pInformation->USBwIndex0;
+	}
+
+	else if ((Type_Recipient == (CLASS_REQUEST | INTERFACE_RECIPIENT))
+		 && (pInformation->USBwValue1 == AUDIO_FU_VOLUME_CONTROL)
+		 && ((RequestNo == GET_CUR) || (RequestNo == SET_CUR)
+		     || (RequestNo == GET_MIN) || (RequestNo == GET_MAX)
+		     || (RequestNo == GET_RES))) {
+		CopyRoutine = Volume_Command;
+	}
+
+	else if ((RequestNo == GET_CUR) || (RequestNo == SET_CUR)) {
 		CopyRoutine = Mute_Command;
 	}
 
@@ -258,6 +363,12 @@ RESULT Speaker_Data_Setup(uint8_t RequestNo)
 *******************************************************************************/
 RESULT Speaker_NoData_Setup(uint8_t RequestNo)
 {
+	if ((Type_Recipient == (VENDOR_REQUEST | DEVICE_RECIPIENT))
+	    && (RequestNo == AUDIO_REQ_CLEAR_STATS)) {
+		Audio_Ring_ClearStats();
+		return USB_SUCCESS;
+	}
+
 	return USB_UNSUPPORT;
 }
 
@@ -318,7 +429,7 @@ RESULT Speaker_Get_Interface_Setting(uint8_t Interface,
 {
 	if (AlternateSetting > 1) {
 		return USB_UNSUPPORT;
-	} else if (Interface > 1) {
+	} else if (Interface > (AUDIO_NUM_INTERFACES - 1)) {
 		return USB_UNSUPPORT;
 	}
 	return USB_SUCCESS;
@@ -343,4 +454,58 @@ uint8_t *Mute_Command(uint16_t Length)
 	}
 }
 
+/*******************************************************************************
+* Function Name  : Volume_Command
+* Description    : Handle the GET CUR, SET CUR, GET MIN, GET MAX and GET RES
+*                  volume commands. The volume is applied by the playback.
+* Input          : Length : uint16_t.
+* Output         : None.
+* Return         : The address of the 2-byte value.
+*******************************************************************************/
+uint8_t *Volume_Command(uint16_t Length)
+{
+	uint8_t RequestNo = pInformation->USBbRequest;
+	uint8_t *pData = (uint8_t *) (&VOLUME_DATA);
+
+	if ((RequestNo != GET_CUR) && (RequestNo != SET_CUR)) {
+		pData = (uint8_t *) (&Volume_Range[RequestNo - GET_MIN]);
+	}
+
+	if (Length == 0) {
+		pInformation->Ctrl_Info.Usb_wLength = 2;
+		return NULL;
+	} else {
+		return pData + pInformation->Ctrl_Info.Usb_wOffset;
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Freq_Command
+* Description    : Handle the GET CUR and SET CUR sampling frequency commands
+*                  of the streaming endpoints.
+* Input          : Length : uint16_t.
+* Output         : None.
+* Return         : The address of the 3-byte frequency.
+*******************************************************************************/
+uint8_t *Freq_Command(uint16_t Length)
+{
+	if (Length == 0) {
+		if (Request == GET_CUR) {
+			uint32_t Freq = Speaker_Freq;
+#ifdef AUDIO_CAPTURE
+			if (Freq_Endpoint == CAPTURE_EP_ADDRESS) {
+				Freq = Capture_Freq;
+			}
+#endif /* AUDIO_CAPTURE */
+			Freq_Data[0] = (uint8_t) Freq;
+			Freq_Data[1] = (uint8_t) (Freq >> 8);
+			Freq_Data[2] = (uint8_t) (Freq >> 16);
+		}
+		pInformation->Ctrl_Info.Usb_wLength = 3;
+		return NULL;
+	} else {
+		return &Freq_Data[pInformation->Ctrl_Info.Usb_wOffset];
+	}
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
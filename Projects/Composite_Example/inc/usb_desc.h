@@ -54,6 +54,8 @@
 
 #define STANDARD_ENDPOINT_DESC_SIZE             0x09
 
+#define HID_IN_INTERVAL                         0x20	/* frames */
+
 /* Exported functions ------------------------------------------------------- */
 extern const uint8_t Composite_DeviceDescriptor[Composite_SIZ_DEVICE_DESC];
 extern const uint8_t Composite_ConfigDescriptor[Composite_SIZ_CONFIG_DESC];
@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file    usb_sched.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Frame scheduler between the Custom HID and Mass Storage functions
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USB_SCHED_H
+#define __USB_SCHED_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw_config.h"
+#include "usb_desc.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum _SCHED_FUNC {
+	SCHED_FUNC_HID = 0,
+	SCHED_FUNC_MSC,
+	SCHED_FUNC_NUM
+} SCHED_FUNC;
+
+typedef struct _SCHED_STATS {
+	uint32_t Serviced;	/* transactions handed to the function */
+	uint32_t Deferred;	/* transactions postponed to a later frame */
+	uint32_t DeadlineMiss;	/* transactions served after their deadline */
+	uint32_t MaxLatency;	/* worst service latency, in frames */
+} SCHED_STATS;
+
+/* Exported constants --------------------------------------------------------*/
+/* HID reports must reach the host within one polling interval */
+#define SCHED_HID_DEADLINE         HID_IN_INTERVAL
+#define SCHED_HID_REPORT_SIZE      2
+#define SCHED_HID_SLOTS            4	/* pending reports, one per report ID */
+
+/* Bulk packets the Mass Storage function may service in one frame while a
+   HID report is pending or in flight, the rest is left NAKed until the next
+   SOF. With HID idle the whole frame is left to Mass Storage. */
+#define SCHED_MSC_FRAME_BUDGET     12
+#define SCHED_MSC_DEADLINE         2	/* frames a deferred packet may wait */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported variables --------------------------------------------------------*/
+extern __IO SCHED_STATS Sched_Stats[SCHED_FUNC_NUM];
+extern __IO uint32_t Sched_FrameCount;
+
+/* Exported functions ------------------------------------------------------- */
+void Sched_Init(void);
+void Sched_SOF(void);
+void Sched_HID_Submit(uint8_t * Report);
+void Sched_HID_InComplete(void);
+void Sched_MSC_In(void);
+void Sched_MSC_Out(void);
+
+#endif /* __USB_SCHED_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
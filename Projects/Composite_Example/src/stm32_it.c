@@ -34,13 +34,13 @@
 #include "usb_lib.h"
 #include "usb_pwr.h"
 #include "hw_config.h"
+#include "usb_sched.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 __IO uint8_t Send_Buffer[2];
-extern __IO uint8_t PrevXferComplete;
 extern uint32_t ADC_ConvertedValueX;
 extern uint32_t ADC_ConvertedValueX_1;
 extern __IO uint32_t TimingDelay;
@@ -197,7 +197,7 @@ void EXTI15_10_IRQHandler(void)
 {
 	/* Check on the RIGHT button */
 	if (EXTI_GetITStatus(RIGHT_BUTTON_EXTI_LINE) != RESET) {
-		if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
+		if (bDeviceState == CONFIGURED) {
 			Send_Buffer[0] = 0x05;
 
 			if (STM_EVAL_PBGetState(Button_RIGHT) == Bit_RESET) {
@@ -206,12 +206,8 @@ void EXTI15_10_IRQHandler(void)
 				Send_Buffer[1] = 0x00;
 			}
 
-			/* Write the descriptor through the endpoint */
-			USB_SIL_Write(EP1_IN, (uint8_t *) Send_Buffer, 2);
-
-			SetEPTxValid(ENDP1);
-
-			PrevXferComplete = 0;
+			/* Queue the report, it is sent as soon as EP1 is free */
+			Sched_HID_Submit((uint8_t *) Send_Buffer);
 		}
 		/* Clear the EXTI line  pending bit */
 		EXTI_ClearITPendingBit(RIGHT_BUTTON_EXTI_LINE);
@@ -219,7 +215,7 @@ void EXTI15_10_IRQHandler(void)
 
 	/* Check on the LEFT button */
 	if (EXTI_GetITStatus(LEFT_BUTTON_EXTI_LINE) != RESET) {
-		if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
+		if (bDeviceState == CONFIGURED) {
 			Send_Buffer[0] = 0x06;
 
 			if (STM_EVAL_PBGetState(Button_LEFT) == Bit_RESET) {
@@ -228,12 +224,8 @@ void EXTI15_10_IRQHandler(void)
 				Send_Buffer[1] = 0x00;
 			}
 
-			/* Write the descriptor through the endpoint */
-			USB_SIL_Write(EP1_IN, (uint8_t *) Send_Buffer, 2);
-
-			SetEPTxValid(ENDP1);
-
-			PrevXferComplete = 0;
+			/* Queue the report, it is sent as soon as EP1 is free */
+			Sched_HID_Submit((uint8_t *) Send_Buffer);
 		}
 		/* Clear the EXTI line  pending bit */
 		EXTI_ClearITPendingBit(LEFT_BUTTON_EXTI_LINE);
@@ -252,14 +244,12 @@ void DMA1_Channel1_IRQHandler(void)
 	Send_Buffer[0] = 0x07;
 
 	if ((ADC_ConvertedValueX >> 4) - (ADC_ConvertedValueX_1 >> 4) > 4) {
-		if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
+		if (bDeviceState == CONFIGURED) {
 			Send_Buffer[1] = (uint8_t) (ADC_ConvertedValueX >> 4);
 
-			/* Write the descriptor through the endpoint */
-			USB_SIL_Write(EP1_IN, (uint8_t *) Send_Buffer, 2);
-			SetEPTxValid(ENDP1);
+			/* Queue the report, it is sent as soon as EP1 is free */
+			Sched_HID_Submit((uint8_t *) Send_Buffer);
 			ADC_ConvertedValueX_1 = ADC_ConvertedValueX;
-			PrevXferComplete = 0;
 		}
 	}
 
@@ -282,7 +272,7 @@ void EXTI9_5_IRQHandler(void)
 #endif
 {
 	if (EXTI_GetITStatus(KEY_BUTTON_EXTI_LINE) != RESET) {
-		if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
+		if (bDeviceState == CONFIGURED) {
 			Send_Buffer[0] = 0x05;
 #if defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
 			if (!STM_EVAL_PBGetState(Button_KEY) == Bit_RESET)
@@ -295,10 +285,8 @@ void EXTI9_5_IRQHandler(void)
 				Send_Buffer[1] = 0x00;
 			}
 
-			/* Write the descriptor through the endpoint */
-			USB_SIL_Write(EP1_IN, (uint8_t *) Send_Buffer, 2);
-			SetEPTxValid(ENDP1);
-			PrevXferComplete = 0;
+			/* Queue the report, it is sent as soon as EP1 is free */
+			Sched_HID_Submit((uint8_t *) Send_Buffer);
 		}
 		/* Clear the EXTI line  pending bit */
 		EXTI_ClearITPendingBit(KEY_BUTTON_EXTI_LINE);
@@ -316,7 +304,7 @@ void EXTI9_5_IRQHandler(void)
 void EXTI15_10_IRQHandler(void)
 {
 	if (EXTI_GetITStatus(TAMPER_BUTTON_EXTI_LINE) != RESET) {
-		if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
+		if (bDeviceState == CONFIGURED) {
 			Send_Buffer[0] = 0x06;
 
 			if (STM_EVAL_PBGetState(Button_TAMPER) == Bit_RESET) {
@@ -325,12 +313,8 @@ void EXTI15_10_IRQHandler(void)
 				Send_Buffer[1] = 0x00;
 			}
 
-			/* Write the descriptor through the endpoint */
-			USB_SIL_Write(EP1_IN, (uint8_t *) Send_Buffer, 2);
-
-			SetEPTxValid(ENDP1);
-
-			PrevXferComplete = 0;
+			/* Queue the report, it is sent as soon as EP1 is free */
+			Sched_HID_Submit((uint8_t *) Send_Buffer);
 		}
 		/* Clear the EXTI line 13 pending bit */
 		EXTI_ClearITPendingBit(TAMPER_BUTTON_EXTI_LINE);
@@ -110,7 +110,7 @@ const uint8_t Composite_ConfigDescriptor[Composite_SIZ_CONFIG_DESC] = {
 	0x03,			/* bmAttributes: Interrupt endpoint */
 	0x02,			/* wMaxPacketSize: 2 Bytes max */
 	0x00,
-	0x20,			/* bInterval: Polling Interval (32 ms) */
+	HID_IN_INTERVAL,	/* bInterval: Polling Interval (32 ms) */
 	/* 34 */
 
 	0x07,			/* bLength: Endpoint Descriptor size */
@@ -31,13 +31,13 @@
 #include "usb_lib.h"
 #include "usb_istr.h"
 #include "usb_bot.h"
+#include "usb_sched.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 uint8_t Receive_Buffer[2];
-extern __IO uint8_t PrevXferComplete;
 
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -111,7 +111,7 @@ void EP1_OUT_Callback(void)
 *******************************************************************************/
 void EP1_IN_Callback(void)
 {
-	PrevXferComplete = 1;
+	Sched_HID_InComplete();
 }
 
 /*******************************************************************************
@@ -123,7 +123,7 @@ void EP1_IN_Callback(void)
 *******************************************************************************/
 void EP2_IN_Callback(void)
 {
-	Mass_Storage_In();
+	Sched_MSC_In();
 }
 
 /*******************************************************************************
@@ -135,7 +135,19 @@ void EP2_IN_Callback(void)
 *******************************************************************************/
 void EP2_OUT_Callback(void)
 {
-	Mass_Storage_Out();
+	Sched_MSC_Out();
+}
+
+/*******************************************************************************
+* Function Name  : SOF_Callback
+* Description    : Start of frame: run the HID / Mass Storage scheduler.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void SOF_Callback(void)
+{
+	Sched_SOF();
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
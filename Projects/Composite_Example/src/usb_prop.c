@@ -36,6 +36,7 @@
 #include "usb_bot.h"
 #include "memory.h"
 #include "mass_mal.h"
+#include "usb_sched.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -200,8 +201,8 @@ void CustomHID_Reset(void)
 	SetEPTxStatus(ENDP1, EP_TX_NAK);
 	/* Initialize Endpoint 2 IN */
 	SetEPType(ENDP2, EP_BULK);
-	SetEPTxCount(ENDP1, 64);
-	SetEPTxAddr(ENDP2, ENDP1_TXADDR);
+	SetEPTxCount(ENDP2, 64);
+	SetEPTxAddr(ENDP2, ENDP2_TXADDR);
 	SetEPTxStatus(ENDP2, EP_TX_NAK);
 
 	/* Initialize Endpoint 2 OUT */
@@ -214,6 +215,7 @@ void CustomHID_Reset(void)
 	SetDeviceAddress(0);
 	CBW.dSignature = BOT_CBW_SIGNATURE;
 	Bot_State = BOT_IDLE;
+	Sched_Init();
 	bDeviceState = ATTACHED;
 }
 
@@ -0,0 +1,350 @@
+/**
+  ******************************************************************************
+  * @file    usb_sched.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Frame scheduler between the Custom HID and Mass Storage functions.
+  *          HID reports are loaded in EP1 first at every scheduling point,
+  *          Mass Storage gets SCHED_MSC_FRAME_BUDGET bulk packets per frame
+  *          and its remaining packets are replayed in order on the next SOF.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "usb_pwr.h"
+#include "usb_bot.h"
+#include "usb_sched.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct _SCHED_HID_SLOT {
+	uint8_t Report[SCHED_HID_REPORT_SIZE];
+	uint8_t Pending;
+	uint32_t Stamp;		/* frame the report became pending */
+} SCHED_HID_SLOT;
+
+/* Private define ------------------------------------------------------------*/
+#define SCHED_MSC_IN               1
+#define SCHED_MSC_OUT              2
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+__IO SCHED_STATS Sched_Stats[SCHED_FUNC_NUM];
+__IO uint32_t Sched_FrameCount = 0;
+
+static SCHED_HID_SLOT HID_Slot[SCHED_HID_SLOTS];
+static uint32_t HID_InFlightStamp = 0;
+static uint32_t MSC_Budget = SCHED_MSC_FRAME_BUDGET;
+/* Both endpoint directions stay NAKed while their event is deferred: at most
+   the CSW IN completion and the next CBW OUT reception can wait here */
+static uint8_t MSC_Deferred[2];
+static uint8_t MSC_DeferredCount = 0;
+static uint32_t MSC_DeferStamp = 0;
+
+/* Extern variables ----------------------------------------------------------*/
+extern __IO uint8_t PrevXferComplete;
+
+/* Private function prototypes -----------------------------------------------*/
+static void Sched_HID_Service(void);
+static uint8_t Sched_HID_Busy(void);
+static void Sched_MSC_Run(uint8_t Event);
+static void Sched_MSC_Event(uint8_t Event);
+static void Sched_Account(SCHED_FUNC Func, uint32_t Stamp, uint32_t Deadline);
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : Sched_Init
+* Description    : Reset the scheduler state, called on USB reset.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Sched_Init(void)
+{
+	uint32_t index = 0;
+
+	for (index = 0; index < SCHED_HID_SLOTS; index++) {
+		HID_Slot[index].Pending = 0;
+	}
+	for (index = 0; index < SCHED_FUNC_NUM; index++) {
+		Sched_Stats[index].Serviced = 0;
+		Sched_Stats[index].Deferred = 0;
+		Sched_Stats[index].DeadlineMiss = 0;
+		Sched_Stats[index].MaxLatency = 0;
+	}
+	MSC_Budget = SCHED_MSC_FRAME_BUDGET;
+	MSC_DeferredCount = 0;
+	PrevXferComplete = 1;
+}
+
+/*******************************************************************************
+* Function Name  : Sched_SOF
+* Description    : Start of a new frame: refill the Mass Storage budget after
+*                  giving HID the endpoint, then replay deferred packets, all
+*                  of them once HID is idle.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Sched_SOF(void)
+{
+	uint8_t event = 0;
+
+	Sched_FrameCount++;
+	MSC_Budget = SCHED_MSC_FRAME_BUDGET;
+
+	Sched_HID_Service();
+
+	while ((MSC_DeferredCount != 0)
+	       && ((MSC_Budget != 0) || (Sched_HID_Busy() == 0))) {
+		event = MSC_Deferred[0];
+		MSC_Deferred[0] = MSC_Deferred[1];
+		MSC_DeferredCount--;
+
+		Sched_Account(SCHED_FUNC_MSC, MSC_DeferStamp,
+			      SCHED_MSC_DEADLINE);
+		Sched_MSC_Run(event);
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Sched_HID_Submit
+* Description    : Queue an IN report, a pending report with the same ID is
+*                  replaced by the newer value. Callable from any interrupt.
+* Input          : Report: SCHED_HID_REPORT_SIZE bytes, report ID first.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Sched_HID_Submit(uint8_t * Report)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t index = 0, free = SCHED_HID_SLOTS;
+
+	__disable_irq();
+
+	for (index = 0; index < SCHED_HID_SLOTS; index++) {
+		if (HID_Slot[index].Pending) {
+			if (HID_Slot[index].Report[0] == Report[0]) {
+				break;
+			}
+		} else if (free == SCHED_HID_SLOTS) {
+			free = index;
+		}
+	}
+
+	if (index == SCHED_HID_SLOTS) {
+		index = free;
+		if (index == SCHED_HID_SLOTS) {
+			/* no room left: the event is lost, count it as missed */
+			Sched_Stats[SCHED_FUNC_HID].DeadlineMiss++;
+			__set_PRIMASK(primask);
+			return;
+		}
+		HID_Slot[index].Stamp = Sched_FrameCount;
+		HID_Slot[index].Pending = 1;
+	}
+
+	for (free = 0; free < SCHED_HID_REPORT_SIZE; free++) {
+		HID_Slot[index].Report[free] = Report[free];
+	}
+
+	Sched_HID_Service();
+
+	__set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+* Function Name  : Sched_HID_InComplete
+* Description    : EP1 IN completion: account the report latency and load
+*                  the next pending report.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Sched_HID_InComplete(void)
+{
+	PrevXferComplete = 1;
+
+	Sched_Account(SCHED_FUNC_HID, HID_InFlightStamp, SCHED_HID_DEADLINE);
+	Sched_HID_Service();
+}
+
+/*******************************************************************************
+* Function Name  : Sched_MSC_In
+* Description    : EP2 IN completion of the Mass Storage function.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Sched_MSC_In(void)
+{
+	Sched_MSC_Event(SCHED_MSC_IN);
+}
+
+/*******************************************************************************
+* Function Name  : Sched_MSC_Out
+* Description    : EP2 OUT reception of the Mass Storage function.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Sched_MSC_Out(void)
+{
+	Sched_MSC_Event(SCHED_MSC_OUT);
+}
+
+/*******************************************************************************
+* Function Name  : Sched_HID_Service
+* Description    : Load the oldest pending report in EP1 when it is free.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Sched_HID_Service(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t index = 0, oldest = SCHED_HID_SLOTS;
+
+	__disable_irq();
+
+	if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
+		for (index = 0; index < SCHED_HID_SLOTS; index++) {
+			if ((HID_Slot[index].Pending)
+			    && ((oldest == SCHED_HID_SLOTS)
+				|| ((int32_t)
+				    (HID_Slot[index].Stamp -
+				     HID_Slot[oldest].Stamp) < 0))) {
+				oldest = index;
+			}
+		}
+
+		if (oldest != SCHED_HID_SLOTS) {
+			/* Write the descriptor through the endpoint */
+			USB_SIL_Write(EP1_IN, HID_Slot[oldest].Report,
+				      SCHED_HID_REPORT_SIZE);
+			SetEPTxValid(ENDP1);
+			PrevXferComplete = 0;
+
+			HID_InFlightStamp = HID_Slot[oldest].Stamp;
+			HID_Slot[oldest].Pending = 0;
+			Sched_Stats[SCHED_FUNC_HID].Serviced++;
+		}
+	}
+
+	__set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+* Function Name  : Sched_HID_Busy
+* Description    : Whether HID has a report pending or in flight, the only
+*                  case the Mass Storage budget applies.
+* Input          : None.
+* Output         : None.
+* Return         : 1 if HID has traffic, 0 otherwise.
+*******************************************************************************/
+static uint8_t Sched_HID_Busy(void)
+{
+	uint32_t index = 0;
+
+	if (PrevXferComplete == 0) {
+		return 1;
+	}
+	for (index = 0; index < SCHED_HID_SLOTS; index++) {
+		if (HID_Slot[index].Pending) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*******************************************************************************
+* Function Name  : Sched_MSC_Event
+* Description    : Run a Mass Storage event now if nothing older is waiting
+*                  and either HID is idle or the frame budget allows it,
+*                  defer it otherwise.
+* Input          : Event: SCHED_MSC_IN or SCHED_MSC_OUT.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Sched_MSC_Event(uint8_t Event)
+{
+	/* Reload the interrupt endpoint before any long storage access */
+	Sched_HID_Service();
+
+	if ((MSC_DeferredCount == 0)
+	    && ((MSC_Budget != 0) || (Sched_HID_Busy() == 0))) {
+		Sched_MSC_Run(Event);
+		return;
+	}
+
+	/* The endpoint stays NAKed until the event is replayed */
+	if (MSC_DeferredCount == 0) {
+		MSC_DeferStamp = Sched_FrameCount;
+	}
+	MSC_Deferred[MSC_DeferredCount++] = Event;
+	Sched_Stats[SCHED_FUNC_MSC].Deferred++;
+}
+
+/*******************************************************************************
+* Function Name  : Sched_MSC_Run
+* Description    : Hand one event to the BOT layer.
+* Input          : Event: SCHED_MSC_IN or SCHED_MSC_OUT.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Sched_MSC_Run(uint8_t Event)
+{
+	if (MSC_Budget != 0) {
+		MSC_Budget--;
+	}
+	Sched_Stats[SCHED_FUNC_MSC].Serviced++;
+
+	if (Event == SCHED_MSC_IN) {
+		Mass_Storage_In();
+	} else {
+		Mass_Storage_Out();
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Sched_Account
+* Description    : Update the latency statistics of a function.
+* Input          : Func: function served.
+*                  Stamp: frame the transaction became pending.
+*                  Deadline: allowed latency in frames.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Sched_Account(SCHED_FUNC Func, uint32_t Stamp, uint32_t Deadline)
+{
+	uint32_t latency = Sched_FrameCount - Stamp;
+
+	if (latency > Sched_Stats[Func].MaxLatency) {
+		Sched_Stats[Func].MaxLatency = latency;
+	}
+	if (latency > Deadline) {
+		Sched_Stats[Func].DeadlineMiss++;
+	}
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
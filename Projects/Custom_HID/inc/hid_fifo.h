@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    hid_fifo.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for hid_fifo.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HID_FIFO_H
+#define __HID_FIFO_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_desc.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct _HID_FIFO_STATS {
+	uint32_t Queued;	/* reports accepted */
+	uint32_t Sent;		/* reports loaded in EP1 */
+	uint32_t Coalesced;	/* latest-wins reports merged in a queued one */
+	uint32_t Evicted;	/* latest-wins reports dropped for a never-drop one */
+	uint32_t Lost;		/* reports refused, FIFO full of never-drop ones */
+	uint32_t MaxDepth;	/* highest FIFO occupancy seen */
+} HID_FIFO_STATS;
+
+/* Exported constants --------------------------------------------------------*/
+#define HID_FIFO_REPORT_SIZE       2	/* report ID and value */
+#define HID_FIFO_DEPTH             16	/* queued IN reports (power of 2) */
+
+#if (CUSTOMHID_BUTTON_REPORT_LEN != HID_FIFO_REPORT_SIZE) \
+    || (CUSTOMHID_ADC_REPORT_LEN != HID_FIFO_REPORT_SIZE)
+#error "The FIFO holds the button and ADC reports as a report ID and a value"
+#endif
+
+/* Buttons are never dropped, a queued ADC report takes the newest value */
+#define HID_FIFO_LATEST_WINS(Id)   ((Id) == HID_REPORT_ADC)
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported variables --------------------------------------------------------*/
+extern __IO HID_FIFO_STATS HID_Fifo_Stats;
+
+/* Exported functions ------------------------------------------------------- */
+void HID_Fifo_Init(void);
+void HID_Fifo_Push(uint8_t Id, uint8_t Value);
+void HID_Fifo_Service(void);
+
+#endif /* __HID_FIFO_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
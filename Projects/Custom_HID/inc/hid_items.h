@@ -0,0 +1,102 @@
+/**
+  ******************************************************************************
+  * @file    hid_items.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   HID short items (HID 1.11, 6.2.2) to write report descriptors
+  *          as tables from which the byte array and its size are both
+  *          expanded at compile time.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HID_ITEMS_H
+#define __HID_ITEMS_H
+
+/* Includes ------------------------------------------------------------------*/
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* Main item data */
+#define HID_DATA_VAR_ABS           0x02
+#define HID_CNST_VAR_ABS           0x03
+#define HID_VOLATILE               0x80
+
+/* Collection types */
+#define HID_PHYSICAL               0x00
+#define HID_APPLICATION            0x01
+
+/* Exported macro ------------------------------------------------------------*/
+/* Short items: prefix (tag, type and data size) followed by the data bytes */
+#define HID_ITEM_0(Prefix)         (Prefix)
+#define HID_ITEM_1(Prefix, Data)   ((Prefix) | 0x01), (uint8_t)(Data)
+#define HID_ITEM_2(Prefix, Data)   ((Prefix) | 0x02), (uint8_t)(Data), \
+                                   (uint8_t)((Data) >> 8)
+
+/* Each item of a table is written I(NAME, Data), NAME being one of the
+   items below. HID_NAME(Data) gives its bytes and HID_NAME_SIZ their count */
+#define HID_INPUT(Data)            HID_ITEM_1(0x80, Data)
+#define HID_INPUT_SIZ              2
+#define HID_OUTPUT(Data)           HID_ITEM_1(0x90, Data)
+#define HID_OUTPUT_SIZ             2
+#define HID_FEATURE(Data)          HID_ITEM_1(0xB0, Data)
+#define HID_FEATURE_SIZ            2
+#define HID_COLLECTION(Data)       HID_ITEM_1(0xA0, Data)
+#define HID_COLLECTION_SIZ         2
+#define HID_END_COLLECTION(Data)   HID_ITEM_0(0xC0)
+#define HID_END_COLLECTION_SIZ     1
+
+#define HID_USAGE_PAGE(Data)       HID_ITEM_1(0x04, Data)
+#define HID_USAGE_PAGE_SIZ         2
+#define HID_USAGE_PAGE16(Data)     HID_ITEM_2(0x04, Data)
+#define HID_USAGE_PAGE16_SIZ       3
+#define HID_LOGICAL_MINIMUM(Data)  HID_ITEM_1(0x14, Data)
+#define HID_LOGICAL_MINIMUM_SIZ    2
+#define HID_LOGICAL_MAXIMUM(Data)  HID_ITEM_1(0x24, Data)
+#define HID_LOGICAL_MAXIMUM_SIZ    2
+/* Maxima of 128 and above need 2 bytes, the data is signed */
+#define HID_LOGICAL_MAXIMUM16(Data) HID_ITEM_2(0x24, Data)
+#define HID_LOGICAL_MAXIMUM16_SIZ  3
+#define HID_REPORT_SIZE(Data)      HID_ITEM_1(0x74, Data)
+#define HID_REPORT_SIZE_SIZ        2
+#define HID_REPORT_ID(Data)        HID_ITEM_1(0x84, Data)
+#define HID_REPORT_ID_SIZ          2
+#define HID_REPORT_COUNT(Data)     HID_ITEM_1(0x94, Data)
+#define HID_REPORT_COUNT_SIZ       2
+
+#define HID_USAGE(Data)            HID_ITEM_1(0x08, Data)
+#define HID_USAGE_SIZ              2
+
+/* Expanders for a table Table(I):
+   const uint8_t Desc[HID_DESC_SIZE(Table)] = { HID_DESC_BYTES(Table) }; */
+#define HID_ITEM_BYTES(Name, Data) HID_##Name(Data),
+#define HID_ITEM_SIZE(Name, Data)  + HID_##Name##_SIZ
+#define HID_DESC_BYTES(Table)      Table(HID_ITEM_BYTES)
+#define HID_DESC_SIZE(Table)       (0 Table(HID_ITEM_SIZE))
+
+/* Length in bytes of a report of Bits data bits, report ID included */
+#define HID_REPORT_LENGTH(Bits)    (1 + (((Bits) + 7) / 8))
+#define HID_MAX(a, b)              (((a) > (b)) ? (a) : (b))
+
+/* Exported functions ------------------------------------------------------- */
+
+#endif /* __HID_ITEMS_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
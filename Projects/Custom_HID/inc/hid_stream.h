@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    hid_stream.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for hid_stream.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HID_STREAM_H
+#define __HID_STREAM_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_desc.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct _HID_STREAM_STATS {
+	uint32_t Blocks;	/* sample blocks filled by the DMA */
+	uint32_t Sent;		/* stream reports loaded in EP1 */
+	uint32_t Lost;		/* blocks overwritten before EP1 was free */
+} HID_STREAM_STATS;
+
+/* Exported constants --------------------------------------------------------*/
+/* Stream report: ID, sequence number, blocks lost since the previous report,
+   HID_STREAM_SAMPLES 12-bit samples packed two in three bytes, one pad byte */
+#define HID_STREAM_REPORT_SIZE     CUSTOMHID_STREAM_REPORT_LEN
+#define HID_STREAM_SAMPLES         40	/* per report, even */
+
+#if (3 + (HID_STREAM_SAMPLES * 3) / 2) > HID_STREAM_REPORT_SIZE
+#error "HID_STREAM_SAMPLES do not fit in the stream report"
+#endif
+
+/* ADC trigger rate in samples per second. Kept a few percent under
+   HID_STREAM_SAMPLES per ms so that EP1 has spare frames for the buttons */
+#define HID_STREAM_RATE            38400
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported variables --------------------------------------------------------*/
+extern uint16_t HID_Stream_Buffer[2 * HID_STREAM_SAMPLES];
+extern __IO HID_STREAM_STATS HID_Stream_Stats;
+
+/* Exported functions ------------------------------------------------------- */
+void HID_Stream_Init(void);
+void HID_Stream_Block(uint8_t Half);
+void HID_Stream_Service(void);
+
+#endif /* __HID_STREAM_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -37,6 +37,10 @@
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /* Exported define -----------------------------------------------------------*/
+/* Uncomment to stream the ADC as packed 12-bit sample blocks (hid_stream.c)
+   instead of reporting its 8-bit value when it changes */
+/* #define CUSTOMHID_ADC_STREAM */
+
 /* Exported functions ------------------------------------------------------- */
 void Set_System(void);
 void Set_USBClock(void);
@@ -48,6 +52,7 @@ void GPIO_Configuration(void);
 void EXTI_Configuration(void);
 void ADC_Configuration(void);
 void ADC30x_Configuration(void);
+void ADC_Stream_Cmd(FunctionalState NewState);
 void Get_SerialNum(void);
 void TimingDelay_Decrement(void);
 void Delay(__IO uint32_t nCount);
@@ -54,9 +54,9 @@
 #define ENDP0_TXADDR        (0x80)
 
 /* EP1  */
-/* tx buffer base address */
+/* tx buffer base address, 64 bytes for the ADC stream reports */
 #define ENDP1_TXADDR        (0x100)
-#define ENDP1_RXADDR        (0x104)
+#define ENDP1_RXADDR        (0x140)
 
 /*-------------------------------------------------------------*/
 /* -------------------   ISTR events  -------------------------*/
@@ -30,9 +30,96 @@
 #define __USB_DESC_H
 
 /* Includes ------------------------------------------------------------------*/
+#include "hw_config.h"
+#include "hid_items.h"
+
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
+/* Report IDs */
+#define HID_REPORT_LED1            0x01
+#define HID_REPORT_LED2            0x02
+#define HID_REPORT_LED3            0x03
+#define HID_REPORT_LED4            0x04
+#define HID_REPORT_KEY             0x05
+#define HID_REPORT_TAMPER          0x06
+#define HID_REPORT_ADC             0x07
+#define HID_REPORT_STREAM          0x08
+
+/* Report fields in bits, the report ID byte aside */
+#define CUSTOMHID_LED_BITS         8
+#define CUSTOMHID_BUTTON_BITS      1
+#define CUSTOMHID_BUTTON_PAD       7
+#define CUSTOMHID_ADC_BITS         8
+#define CUSTOMHID_STREAM_BYTES     63
+
 /* Exported macro ------------------------------------------------------------*/
+/* Report descriptor tables, see hid_items.h */
+#define CUSTOMHID_LED_ITEMS(I, Id) \
+	I(REPORT_ID, Id) \
+	I(USAGE, Id)				/* LED n */ \
+	I(LOGICAL_MINIMUM, 0) \
+	I(LOGICAL_MAXIMUM, 1) \
+	I(REPORT_SIZE, CUSTOMHID_LED_BITS) \
+	I(REPORT_COUNT, 1) \
+	I(FEATURE, HID_DATA_VAR_ABS | HID_VOLATILE) \
+	I(REPORT_ID, Id) \
+	I(USAGE, Id) \
+	I(OUTPUT, HID_DATA_VAR_ABS | HID_VOLATILE)
+
+#define CUSTOMHID_BUTTON_ITEMS(I, Id) \
+	I(REPORT_ID, Id) \
+	I(USAGE, Id)				/* Push Button */ \
+	I(LOGICAL_MINIMUM, 0) \
+	I(LOGICAL_MAXIMUM, 1) \
+	I(REPORT_SIZE, CUSTOMHID_BUTTON_BITS) \
+	I(INPUT, HID_DATA_VAR_ABS | HID_VOLATILE) \
+	I(USAGE, Id) \
+	I(REPORT_SIZE, CUSTOMHID_BUTTON_BITS) \
+	I(FEATURE, HID_DATA_VAR_ABS | HID_VOLATILE) \
+	I(REPORT_SIZE, CUSTOMHID_BUTTON_PAD) \
+	I(INPUT, HID_CNST_VAR_ABS | HID_VOLATILE) \
+	I(REPORT_ID, Id) \
+	I(REPORT_SIZE, CUSTOMHID_BUTTON_PAD) \
+	I(FEATURE, HID_CNST_VAR_ABS | HID_VOLATILE)
+
+#define CUSTOMHID_ADC_ITEMS(I) \
+	I(REPORT_ID, HID_REPORT_ADC) \
+	I(USAGE, HID_REPORT_ADC)		/* ADC IN */ \
+	I(LOGICAL_MINIMUM, 0) \
+	I(LOGICAL_MAXIMUM16, 255) \
+	I(REPORT_SIZE, CUSTOMHID_ADC_BITS) \
+	I(INPUT, HID_DATA_VAR_ABS | HID_VOLATILE) \
+	I(REPORT_ID, HID_REPORT_ADC) \
+	I(USAGE, HID_REPORT_ADC) \
+	I(FEATURE, HID_DATA_VAR_ABS | HID_VOLATILE)
+
+#if defined (CUSTOMHID_ADC_STREAM)
+#define CUSTOMHID_STREAM_ITEMS(I) \
+	I(REPORT_ID, HID_REPORT_STREAM) \
+	I(USAGE, HID_REPORT_STREAM)		/* ADC stream */ \
+	I(LOGICAL_MINIMUM, 0) \
+	I(LOGICAL_MAXIMUM16, 255) \
+	I(REPORT_SIZE, 8) \
+	I(REPORT_COUNT, CUSTOMHID_STREAM_BYTES) \
+	I(INPUT, HID_DATA_VAR_ABS)
+#else
+#define CUSTOMHID_STREAM_ITEMS(I)
+#endif
+
+#define CUSTOMHID_REPORT_ITEMS(I) \
+	I(USAGE_PAGE16, 0x00FF)			/* bytes FF 00, unchanged */ \
+	I(USAGE, 0x01)				/* Demo Kit */ \
+	I(COLLECTION, HID_APPLICATION) \
+	CUSTOMHID_LED_ITEMS(I, HID_REPORT_LED1) \
+	CUSTOMHID_LED_ITEMS(I, HID_REPORT_LED2) \
+	CUSTOMHID_LED_ITEMS(I, HID_REPORT_LED3) \
+	CUSTOMHID_LED_ITEMS(I, HID_REPORT_LED4) \
+	CUSTOMHID_BUTTON_ITEMS(I, HID_REPORT_KEY) \
+	CUSTOMHID_BUTTON_ITEMS(I, HID_REPORT_TAMPER) \
+	CUSTOMHID_ADC_ITEMS(I) \
+	CUSTOMHID_STREAM_ITEMS(I) \
+	I(END_COLLECTION, 0)
+
 /* Exported define -----------------------------------------------------------*/
 #define USB_DEVICE_DESCRIPTOR_TYPE              0x01
 #define USB_CONFIGURATION_DESCRIPTOR_TYPE       0x02
@@ -46,7 +133,7 @@
 
 #define CUSTOMHID_SIZ_DEVICE_DESC               18
 #define CUSTOMHID_SIZ_CONFIG_DESC               41
-#define CUSTOMHID_SIZ_REPORT_DESC               163
+#define CUSTOMHID_SIZ_REPORT_DESC               HID_DESC_SIZE(CUSTOMHID_REPORT_ITEMS)
 #define CUSTOMHID_SIZ_STRING_LANGID             4
 #define CUSTOMHID_SIZ_STRING_VENDOR             38
 #define CUSTOMHID_SIZ_STRING_PRODUCT            32
@@ -54,6 +141,29 @@
 
 #define STANDARD_ENDPOINT_DESC_SIZE             0x09
 
+/* Report lengths, report ID included */
+#define CUSTOMHID_LED_REPORT_LEN    HID_REPORT_LENGTH(CUSTOMHID_LED_BITS)
+#define CUSTOMHID_BUTTON_REPORT_LEN HID_REPORT_LENGTH(CUSTOMHID_BUTTON_BITS + \
+						      CUSTOMHID_BUTTON_PAD)
+#define CUSTOMHID_ADC_REPORT_LEN    HID_REPORT_LENGTH(CUSTOMHID_ADC_BITS)
+#define CUSTOMHID_STREAM_REPORT_LEN HID_REPORT_LENGTH(8 * CUSTOMHID_STREAM_BYTES)
+
+/* Longest reports per direction: EP1 packet sizes and the SET_REPORT buffer */
+#define CUSTOMHID_OUT_REPORT_MAX    CUSTOMHID_LED_REPORT_LEN
+#define CUSTOMHID_FEATURE_REPORT_MAX \
+	HID_MAX(CUSTOMHID_LED_REPORT_LEN, \
+		HID_MAX(CUSTOMHID_BUTTON_REPORT_LEN, CUSTOMHID_ADC_REPORT_LEN))
+#if defined (CUSTOMHID_ADC_STREAM)
+#define CUSTOMHID_IN_REPORT_MAX     CUSTOMHID_STREAM_REPORT_LEN
+#else
+#define CUSTOMHID_IN_REPORT_MAX \
+	HID_MAX(CUSTOMHID_BUTTON_REPORT_LEN, CUSTOMHID_ADC_REPORT_LEN)
+#endif
+
+#if (CUSTOMHID_IN_REPORT_MAX > 64) || (CUSTOMHID_OUT_REPORT_MAX > 64)
+#error "Custom HID reports must fit in a 64-byte full speed packet"
+#endif
+
 /* Exported functions ------------------------------------------------------- */
 extern const uint8_t CustomHID_DeviceDescriptor[CUSTOMHID_SIZ_DEVICE_DESC];
 extern const uint8_t CustomHID_ConfigDescriptor[CUSTOMHID_SIZ_CONFIG_DESC];
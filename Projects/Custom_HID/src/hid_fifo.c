@@ -0,0 +1,184 @@
+/**
+  ******************************************************************************
+  * @file    hid_fifo.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Bounded FIFO of the IN reports: events raised while EP1 is busy
+  *          are queued and sent one per polling interval, with coalescing
+  *          rules per report ID.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "usb_pwr.h"
+#include "hid_fifo.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define HID_FIFO_MASK              (HID_FIFO_DEPTH - 1)
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+__IO HID_FIFO_STATS HID_Fifo_Stats;
+
+static uint8_t HID_Fifo[HID_FIFO_DEPTH][HID_FIFO_REPORT_SIZE];
+static uint32_t HID_Fifo_in = 0;	/* free running indexes */
+static uint32_t HID_Fifo_out = 0;
+
+/* Extern variables ----------------------------------------------------------*/
+extern __IO uint8_t PrevXferComplete;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t HID_Fifo_Find(uint8_t Id);
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : HID_Fifo_Init
+* Description    : Empty the FIFO and free EP1, called on USB reset.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void HID_Fifo_Init(void)
+{
+	HID_Fifo_in = 0;
+	HID_Fifo_out = 0;
+	PrevXferComplete = 1;
+}
+
+/*******************************************************************************
+* Function Name  : HID_Fifo_Push
+* Description    : Queue an IN report. A latest-wins report updates the one
+*                  already queued with its ID. A never-drop report arriving on
+*                  a full FIFO takes the place of a latest-wins one. Callable
+*                  from any interrupt.
+* Input          : Id: report ID.
+*                  Value: report value.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void HID_Fifo_Push(uint8_t Id, uint8_t Value)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t index = 0, next = 0;
+
+	__disable_irq();
+
+	if (HID_FIFO_LATEST_WINS(Id)) {
+		index = HID_Fifo_Find(Id);
+		if (index != HID_Fifo_in) {
+			HID_Fifo[index & HID_FIFO_MASK][1] = Value;
+			HID_Fifo_Stats.Coalesced++;
+			__set_PRIMASK(primask);
+			return;
+		}
+	}
+
+	if ((HID_Fifo_in - HID_Fifo_out) == HID_FIFO_DEPTH) {
+		/* Full: make room by dropping the oldest latest-wins report */
+		index = HID_Fifo_out;
+		while ((index != HID_Fifo_in)
+		       && !HID_FIFO_LATEST_WINS(HID_Fifo[index & HID_FIFO_MASK]
+						[0])) {
+			index++;
+		}
+
+		if (HID_FIFO_LATEST_WINS(Id) || (index == HID_Fifo_in)) {
+			HID_Fifo_Stats.Lost++;
+			__set_PRIMASK(primask);
+			return;
+		}
+
+		for (next = index + 1; next != HID_Fifo_in; next++) {
+			HID_Fifo[(next - 1) & HID_FIFO_MASK][0] =
+			    HID_Fifo[next & HID_FIFO_MASK][0];
+			HID_Fifo[(next - 1) & HID_FIFO_MASK][1] =
+			    HID_Fifo[next & HID_FIFO_MASK][1];
+		}
+		HID_Fifo_in--;
+		HID_Fifo_Stats.Evicted++;
+	}
+
+	HID_Fifo[HID_Fifo_in & HID_FIFO_MASK][0] = Id;
+	HID_Fifo[HID_Fifo_in & HID_FIFO_MASK][1] = Value;
+	HID_Fifo_in++;
+	HID_Fifo_Stats.Queued++;
+
+	if ((HID_Fifo_in - HID_Fifo_out) > HID_Fifo_Stats.MaxDepth) {
+		HID_Fifo_Stats.MaxDepth = HID_Fifo_in - HID_Fifo_out;
+	}
+
+	HID_Fifo_Service();
+
+	__set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+* Function Name  : HID_Fifo_Service
+* Description    : Load the oldest queued report in EP1 when it is free.
+*                  Called on each push and on EP1 IN completion.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void HID_Fifo_Service(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	if ((PrevXferComplete) && (bDeviceState == CONFIGURED)
+	    && (HID_Fifo_out != HID_Fifo_in)) {
+		/* Write the descriptor through the endpoint */
+		USB_SIL_Write(EP1_IN, HID_Fifo[HID_Fifo_out & HID_FIFO_MASK],
+			      HID_FIFO_REPORT_SIZE);
+		SetEPTxValid(ENDP1);
+		PrevXferComplete = 0;
+
+		HID_Fifo_out++;
+		HID_Fifo_Stats.Sent++;
+	}
+
+	__set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+* Function Name  : HID_Fifo_Find
+* Description    : Look for a queued report.
+* Input          : Id: report ID.
+* Output         : None.
+* Return         : Its index, HID_Fifo_in when none is queued.
+*******************************************************************************/
+static uint32_t HID_Fifo_Find(uint8_t Id)
+{
+	uint32_t index = HID_Fifo_out;
+
+	while ((index != HID_Fifo_in)
+	       && (HID_Fifo[index & HID_FIFO_MASK][0] != Id)) {
+		index++;
+	}
+
+	return index;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
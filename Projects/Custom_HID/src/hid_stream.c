@@ -0,0 +1,163 @@
+/**
+  ******************************************************************************
+  * @file    hid_stream.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   ADC streaming: the DMA fills a double buffer of samples paced
+  *          by TIM3 and each half is sent as a packed 12-bit report on EP1.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "usb_pwr.h"
+#include "hid_stream.h"
+
+#if defined (CUSTOMHID_ADC_STREAM)
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define HID_STREAM_NONE            0xFF
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+__IO HID_STREAM_STATS HID_Stream_Stats;
+
+/* DMA target, HT marks the first half full and TC the second one */
+uint16_t HID_Stream_Buffer[2 * HID_STREAM_SAMPLES];
+
+static uint8_t HID_Stream_Report[HID_STREAM_REPORT_SIZE];
+static uint8_t HID_Stream_Ready = HID_STREAM_NONE;	/* half waiting for EP1 */
+static uint8_t HID_Stream_ReadySeq = 0;
+static uint8_t HID_Stream_Seq = 0;
+static uint32_t HID_Stream_Dropped = 0;	/* since the last report sent */
+
+/* Extern variables ----------------------------------------------------------*/
+extern __IO uint8_t PrevXferComplete;
+
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : HID_Stream_Init
+* Description    : Forget the pending block and restart the sequence, called
+*                  on USB reset.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void HID_Stream_Init(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	HID_Stream_Ready = HID_STREAM_NONE;
+	HID_Stream_Seq = 0;
+	HID_Stream_Dropped = 0;
+
+	__set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+* Function Name  : HID_Stream_Block
+* Description    : A half of the sample buffer has been filled, called from
+*                  the DMA interrupt. From now on the DMA writes the other
+*                  half, so a block still waiting there is lost.
+* Input          : Half: 0 for the first half, 1 for the second one.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void HID_Stream_Block(uint8_t Half)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+
+	HID_Stream_Stats.Blocks++;
+
+	if (HID_Stream_Ready != HID_STREAM_NONE) {
+		HID_Stream_Stats.Lost++;
+		HID_Stream_Dropped++;
+	}
+
+	HID_Stream_Ready = Half;
+	HID_Stream_ReadySeq = HID_Stream_Seq++;
+
+	HID_Stream_Service();
+
+	__set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+* Function Name  : HID_Stream_Service
+* Description    : Pack the pending block and load it in EP1 when it is free.
+*                  Called on each block and on EP1 IN completion, after the
+*                  button FIFO has had its turn.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void HID_Stream_Service(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint16_t *sample;
+	uint8_t *report;
+	uint32_t i;
+
+	__disable_irq();
+
+	if ((PrevXferComplete) && (bDeviceState == CONFIGURED)
+	    && (HID_Stream_Ready != HID_STREAM_NONE)) {
+		sample = &HID_Stream_Buffer[HID_Stream_Ready *
+					    HID_STREAM_SAMPLES];
+		report = HID_Stream_Report;
+
+		*report++ = HID_REPORT_STREAM;
+		*report++ = HID_Stream_ReadySeq;
+		*report++ = (HID_Stream_Dropped > 0xFF) ? 0xFF :
+		    (uint8_t) HID_Stream_Dropped;
+
+		/* Two right aligned 12-bit samples in three bytes */
+		for (i = 0; i < HID_STREAM_SAMPLES; i += 2) {
+			*report++ = (uint8_t) sample[i];
+			*report++ = (uint8_t) (((sample[i] >> 8) & 0x0F) |
+					       (sample[i + 1] << 4));
+			*report++ = (uint8_t) (sample[i + 1] >> 4);
+		}
+		/* the padding after the samples is never written, left at 0 */
+
+		USB_SIL_Write(EP1_IN, HID_Stream_Report,
+			      HID_STREAM_REPORT_SIZE);
+		SetEPTxValid(ENDP1);
+		PrevXferComplete = 0;
+
+		HID_Stream_Ready = HID_STREAM_NONE;
+		HID_Stream_Dropped = 0;
+		HID_Stream_Stats.Sent++;
+	}
+
+	__set_PRIMASK(primask);
+}
+
+#endif /* CUSTOMHID_ADC_STREAM */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
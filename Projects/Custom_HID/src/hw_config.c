@@ -30,9 +30,16 @@
 #include "usb_lib.h"
 #include "usb_desc.h"
 #include "usb_pwr.h"
+#include "hid_stream.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#if defined (CUSTOMHID_ADC_STREAM)
+/* STM32L1xx: 48 + 12 cycles of the 16 MHz HSI fit in the trigger period */
+#define ADC_SAMPLE_TIME            ADC_SampleTime_48Cycles
+#else
+#define ADC_SAMPLE_TIME            ADC_SampleTime_384Cycles
+#endif
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 
@@ -45,6 +52,9 @@ __IO uint16_t ADC1ConvertedValue = 0, ADC1ConvertedVoltage =
 /* Extern variables ----------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
 static void IntToUnicode(uint32_t value, uint8_t * pbuf, uint8_t len);
+#if defined (CUSTOMHID_ADC_STREAM)
+static void ADC_Stream_Timer_Config(void);
+#endif
 /* Private functions ---------------------------------------------------------*/
 
 /*******************************************************************************
@@ -301,9 +311,17 @@ void USB_Interrupts_Config(void)
 	   NVIC_Init(&NVIC_InitStructure); */
 
 	/* Enable the DMA1 Channel1 Interrupt */
+#if defined (CUSTOMHID_ADC_STREAM)
+	NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel1_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+#else
 	/*NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel1_IRQn;
 	   NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
 	   NVIC_Init(&NVIC_InitStructure); */
+#endif
 }
 
 /*******************************************************************************
@@ -444,11 +462,17 @@ void ADC_Configuration(void)
 	/* DMA1 channel1 configuration --------------------------------------------- */
 	DMA_DeInit(DMA1_Channel1);
 	DMA_InitStructure.DMA_PeripheralBaseAddr = ADC1_DR_Address;
+#if defined (CUSTOMHID_ADC_STREAM)
+	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) HID_Stream_Buffer;
+	DMA_InitStructure.DMA_BufferSize = 2 * HID_STREAM_SAMPLES;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+#else
 	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) & ADC_ConvertedValueX;
-	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
 	DMA_InitStructure.DMA_BufferSize = 1;
-	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
 	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Disable;
+#endif
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
 	DMA_InitStructure.DMA_PeripheralDataSize =
 	    DMA_PeripheralDataSize_HalfWord;
 	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
@@ -460,8 +484,17 @@ void ADC_Configuration(void)
 	/* Enable DMA1 channel1 */
 	DMA_Cmd(DMA1_Channel1, ENABLE);
 
+#if defined (CUSTOMHID_ADC_STREAM)
+	/* Enable the DMA1 Channel1 Half transfer and Transfer complete
+	   interrupts: one per filled half of the sample buffer */
+	DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+	/* Conversions are paced by TIM3 */
+	ADC_Stream_Timer_Config();
+#else
 	/* Enable the DMA1 Channel1 Transfer complete interrupt */
 	DMA_ITConfig(DMA1_Channel1, DMA_IT_TC, ENABLE);
+#endif
 
 #if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
 	/* Enable the HSI for the ADC operations */
@@ -470,20 +503,25 @@ void ADC_Configuration(void)
 	/* ADC1 configuration ------------------------------------------------------ */
 	ADC_StructInit(&ADC_InitStructure);
 	ADC_InitStructure.ADC_ScanConvMode = ENABLE;
+#if defined (CUSTOMHID_ADC_STREAM)
+	ADC_InitStructure.ADC_ContinuousConvMode = DISABLE;
+	ADC_InitStructure.ADC_ExternalTrigConvEdge =
+	    ADC_ExternalTrigConvEdge_Rising;
+	ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_T3_TRGO;
+#else
 	ADC_InitStructure.ADC_ContinuousConvMode = ENABLE;
+#endif
 	ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
 	ADC_InitStructure.ADC_NbrOfConversion = 1;
 	ADC_Init(ADC1, &ADC_InitStructure);
 
 #if defined (USE_STM32L152D_EVAL)
 	/* ADC1 regular channel31 configuration */
-	ADC_RegularChannelConfig(ADC1, ADC_Channel_31, 1,
-				 ADC_SampleTime_384Cycles);
+	ADC_RegularChannelConfig(ADC1, ADC_Channel_31, 1, ADC_SAMPLE_TIME);
 
 #else
 	/* ADC1 regular channel18 configuration */
-	ADC_RegularChannelConfig(ADC1, ADC_Channel_18, 1,
-				 ADC_SampleTime_384Cycles);
+	ADC_RegularChannelConfig(ADC1, ADC_Channel_18, 1, ADC_SAMPLE_TIME);
 #endif
 
 #if !defined (USE_STM32373C_EVAL)
@@ -503,12 +541,22 @@ void ADC_Configuration(void)
 #endif
 
 	ADC_InitStructure.ADC_ScanConvMode = ENABLE;
+#if defined (CUSTOMHID_ADC_STREAM)
+	ADC_InitStructure.ADC_ContinuousConvMode = DISABLE;
+	ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_T3_TRGO;
+#else
 	ADC_InitStructure.ADC_ContinuousConvMode = ENABLE;
 	ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_None;
+#endif
 	ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
 	ADC_InitStructure.ADC_NbrOfChannel = 1;
 	ADC_Init(ADC1, &ADC_InitStructure);
 
+#if defined (CUSTOMHID_ADC_STREAM)
+	/* Start a conversion on each TIM3 TRGO */
+	ADC_ExternalTrigConvCmd(ADC1, ENABLE);
+#endif
+
 	/* ADC1 regular channel configuration */
 	ADC_RegularChannelConfig(ADC1, ADC_AIN_CHANNEL, 1,
 				 ADC_SampleTime_55Cycles5);
@@ -599,23 +647,42 @@ void ADC30x_Configuration(void)
 	/* DMA1 channel1 configuration --------------------------------------------- */
 	DMA_DeInit(DMA1_Channel1);
 	DMA_InitStructure.DMA_PeripheralBaseAddr = ADC1_DR_Address;
+#if defined (CUSTOMHID_ADC_STREAM)
+	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) HID_Stream_Buffer;
+	DMA_InitStructure.DMA_BufferSize = 2 * HID_STREAM_SAMPLES;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize =
+	    DMA_PeripheralDataSize_HalfWord;
+	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+#else
 	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) & ADC_ConvertedValueX;
-	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
 	DMA_InitStructure.DMA_BufferSize = 1;
-	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
 	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Disable;
 	DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
 	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
-	DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
 	DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+#endif
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
 	DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
 	DMA_Init(DMA1_Channel1, &DMA_InitStructure);
 
 	/* Enable DMA1 channel1 */
 	DMA_Cmd(DMA1_Channel1, ENABLE);
 
+#if defined (CUSTOMHID_ADC_STREAM)
+	/* Enable the DMA1 Channel1 Half transfer and Transfer complete
+	   interrupts: one per filled half of the sample buffer */
+	DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+	/* Conversions are paced by TIM3 */
+	ADC_Stream_Timer_Config();
+#else
 	/* Enable the DMA1 Channel1 Transfer complete interrupt */
 	DMA_ITConfig(DMA1_Channel1, DMA_IT_TC, ENABLE);
+#endif
 
 	/* Configure the ADC clock */
 	RCC_ADCCLKConfig(RCC_ADC12PLLCLK_Div2);
@@ -645,6 +712,16 @@ void ADC30x_Configuration(void)
 	ADC_DMACmd(ADC1, ENABLE);
 	ADC_DMAConfig(ADC1, ADC_DMAMode_Circular);
 
+#if defined (CUSTOMHID_ADC_STREAM)
+	/* Conversions on each TIM3 TRGO (event 4) */
+	ADC_InitStructure.ADC_ContinuousConvMode =
+	    ADC_ContinuousConvMode_Disable;
+	ADC_InitStructure.ADC_Resolution = ADC_Resolution_12b;
+	ADC_InitStructure.ADC_ExternalTrigConvEvent =
+	    ADC_ExternalTrigConvEvent_4;
+	ADC_InitStructure.ADC_ExternalTrigEventEdge =
+	    ADC_ExternalTrigEventEdge_RisingEdge;
+#else
 	ADC_InitStructure.ADC_ContinuousConvMode =
 	    ADC_ContinuousConvMode_Enable;
 	ADC_InitStructure.ADC_Resolution = ADC_Resolution_12b;
@@ -652,6 +729,7 @@ void ADC30x_Configuration(void)
 	    ADC_ExternalTrigConvEvent_0;
 	ADC_InitStructure.ADC_ExternalTrigEventEdge =
 	    ADC_ExternalTrigEventEdge_None;
+#endif
 	ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
 	ADC_InitStructure.ADC_OverrunMode = ADC_OverrunMode_Disable;
 	ADC_InitStructure.ADC_AutoInjMode = ADC_AutoInjec_Disable;
@@ -668,6 +746,7 @@ void ADC30x_Configuration(void)
 	/* wait for ADRDY */
 	while (!ADC_GetFlagStatus(ADC1, ADC_FLAG_RDY)) ;
 
+#if !defined (CUSTOMHID_ADC_STREAM)
 	/* Start ADC1 Software Conversion */
 	ADC_StartConversion(ADC1);
 
@@ -676,7 +755,53 @@ void ADC30x_Configuration(void)
 	/* Get ADC1 converted data */
 
 	ADC_ConvertedValueX = ADC_GetConversionValue(ADC1);
+#endif /* CUSTOMHID_ADC_STREAM */
 }
 
 #endif
+
+#if defined (CUSTOMHID_ADC_STREAM)
+/*******************************************************************************
+* Function Name : ADC_Stream_Timer_Config
+* Description   : Configure TIM3 to output a TRGO at HID_STREAM_RATE, left
+*                 stopped. Done at register level, the TIM driver is not part
+*                 of this project. TIM3 runs at SystemCoreClock on all the
+*                 supported devices (APB1 prescaler of 1 or 2).
+* Input         : None.
+* Output        : None.
+* Return value  : None.
+*******************************************************************************/
+static void ADC_Stream_Timer_Config(void)
+{
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
+
+	TIM3->CR1 = 0;
+	TIM3->PSC = 0;
+	TIM3->ARR = (SystemCoreClock / HID_STREAM_RATE) - 1;
+	/* Master mode: update event as TRGO */
+	TIM3->CR2 = TIM_CR2_MMS_1;
+	TIM3->EGR = TIM_EGR_UG;
+}
+#endif /* CUSTOMHID_ADC_STREAM */
+
+/*******************************************************************************
+* Function Name : ADC_Stream_Cmd
+* Description   : Start or stop the ADC stream trigger. Nothing to do when
+*                 the ADC runs in continuous mode.
+* Input         : NewState: ENABLE or DISABLE.
+* Output        : None.
+* Return value  : None.
+*******************************************************************************/
+void ADC_Stream_Cmd(FunctionalState NewState)
+{
+#if defined (CUSTOMHID_ADC_STREAM)
+	if (NewState != DISABLE) {
+		TIM3->CR1 |= TIM_CR1_CEN;
+	} else {
+		TIM3->CR1 &= ~TIM_CR1_CEN;
+	}
+#else
+	(void)NewState;
+#endif /* CUSTOMHID_ADC_STREAM */
+}
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -35,13 +35,13 @@
 #include "usb_pwr.h"
 #include "hw_config.h"
 #include "debug.h"
+#include "hid_fifo.h"
+#include "hid_stream.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-__IO uint8_t Send_Buffer[2];
-extern __IO uint8_t PrevXferComplete;
 extern uint32_t ADC_ConvertedValueX;
 extern uint32_t ADC_ConvertedValueX_1;
 extern __IO uint32_t TimingDelay;
@@ -214,24 +214,20 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
 *******************************************************************************/
 void EXTI15_10_IRQHandler(void)
 {
+	uint8_t value = 0;
+
 	stm_printf("EXTI15_10_IRQHandler\n");
 	/* Check on the RIGHT button */
 	if (EXTI_GetITStatus(RIGHT_BUTTON_EXTI_LINE) != RESET) {
-		if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
-			Send_Buffer[0] = 0x05;
-
+		if (bDeviceState == CONFIGURED) {
 			if (STM_EVAL_PBGetState(Button_RIGHT) == Bit_RESET) {
-				Send_Buffer[1] = 0x01;
+				value = 0x01;
 			} else {
-				Send_Buffer[1] = 0x00;
+				value = 0x00;
 			}
 
-			/* Write the descriptor through the endpoint */
-			USB_SIL_Write(EP1_IN, (uint8_t *) Send_Buffer, 2);
-
-			SetEPTxValid(ENDP1);
-
-			PrevXferComplete = 0;
+			/* Queue the report, EP1 may still be busy */
+			HID_Fifo_Push(HID_REPORT_KEY, value);
 		}
 		/* Clear the EXTI line  pending bit */
 		EXTI_ClearITPendingBit(RIGHT_BUTTON_EXTI_LINE);
@@ -239,21 +235,15 @@ void EXTI15_10_IRQHandler(void)
 
 	/* Check on the LEFT button */
 	if (EXTI_GetITStatus(LEFT_BUTTON_EXTI_LINE) != RESET) {
-		if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
-			Send_Buffer[0] = 0x06;
-
+		if (bDeviceState == CONFIGURED) {
 			if (STM_EVAL_PBGetState(Button_LEFT) == Bit_RESET) {
-				Send_Buffer[1] = 0x01;
+				value = 0x01;
 			} else {
-				Send_Buffer[1] = 0x00;
+				value = 0x00;
 			}
 
-			/* Write the descriptor through the endpoint */
-			USB_SIL_Write(EP1_IN, (uint8_t *) Send_Buffer, 2);
-
-			SetEPTxValid(ENDP1);
-
-			PrevXferComplete = 0;
+			/* Queue the report, EP1 may still be busy */
+			HID_Fifo_Push(HID_REPORT_TAMPER, value);
 		}
 		/* Clear the EXTI line  pending bit */
 		EXTI_ClearITPendingBit(LEFT_BUTTON_EXTI_LINE);
@@ -269,22 +259,30 @@ void EXTI15_10_IRQHandler(void)
 *******************************************************************************/
 void DMA1_Channel1_IRQHandler(void)
 {
-	stm_printf("DMA1_Channel1_IRQHandler\n");
-	Send_Buffer[0] = 0x07;
+#if defined (CUSTOMHID_ADC_STREAM)
+	/* One block of samples per half of the buffer */
+	if (DMA_GetITStatus(DMA1_IT_HT1) != RESET) {
+		DMA_ClearITPendingBit(DMA1_IT_HT1);
+		HID_Stream_Block(0);
+	}
 
+	if (DMA_GetITStatus(DMA1_IT_TC1) != RESET) {
+		DMA_ClearITPendingBit(DMA1_IT_TC1);
+		HID_Stream_Block(1);
+	}
+#else
+	stm_printf("DMA1_Channel1_IRQHandler\n");
 	if ((ADC_ConvertedValueX >> 4) - (ADC_ConvertedValueX_1 >> 4) > 4) {
-		if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
-			Send_Buffer[1] = (uint8_t) (ADC_ConvertedValueX >> 4);
-
-			/* Write the descriptor through the endpoint */
-			USB_SIL_Write(EP1_IN, (uint8_t *) Send_Buffer, 2);
-			SetEPTxValid(ENDP1);
+		if (bDeviceState == CONFIGURED) {
+			/* A queued ADC report just takes the newest value */
+			HID_Fifo_Push(HID_REPORT_ADC,
+				      (uint8_t) (ADC_ConvertedValueX >> 4));
 			ADC_ConvertedValueX_1 = ADC_ConvertedValueX;
-			PrevXferComplete = 0;
 		}
 	}
 
 	DMA_ClearFlag(DMA1_FLAG_TC1);
+#endif /* CUSTOMHID_ADC_STREAM */
 }
 
 /*******************************************************************************
@@ -302,25 +300,24 @@ void EXTI2_TS_IRQHandler(void)
 void EXTI9_5_IRQHandler(void)
 #endif
 {
+	uint8_t value = 0;
+
 	stm_printf("EXTI9_5_IRQHandler\n");
 	if (EXTI_GetITStatus(KEY_BUTTON_EXTI_LINE) != RESET) {
-		if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
-			Send_Buffer[0] = 0x05;
+		if (bDeviceState == CONFIGURED) {
 #if defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
 			if (!STM_EVAL_PBGetState(Button_KEY) == Bit_RESET)
 #else
 			if (STM_EVAL_PBGetState(Button_KEY) == Bit_RESET)
 #endif
 			{
-				Send_Buffer[1] = 0x01;
+				value = 0x01;
 			} else {
-				Send_Buffer[1] = 0x00;
+				value = 0x00;
 			}
 
-			/* Write the descriptor through the endpoint */
-			USB_SIL_Write(EP1_IN, (uint8_t *) Send_Buffer, 2);
-			SetEPTxValid(ENDP1);
-			PrevXferComplete = 0;
+			/* Queue the report, EP1 may still be busy */
+			HID_Fifo_Push(HID_REPORT_KEY, value);
 		}
 		/* Clear the EXTI line  pending bit */
 		EXTI_ClearITPendingBit(KEY_BUTTON_EXTI_LINE);
@@ -337,23 +334,19 @@ void EXTI9_5_IRQHandler(void)
 *******************************************************************************/
 void EXTI15_10_IRQHandler(void)
 {
+	uint8_t value = 0;
+
 	stm_printf("EXTI15_10_IRQHandler\n");
 	if (EXTI_GetITStatus(TAMPER_BUTTON_EXTI_LINE) != RESET) {
-		if ((PrevXferComplete) && (bDeviceState == CONFIGURED)) {
-			Send_Buffer[0] = 0x06;
-
+		if (bDeviceState == CONFIGURED) {
 			if (STM_EVAL_PBGetState(Button_TAMPER) == Bit_RESET) {
-				Send_Buffer[1] = 0x01;
+				value = 0x01;
 			} else {
-				Send_Buffer[1] = 0x00;
+				value = 0x00;
 			}
 
-			/* Write the descriptor through the endpoint */
-			USB_SIL_Write(EP1_IN, (uint8_t *) Send_Buffer, 2);
-
-			SetEPTxValid(ENDP1);
-
-			PrevXferComplete = 0;
+			/* Queue the report, EP1 may still be busy */
+			HID_Fifo_Push(HID_REPORT_TAMPER, value);
 		}
 		/* Clear the EXTI line 13 pending bit */
 		EXTI_ClearITPendingBit(TAMPER_BUTTON_EXTI_LINE);
@@ -30,12 +30,15 @@
 #include "hw_config.h"
 #include "usb_lib.h"
 #include "usb_istr.h"
+#include "usb_desc.h"
+#include "hid_fifo.h"
+#include "hid_stream.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-uint8_t Receive_Buffer[2];
+uint8_t Receive_Buffer[CUSTOMHID_OUT_REPORT_MAX];
 extern __IO uint8_t PrevXferComplete;
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -50,7 +53,7 @@ void EP1_OUT_Callback(void)
 {
 	BitAction Led_State;
 
-	/* Read received data (2 bytes) */
+	/* Read received data (an LED output report) */
 	USB_SIL_Read(EP1_OUT, Receive_Buffer);
 
 	if (Receive_Buffer[1] == 0) {
@@ -60,28 +63,28 @@ void EP1_OUT_Callback(void)
 	}
 
 	switch (Receive_Buffer[0]) {
-	case 1:		/* Led 1 */
+	case HID_REPORT_LED1:
 		if (Led_State != Bit_RESET) {
 			STM_EVAL_LEDOn(LED1);
 		} else {
 			STM_EVAL_LEDOff(LED1);
 		}
 		break;
-	case 2:		/* Led 2 */
+	case HID_REPORT_LED2:
 		if (Led_State != Bit_RESET) {
 			STM_EVAL_LEDOn(LED2);
 		} else {
 			STM_EVAL_LEDOff(LED2);
 		}
 		break;
-	case 3:		/* Led 3 */
+	case HID_REPORT_LED3:
 		if (Led_State != Bit_RESET) {
 			STM_EVAL_LEDOn(LED3);
 		} else {
 			STM_EVAL_LEDOff(LED3);
 		}
 		break;
-	case 4:		/* Led 4 */
+	case HID_REPORT_LED4:
 		if (Led_State != Bit_RESET) {
 			STM_EVAL_LEDOn(LED4);
 		} else {
@@ -110,6 +113,12 @@ void EP1_OUT_Callback(void)
 void EP1_IN_Callback(void)
 {
 	PrevXferComplete = 1;
+
+	/* Send the next queued report, the buttons go before the ADC stream */
+	HID_Fifo_Service();
+#if defined (CUSTOMHID_ADC_STREAM)
+	HID_Stream_Service();
+#endif
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -33,6 +33,8 @@
 #include "usb_prop.h"
 #include "usb_desc.h"
 #include "usb_pwr.h"
+#include "hid_fifo.h"
+#include "hid_stream.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -41,7 +43,7 @@
 uint32_t ProtocolValue;
 __IO uint8_t EXTI_Enable;
 __IO uint8_t Request = 0;
-uint8_t Report_Buf[2];
+uint8_t Report_Buf[CUSTOMHID_FEATURE_REPORT_MAX];
 /* -------------------------------------------------------------------------- */
 /*  Structures initializations */
 /* -------------------------------------------------------------------------- */
@@ -171,11 +173,17 @@ void CustomHID_Reset(void)
 	SetEPType(ENDP1, EP_INTERRUPT);
 	SetEPTxAddr(ENDP1, ENDP1_TXADDR);
 	SetEPRxAddr(ENDP1, ENDP1_RXADDR);
-	SetEPTxCount(ENDP1, 2);
-	SetEPRxCount(ENDP1, 2);
+	SetEPTxCount(ENDP1, CUSTOMHID_IN_REPORT_MAX);
+	SetEPRxCount(ENDP1, CUSTOMHID_OUT_REPORT_MAX);
 	SetEPRxStatus(ENDP1, EP_RX_VALID);
 	SetEPTxStatus(ENDP1, EP_TX_NAK);
 
+	/* Reports queued before the reset are stale */
+	HID_Fifo_Init();
+#if defined (CUSTOMHID_ADC_STREAM)
+	HID_Stream_Init();
+#endif
+
 	/* Set this device to response on default address */
 	SetDeviceAddress(0);
 	bDeviceState = ATTACHED;
@@ -203,6 +211,9 @@ void CustomHID_SetConfiguration(void)
 #else
 		ADC_SoftwareStartConvCmd(ADC1, ENABLE);
 #endif /* STM32L1XX_XD */
+
+		/* Start the conversion trigger of the ADC stream */
+		ADC_Stream_Cmd(ENABLE);
 	}
 }
 
@@ -238,28 +249,28 @@ void CustomHID_Status_In(void)
 	switch (Report_Buf[0]) {
 		/*Change LED's status according to the host report */
 
-	case 1:		/* Led 1 */
+	case HID_REPORT_LED1:
 		if (Led_State != Bit_RESET) {
 			STM_EVAL_LEDOn(LED1);
 		} else {
 			STM_EVAL_LEDOff(LED1);
 		}
 		break;
-	case 2:		/* Led 2 */
+	case HID_REPORT_LED2:
 		if (Led_State != Bit_RESET) {
 			STM_EVAL_LEDOn(LED2);
 		} else {
 			STM_EVAL_LEDOff(LED2);
 		}
 		break;
-	case 3:		/* Led 3 */
+	case HID_REPORT_LED3:
 		if (Led_State != Bit_RESET) {
 			STM_EVAL_LEDOn(LED3);
 		} else {
 			STM_EVAL_LEDOff(LED3);
 		}
 		break;
-	case 4:		/* Led 4 */
+	case HID_REPORT_LED4:
 		if (Led_State != Bit_RESET) {
 			STM_EVAL_LEDOn(LED4);
 		} else {
@@ -350,7 +361,8 @@ RESULT CustomHID_Data_Setup(uint8_t RequestNo)
 uint8_t *CustomHID_SetReport_Feature(uint16_t Length)
 {
 	if (Length == 0) {
-		pInformation->Ctrl_Info.Usb_wLength = 2;
+		pInformation->Ctrl_Info.Usb_wLength =
+		    CUSTOMHID_FEATURE_REPORT_MAX;
 		return NULL;
 	} else {
 		return Report_Buf;
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file    dfu_lz.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for dfu_lz.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DFU_LZ_H
+#define __DFU_LZ_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_type.h"
+#include "usb_desc.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* Stream parameters, the -w and -l options of the heatshrink encoder. The
+   window is the RAM kept for the back references. */
+#ifndef DFU_LZ_WINDOW_BITS
+#define DFU_LZ_WINDOW_BITS          8
+#endif /* DFU_LZ_WINDOW_BITS */
+#ifndef DFU_LZ_LOOKAHEAD_BITS
+#define DFU_LZ_LOOKAHEAD_BITS       4
+#endif /* DFU_LZ_LOOKAHEAD_BITS */
+
+#define DFU_LZ_WINDOW_SIZE          (1 << DFU_LZ_WINDOW_BITS)
+
+#if (DFU_LZ_WINDOW_BITS < 4) || (DFU_LZ_WINDOW_BITS > 15) \
+    || (DFU_LZ_LOOKAHEAD_BITS < 3) || (DFU_LZ_LOOKAHEAD_BITS >= DFU_LZ_WINDOW_BITS)
+#error "Invalid heatshrink window or lookahead size"
+#endif
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void DFU_LZ_Start(uint32_t Address, uint32_t Length, uint32_t Crc);
+void DFU_LZ_Stop(void);
+uint8_t DFU_LZ_Active(void);
+uint16_t DFU_LZ_Decode(uint8_t * pData, uint32_t DataLength);
+uint16_t DFU_LZ_Check(void);
+
+#endif /* __DFU_LZ_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
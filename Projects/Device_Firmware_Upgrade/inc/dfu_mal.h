@@ -31,13 +31,13 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "platform_config.h"
-#include "dfu_mal.h"
 #include "usb_desc.h"
 
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
 #define MAL_OK   0
 #define MAL_FAIL 1
+#define MAL_BUSY 2
 #define MAX_USED_MEDIA 3
 #define MAL_MASK 0xFC000000
 
@@ -49,6 +49,16 @@
 #define NOR_M29W128G        0x2221
 #define NOR_S29GL128        0x2221
 
+/* Operations handed to MAL_Process by MAL_Submit */
+#define MAL_ERASE           0
+#define MAL_WRITE           1
+#define MAL_FLUSH           2	/* erase the pages still deferred */
+#define MAL_DECODE          3	/* decode a compressed block (DFU_COMPRESSED) */
+
+/* Longest bwPollTimeout reported at once, in ms: the host polls again before
+   the 11-bit USB frame number used to time the operations wraps */
+#define MAL_MAX_POLL_TIME   1000
+
 /* utils macro ---------------------------------------------------------------*/
 #define _1st_BYTE(x)  (uint8_t)((x)&0xFF)	/* 1st addressing cycle */
 #define _2nd_BYTE(x)  (uint8_t)(((x)&0xFF00)>>8)	/* 2nd addressing cycle */
@@ -65,9 +75,16 @@ uint16_t MAL_Init(void);
 uint16_t MAL_Erase(uint32_t SectorAddress);
 uint16_t MAL_Write(uint32_t SectorAddress, uint32_t DataLength);
 uint8_t *MAL_Read(uint32_t SectorAddress, uint32_t DataLength);
-uint16_t MAL_GetStatus(uint32_t SectorAddress, uint8_t Cmd, uint8_t * buffer);
+uint16_t MAL_Submit(uint8_t Cmd, uint32_t SectorAddress, uint32_t DataLength);
+uint16_t MAL_Complete(void);
+void MAL_Process(void);
+uint16_t MAL_GetStatus(uint8_t * buffer);
+uint32_t MAL_GetDeferred(void);
+void MAL_Restart(void);
+uint32_t MAL_GetSkipped(void);
 
-extern uint8_t MAL_Buffer[wTransferSize];	/* RAM Buffer for Downloaded Data */
+extern uint8_t *MAL_Buffer;	/* RAM Buffer receiving the Downloaded Data */
+extern uint8_t *MAL_Program_Buffer;	/* RAM Buffer being written to the media */
 #endif /* __DFU_MAL_H */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -41,6 +41,10 @@ uint16_t FLASH_If_Init(void);
 uint16_t FLASH_If_Erase(uint32_t SectorAddress);
 uint16_t FLASH_If_Write(uint32_t SectorAddress, uint32_t DataLength);
 uint8_t *FLASH_If_Read(uint32_t SectorAddress, uint32_t DataLength);
+uint16_t FLASH_If_Flush(void);
+uint16_t FLASH_If_Restart(void);
+uint32_t FLASH_If_GetDeferred(void);
+uint32_t FLASH_If_GetSkipped(void);
 
 #endif /* __FLASH_IF_MAL_H */
 
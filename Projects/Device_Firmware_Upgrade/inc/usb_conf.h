@@ -64,6 +64,11 @@
 #define S29GL128_SECTOR_ERASE_TIME      1000
 #define S29GL128_SECTOR_WRITE_TIME      45
 
+/* DFU_COMPRESSED: accepts images compressed with heatshrink
+   (see dfu_lz.h), announced by CMD_COMPRESSED. It adds about 1 KB of code:
+   check that the DFU code still ends below ApplicationAddress. */
+/* #define DFU_COMPRESSED */
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 /* External variables --------------------------------------------------------*/
@@ -51,6 +51,17 @@
 
 #define DFU_SIZ_STRING_INTERFACE1       98	/* SPI Flash : M25P64 */
 #define DFU_SIZ_STRING_INTERFACE2       106	/* NOR Flash : M26M128 */
+#define DFU_SIZ_STRING_STATUS           44	/* Unchanged pages: 0000 */
+
+/* Status description string, last of the table, whose index is reported in
+   iString during manifestation */
+#ifdef USE_STM3210E_EVAL
+#define DFU_STRING_STATUS_INDEX         7
+#elif defined(USE_STM3210B_EVAL)
+#define DFU_STRING_STATUS_INDEX         6
+#else
+#define DFU_STRING_STATUS_INDEX         5
+#endif /* USE_STM3210E_EVAL */
 
 extern uint8_t DFU_DeviceDescriptor[DFU_SIZ_DEVICE_DESC];
 extern uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC];
@@ -63,13 +74,58 @@ extern uint8_t DFU_StringInterface1[DFU_SIZ_STRING_INTERFACE1];
 extern uint8_t DFU_StringInterface2_1[DFU_SIZ_STRING_INTERFACE2];
 extern uint8_t DFU_StringInterface2_2[DFU_SIZ_STRING_INTERFACE2];
 extern uint8_t DFU_StringInterface2_3[DFU_SIZ_STRING_INTERFACE2];
+extern uint8_t DFU_StringStatus[DFU_SIZ_STRING_STATUS];
 
 #define bMaxPacketSize0             0x40	/* bMaxPacketSize0 = 64 bytes   */
 
-#define wTransferSize               0x0400	/* wTransferSize   = 1024 bytes */
-/* bMaxPacketSize0 <= wTransferSize <= 32kbytes */
-#define wTransferSizeB0             0x00
-#define wTransferSizeB1             0x04
+/* Internal flash page, and the unit the blocks are aligned on: the page on
+   STM32F1 and STM32F3, the half-page written at once on STM32L1 */
+#if defined(STM32L1XX_MD) || defined(STM32L1XX_HD) || defined(STM32L1XX_MD_PLUS)
+#define DFU_FLASH_PAGE_SIZE         0x0100
+#define DFU_FLASH_BLOCK_SIZE        0x0080
+#elif defined(STM32F10X_MD)
+#define DFU_FLASH_PAGE_SIZE         0x0400
+#define DFU_FLASH_BLOCK_SIZE        DFU_FLASH_PAGE_SIZE
+#else
+#define DFU_FLASH_PAGE_SIZE         0x0800
+#define DFU_FLASH_BLOCK_SIZE        DFU_FLASH_PAGE_SIZE
+#endif /* STM32L1XX_XD */
+
+/* Internal flash size, the largest of each line */
+#if defined(STM32L1XX_HD)
+#define DFU_FLASH_SIZE              0x60000	/* 384 KB */
+#elif defined(STM32L1XX_MD_PLUS) || defined(USE_STM32373C_EVAL) || defined(USE_STM32303C_EVAL)
+#define DFU_FLASH_SIZE              0x40000	/* 256 KB */
+#elif defined(STM32L1XX_MD) || defined(STM32F10X_MD)
+#define DFU_FLASH_SIZE              0x20000	/* 128 KB */
+#elif defined(STM32F10X_XL)
+#define DFU_FLASH_SIZE              0x100000	/* 1 MB */
+#else
+#define DFU_FLASH_SIZE              0x80000	/* 512 KB */
+#endif /* STM32L1XX_HD */
+
+/* wTransferSize: bytes per DNLOAD/UPLOAD block, may be set on the compiler
+   command line. A multiple of DFU_FLASH_BLOCK_SIZE, up to the page on STM32F1
+   and STM32F3 and any number of half-pages on STM32L1. Two blocks are held in
+   RAM (MAL_Buffer). */
+#ifndef wTransferSize
+#if defined(STM32L1XX_MD) || defined(STM32L1XX_HD) || defined(STM32L1XX_MD_PLUS)
+#define wTransferSize               0x0800	/* wTransferSize = 16 half-pages */
+#else
+#define wTransferSize               DFU_FLASH_PAGE_SIZE	/* wTransferSize = 1 page */
+#endif /* STM32L1XX_XD */
+#endif /* wTransferSize */
+
+#if (wTransferSize < bMaxPacketSize0) || ((wTransferSize % DFU_FLASH_BLOCK_SIZE) != 0)
+#error "wTransferSize must be a multiple of DFU_FLASH_BLOCK_SIZE"
+#endif
+#if !defined(STM32L1XX_MD) && !defined(STM32L1XX_HD) && !defined(STM32L1XX_MD_PLUS) \
+    && (wTransferSize > DFU_FLASH_PAGE_SIZE)
+#error "wTransferSize must not exceed the flash page"
+#endif
+
+#define wTransferSizeB0             (wTransferSize & 0xFF)
+#define wTransferSizeB1             ((wTransferSize >> 8) & 0xFF)
 
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
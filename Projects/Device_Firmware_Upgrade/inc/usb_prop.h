@@ -51,6 +51,7 @@ uint8_t *DNLOAD(uint16_t Length);
 uint8_t *GETSTATE(uint16_t Length);
 uint8_t *GETSTATUS(uint16_t Length);
 void DFU_write_crc(void);
+void DFU_Manifest_Process(void);
 
 /* External variables --------------------------------------------------------*/
 
@@ -132,6 +133,7 @@ typedef enum _DFU_REQUESTS {
 #define CMD_GETCOMMANDS              0x00
 #define CMD_SETADDRESSPOINTER        0x21
 #define CMD_ERASE                    0x41
+#define CMD_COMPRESSED               0x5A	/* DFU_COMPRESSED */
 
 #endif /* __USB_PROP_H */
 
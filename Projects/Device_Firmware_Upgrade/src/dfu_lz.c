@@ -0,0 +1,280 @@
+/**
+  ******************************************************************************
+  * @file    dfu_lz.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Compressed download: the DNLOAD blocks carry a heatshrink (LZSS)
+  *          stream, decoded block by block into a page buffer that is
+  *          written to the media each time a page is complete. The decoded
+  *          image is checked against the length and CRC-32 announced by
+  *          CMD_COMPRESSED.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dfu_lz.h"
+#include "dfu_mal.h"
+
+#ifdef DFU_COMPRESSED
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define DFU_LZ_MASK                 (DFU_LZ_WINDOW_SIZE - 1)
+
+/* Decoder states, the field read next */
+#define DFU_LZ_TAG                  0	/* 1: literal, 0: back reference */
+#define DFU_LZ_LITERAL              1
+#define DFU_LZ_INDEX                2	/* distance - 1 */
+#define DFU_LZ_COUNT                3	/* length - 1 */
+#define DFU_LZ_COPY                 4	/* back reference being output */
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Bits of each field, by state */
+static const uint8_t DFU_LZ_Width[4] = {
+	1, 8, DFU_LZ_WINDOW_BITS, DFU_LZ_LOOKAHEAD_BITS
+};
+
+/* CRC-32 (IEEE 802.3, as zlib) by nibble */
+static const uint32_t DFU_LZ_CrcTable[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+	0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+	0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint8_t DFU_LZ_Window[DFU_LZ_WINDOW_SIZE];	/* last decoded bytes */
+static uint32_t DFU_LZ_Page[DFU_FLASH_PAGE_SIZE / 4];	/* word aligned */
+
+static uint8_t DFU_LZ_Running = 0;	/* CMD_COMPRESSED received */
+static uint8_t DFU_LZ_Error = 0;
+static uint8_t DFU_LZ_State = DFU_LZ_TAG;
+static uint8_t DFU_LZ_BitCount = 0;	/* input bits not read yet */
+static uint32_t DFU_LZ_Bits = 0;	/* these bits, right aligned */
+static uint16_t DFU_LZ_Head = 0;	/* window position written next */
+static uint16_t DFU_LZ_Index = 0;	/* back reference distance */
+static uint16_t DFU_LZ_Count = 0;	/* back reference bytes left */
+static uint32_t DFU_LZ_Address = 0;	/* media address of DFU_LZ_Page */
+static uint32_t DFU_LZ_Fill = 0;	/* bytes in DFU_LZ_Page */
+static uint32_t DFU_LZ_Left = 0;	/* decoded bytes still expected */
+static uint32_t DFU_LZ_Crc = 0;
+static uint32_t DFU_LZ_Expected = 0;	/* CRC-32 of the whole image */
+
+/* Extern variables ----------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static void DFU_LZ_Output(uint8_t Data);
+static void DFU_LZ_Flush(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : DFU_LZ_Start
+* Description    : Start a compressed download: the next DNLOAD blocks are
+*                  decoded to Address onward.
+* Input          : - Address: media address of the image.
+*                  - Length: decoded image bytes.
+*                  - Crc: CRC-32 of the decoded image.
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void DFU_LZ_Start(uint32_t Address, uint32_t Length, uint32_t Crc)
+{
+	uint32_t idx = 0;
+
+	/* Back references before the image start read zeros */
+	for (idx = 0; idx < DFU_LZ_WINDOW_SIZE; idx++) {
+		DFU_LZ_Window[idx] = 0;
+	}
+
+	DFU_LZ_Error = 0;
+	DFU_LZ_State = DFU_LZ_TAG;
+	DFU_LZ_BitCount = 0;
+	DFU_LZ_Bits = 0;
+	DFU_LZ_Head = 0;
+	DFU_LZ_Address = Address;
+	DFU_LZ_Fill = 0;
+	DFU_LZ_Left = Length;
+	DFU_LZ_Crc = 0xFFFFFFFF;
+	DFU_LZ_Expected = Crc;
+	DFU_LZ_Running = 1;
+}
+
+/*******************************************************************************
+* Function Name  : DFU_LZ_Stop
+* Description    : Leave the compressed download, on abort.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void DFU_LZ_Stop(void)
+{
+	DFU_LZ_Running = 0;
+}
+
+/*******************************************************************************
+* Function Name  : DFU_LZ_Active
+* Description    : Whether the DNLOAD blocks are compressed.
+* Input          : None
+* Output         : None
+* Return         : 1 during a compressed download, 0 otherwise.
+*******************************************************************************/
+uint8_t DFU_LZ_Active(void)
+{
+	return DFU_LZ_Running;
+}
+
+/*******************************************************************************
+* Function Name  : DFU_LZ_Decode
+* Description    : Decode a DNLOAD block, called by MAL_Process. A field cut
+*                  at the end of the block is completed by the next one. The
+*                  bytes after the announced length, the stream padding, are
+*                  ignored.
+* Input          : - pData: compressed data.
+*                  - DataLength: bytes of compressed data.
+* Output         : None
+* Return         : MAL_OK, or MAL_FAIL once a write failed.
+*******************************************************************************/
+uint16_t DFU_LZ_Decode(uint8_t * pData, uint32_t DataLength)
+{
+	uint8_t *pEnd = pData + DataLength;
+	uint8_t Width = 0;
+	uint16_t Value = 0;
+
+	while ((DFU_LZ_Left != 0) && (DFU_LZ_Error == 0)) {
+		if (DFU_LZ_State == DFU_LZ_COPY) {
+			DFU_LZ_Output(DFU_LZ_Window[(DFU_LZ_Head - DFU_LZ_Index)
+						    & DFU_LZ_MASK]);
+			if (--DFU_LZ_Count == 0) {
+				DFU_LZ_State = DFU_LZ_TAG;
+			}
+			continue;
+		}
+
+		Width = DFU_LZ_Width[DFU_LZ_State];
+		while (DFU_LZ_BitCount < Width) {
+			if (pData == pEnd) {
+				return MAL_OK;	/* continued by the next block */
+			}
+			DFU_LZ_Bits = (DFU_LZ_Bits << 8) | *pData++;
+			DFU_LZ_BitCount += 8;
+		}
+		DFU_LZ_BitCount -= Width;
+		Value = (DFU_LZ_Bits >> DFU_LZ_BitCount) & ((1 << Width) - 1);
+
+		switch (DFU_LZ_State) {
+		case DFU_LZ_TAG:
+			DFU_LZ_State = (Value != 0) ? DFU_LZ_LITERAL : DFU_LZ_INDEX;
+			break;
+		case DFU_LZ_LITERAL:
+			DFU_LZ_Output((uint8_t) Value);
+			DFU_LZ_State = DFU_LZ_TAG;
+			break;
+		case DFU_LZ_INDEX:
+			DFU_LZ_Index = Value + 1;
+			DFU_LZ_State = DFU_LZ_COUNT;
+			break;
+		default:
+			DFU_LZ_Count = Value + 1;
+			DFU_LZ_State = DFU_LZ_COPY;
+			break;
+		}
+	}
+
+	return (DFU_LZ_Error == 0) ? MAL_OK : MAL_FAIL;
+}
+
+/*******************************************************************************
+* Function Name  : DFU_LZ_Check
+* Description    : Verify the decoded image at manifestation, ending the
+*                  compressed download.
+* Input          : None
+* Output         : None
+* Return         : MAL_OK if the image is complete and its CRC-32 matches,
+*                  or for an uncompressed download, MAL_FAIL otherwise.
+*******************************************************************************/
+uint16_t DFU_LZ_Check(void)
+{
+	if (DFU_LZ_Running == 0) {
+		return MAL_OK;
+	}
+	DFU_LZ_Running = 0;
+
+	if ((DFU_LZ_Error != 0) || (DFU_LZ_Left != 0)
+	    || ((DFU_LZ_Crc ^ 0xFFFFFFFF) != DFU_LZ_Expected)) {
+		return MAL_FAIL;
+	}
+
+	return MAL_OK;
+}
+
+/*******************************************************************************
+* Function Name  : DFU_LZ_Output
+* Description    : Append a decoded byte to the window, the CRC and the page
+*                  buffer, written once it reaches the end of a page or of
+*                  the image.
+* Input          : - Data: decoded byte.
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void DFU_LZ_Output(uint8_t Data)
+{
+	DFU_LZ_Window[DFU_LZ_Head] = Data;
+	DFU_LZ_Head = (DFU_LZ_Head + 1) & DFU_LZ_MASK;
+
+	DFU_LZ_Crc = DFU_LZ_CrcTable[(DFU_LZ_Crc ^ Data) & 0x0F]
+	    ^ (DFU_LZ_Crc >> 4);
+	DFU_LZ_Crc = DFU_LZ_CrcTable[(DFU_LZ_Crc ^ (Data >> 4)) & 0x0F]
+	    ^ (DFU_LZ_Crc >> 4);
+
+	((uint8_t *) DFU_LZ_Page)[DFU_LZ_Fill++] = Data;
+	DFU_LZ_Left--;
+
+	if ((DFU_LZ_Left == 0) || (((DFU_LZ_Address + DFU_LZ_Fill)
+				    & (DFU_FLASH_PAGE_SIZE - 1)) == 0)) {
+		DFU_LZ_Flush();
+	}
+}
+
+/*******************************************************************************
+* Function Name  : DFU_LZ_Flush
+* Description    : Write the page buffer, lent to the media as the program
+*                  buffer for the time of the write.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void DFU_LZ_Flush(void)
+{
+	uint8_t *pBuffer = MAL_Program_Buffer;
+
+	MAL_Program_Buffer = (uint8_t *) DFU_LZ_Page;
+	if (MAL_Write(DFU_LZ_Address, DFU_LZ_Fill) != MAL_OK) {
+		DFU_LZ_Error = 1;
+	}
+	MAL_Program_Buffer = pBuffer;
+
+	DFU_LZ_Address += DFU_LZ_Fill;
+	DFU_LZ_Fill = 0;
+}
+
+#endif /* DFU_COMPRESSED */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
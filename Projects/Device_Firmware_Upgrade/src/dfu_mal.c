@@ -32,6 +32,7 @@
 #include "usb_type.h"
 #include "usb_desc.h"
 #include "flash_if.h"
+#include "dfu_lz.h"
 
 #if !defined(STM32L1XX_MD) && !defined(STM32L1XX_HD) && !defined(STM32L1XX_MD_PLUS)&& !defined (USE_STM32373C_EVAL) && !defined (USE_STM32303C_EVAL)
 #include "spi_if.h"
@@ -47,13 +48,29 @@ uint16_t(*pMAL_Init) (void);
 uint16_t(*pMAL_Erase) (uint32_t SectorAddress);
 uint16_t(*pMAL_Write) (uint32_t SectorAddress, uint32_t DataLength);
 uint8_t *(*pMAL_Read) (uint32_t SectorAddress, uint32_t DataLength);
-uint8_t MAL_Buffer[wTransferSize];	/* RAM Buffer for Downloaded Data */
+
+/* The block being written and the one being received use distinct buffers,
+   swapped by MAL_Submit. Word aligned for the flash writes. */
+static uint32_t MAL_Buffers[2][wTransferSize / 4];
+uint8_t *MAL_Buffer = (uint8_t *) MAL_Buffers[0];	/* RAM Buffer receiving the Downloaded Data */
+uint8_t *MAL_Program_Buffer = (uint8_t *) MAL_Buffers[1];	/* RAM Buffer being written */
+
+/* Operation run by MAL_Process from the main loop */
+static __IO uint16_t MAL_Job_Status = MAL_OK;	/* MAL_BUSY until done */
+static __IO uint8_t MAL_Job_Pending = 0;	/* submitted, not started */
+static uint8_t MAL_Job_Cmd = MAL_ERASE;
+static uint32_t MAL_Job_Address = 0;
+static uint32_t MAL_Job_Length = 0;
+static uint32_t MAL_Job_Time = 0;	/* expected duration in ms */
+static uint32_t MAL_Job_Elapsed = 0;	/* ms, updated by MAL_GetStatus */
+static uint16_t MAL_Job_Frame = 0;	/* frame number of the last update */
+static __IO uint8_t MAL_Restart_Pending = 0;	/* MAL_Restart not run yet */
 
 #if !defined(STM32L1XX_MD) && !defined(STM32L1XX_HD) && !defined(STM32L1XX_MD_PLUS)&& !defined (USE_STM32373C_EVAL) && !defined (USE_STM32303C_EVAL)
 NOR_IDTypeDef NOR_ID;
 #endif /* STM32L1XX_XD */
 
-extern ONE_DESCRIPTOR DFU_String_Descriptor[7];
+extern ONE_DESCRIPTOR DFU_String_Descriptor[DFU_STRING_STATUS_INDEX + 1];
 
 /* This table holds the Typical Sector Erase and 1024 Bytes Write timings.
    These timings will be returned to the host when it checks the device
@@ -76,6 +93,9 @@ static const uint16_t TimingTable[5][2] = {	/*       Sector Erase time,
 };
 
 /* Private function prototypes -----------------------------------------------*/
+static uint32_t MAL_GetTiming(uint32_t SectorAddress, uint8_t Cmd,
+			      uint32_t DataLength);
+
 /* Private functions ---------------------------------------------------------*/
 
 /*******************************************************************************
@@ -214,20 +234,192 @@ uint8_t *MAL_Read(uint32_t SectorAddress, uint32_t DataLength)
 	return pMAL_Read(SectorAddress, DataLength);
 }
 
+/*******************************************************************************
+* Function Name  : MAL_Submit
+* Description    : Hand an operation over to MAL_Process. For a write or a
+*                  decode, the received block becomes the program buffer and
+*                  the next block is received in the other one.
+* Input          : - Cmd: MAL_ERASE, MAL_WRITE, MAL_FLUSH or MAL_DECODE.
+*                  - SectorAddress: media address.
+*                  - DataLength: bytes to write or decode from MAL_Buffer, or
+*                    pages to erase for a flush.
+* Output         : None
+* Return         : MAL_OK, or MAL_BUSY while the previous operation runs.
+*******************************************************************************/
+uint16_t MAL_Submit(uint8_t Cmd, uint32_t SectorAddress, uint32_t DataLength)
+{
+	uint8_t *pBuffer;
+
+	if (MAL_Job_Status == MAL_BUSY) {
+		return MAL_BUSY;
+	}
+
+	if ((Cmd == MAL_WRITE) || (Cmd == MAL_DECODE)) {
+		pBuffer = MAL_Program_Buffer;
+		MAL_Program_Buffer = MAL_Buffer;
+		MAL_Buffer = pBuffer;
+	}
+
+	MAL_Job_Cmd = Cmd;
+	MAL_Job_Address = SectorAddress;
+	MAL_Job_Length = DataLength;
+	MAL_Job_Time = MAL_GetTiming(SectorAddress, Cmd, DataLength);
+	MAL_Job_Elapsed = 0;
+	MAL_Job_Frame = _GetFNR() & FNR_FN;
+
+	MAL_Job_Status = MAL_BUSY;
+	MAL_Job_Pending = 1;
+
+	return MAL_OK;
+}
+
+/*******************************************************************************
+* Function Name  : MAL_Complete
+* Description    : Non blocking check of the last submitted operation, and
+*                  of a requested restart.
+* Input          : None
+* Output         : None
+* Return         : MAL_BUSY while running, then MAL_OK or MAL_FAIL.
+*******************************************************************************/
+uint16_t MAL_Complete(void)
+{
+	if (MAL_Restart_Pending != 0) {
+		return MAL_BUSY;
+	}
+	return MAL_Job_Status;
+}
+
+/*******************************************************************************
+* Function Name  : MAL_Restart
+* Description    : Request a new start, on abort or at the first block of a
+*                  download: MAL_Process erases the pages whose erase is still
+*                  deferred and restarts the count of the unchanged pages,
+*                  before any further operation. Until then MAL_Complete
+*                  reports MAL_BUSY, so no upload reads pages not erased yet.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void MAL_Restart(void)
+{
+	MAL_Restart_Pending = 1;
+}
+
+/*******************************************************************************
+* Function Name  : MAL_Process
+* Description    : Run the submitted operation, called from the main loop so
+*                  that the next block is received meanwhile.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void MAL_Process(void)
+{
+	uint16_t status;
+
+	if (MAL_Restart_Pending != 0) {
+		/* Ahead of an operation submitted in the meantime */
+		FLASH_If_Restart();
+		MAL_Restart_Pending = 0;
+	}
+
+	if (MAL_Job_Pending == 0) {
+		return;
+	}
+	MAL_Job_Pending = 0;
+
+	if (MAL_Job_Cmd == MAL_ERASE) {
+		status = MAL_Erase(MAL_Job_Address);
+	} else if (MAL_Job_Cmd == MAL_FLUSH) {
+		status = FLASH_If_Flush();
+#ifdef DFU_COMPRESSED
+	} else if (MAL_Job_Cmd == MAL_DECODE) {
+		status = DFU_LZ_Decode(MAL_Program_Buffer, MAL_Job_Length);
+#endif /* DFU_COMPRESSED */
+	} else {
+		status = MAL_Write(MAL_Job_Address, MAL_Job_Length);
+	}
+
+	MAL_Job_Status = status;
+}
+
 /*******************************************************************************
 * Function Name  : MAL_GetStatus
-* Description    : Get status
+* Description    : Set bwPollTimeout to the time left for the operation in
+*                  progress, 0 when the media is idle.
+* Input          : - buffer: DFU status, bwPollTimeout in bytes 1 to 3.
+* Output         : None
+* Return         : MAL_BUSY while running, then MAL_OK or MAL_FAIL.
+*******************************************************************************/
+uint16_t MAL_GetStatus(uint8_t * buffer)
+{
+	uint16_t frame = _GetFNR() & FNR_FN;
+	uint32_t time = 0;
+
+	if (MAL_Job_Status == MAL_BUSY) {
+		MAL_Job_Elapsed += (frame - MAL_Job_Frame) & FNR_FN;
+		MAL_Job_Frame = frame;
+
+		if (MAL_Job_Elapsed < MAL_Job_Time) {
+			time = MAL_Job_Time - MAL_Job_Elapsed;
+		} else {
+			time = 1;	/* late: poll again on the next frame */
+		}
+		if (time > MAL_MAX_POLL_TIME) {
+			time = MAL_MAX_POLL_TIME;
+		}
+	}
+
+	SET_POLLING_TIMING(time);
+	return MAL_Job_Status;
+}
+
+/*******************************************************************************
+* Function Name  : MAL_GetDeferred
+* Description    : Internal flash pages whose erase is deferred, to be erased
+*                  by a MAL_FLUSH before manifestation.
 * Input          : None
 * Output         : None
-* Return         : Buffer pointer
+* Return         : Page count.
 *******************************************************************************/
-uint16_t MAL_GetStatus(uint32_t SectorAddress, uint8_t Cmd, uint8_t * buffer)
+uint32_t MAL_GetDeferred(void)
+{
+	return FLASH_If_GetDeferred();
+}
+
+/*******************************************************************************
+* Function Name  : MAL_GetSkipped
+* Description    : Internal flash pages left untouched, already holding the
+*                  downloaded data.
+* Input          : None
+* Output         : None
+* Return         : Page count.
+*******************************************************************************/
+uint32_t MAL_GetSkipped(void)
+{
+	return FLASH_If_GetSkipped();
+}
+
+/*******************************************************************************
+* Function Name  : MAL_GetTiming
+* Description    : Expected duration of an operation, from the typical sector
+*                  erase time or the 1024 bytes write time of the media.
+* Input          : - SectorAddress: media address.
+*                  - Cmd: MAL_ERASE, MAL_WRITE, MAL_FLUSH or MAL_DECODE.
+*                  - DataLength: bytes written, or decoded, or pages erased by
+*                    a flush. A decode is timed as the write of its input.
+* Output         : None
+* Return         : Duration in ms, at least 1.
+*******************************************************************************/
+static uint32_t MAL_GetTiming(uint32_t SectorAddress, uint8_t Cmd,
+			      uint32_t DataLength)
 {
 	uint8_t x = (SectorAddress >> 26) & 0x03;	/* 0x000000000 --> 0 */
 	/* 0x640000000 --> 1 */
 	/* 0x080000000 --> 2 */
 
 	uint8_t y = Cmd & 0x01;
+	uint32_t time;
 
 #if defined(USE_STM3210E_EVAL)
 	if ((x == 1) && (NOR_ID.Device_Code2 == NOR_M29W128G)
@@ -239,9 +431,15 @@ uint16_t MAL_GetStatus(uint32_t SectorAddress, uint8_t Cmd, uint8_t * buffer)
 	}
 #endif /* USE_STM3210E_EVAL */
 
-	SET_POLLING_TIMING(TimingTable[x][y]);	/* x: Erase/Write Timing */
+	time = TimingTable[x][y];	/* x: Erase/Write Timing */
 	/* y: Media              */
-	return MAL_OK;
+	if (y == MAL_WRITE) {
+		time = ((time * DataLength) + 1023) / 1024;
+	} else if (Cmd == MAL_FLUSH) {
+		time *= DataLength;
+	}
+
+	return (time != 0) ? time : 1;
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -31,15 +31,33 @@
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
-/* Private macro -------------------------------------------------------------*/
-/* Private variables ---------------------------------------------------------*/
+#define FLASH_IF_PAGES      (DFU_FLASH_SIZE / DFU_FLASH_PAGE_SIZE)
 
 #if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
-uint32_t tHalfPage1[128 / 4];
-uint32_t tHalfPage2[128 / 4];
+#define FLASH_IF_ERASED     0x00	/* erased byte value */
+#else
+#define FLASH_IF_ERASED     0xFF
 #endif /* STM32L1XX_XD */
 
+/* Private macro -------------------------------------------------------------*/
+#define FLASH_IF_PAGE(Address)  \
+                    (((Address) - INTERNAL_FLASH_BASE) / DFU_FLASH_PAGE_SIZE)
+
+/* Private variables ---------------------------------------------------------*/
+/* Pages whose erase was requested and is deferred until their data arrive */
+static uint32_t FLASH_If_Deferred[(FLASH_IF_PAGES + 31) / 32];
+static uint32_t FLASH_If_DeferredCount = 0;
+
+/* Pages left untouched because they already held the received data */
+static uint32_t FLASH_If_Skipped = 0;
+
 /* Private function prototypes -----------------------------------------------*/
+static uint8_t FLASH_If_Prepare(uint32_t Address, uint8_t * pData,
+				uint32_t Length);
+static void FLASH_If_ErasePage(uint32_t PageAddress);
+static void FLASH_If_Program(uint32_t Address, uint32_t * pData,
+			     uint32_t Length);
+
 /* Private functions ---------------------------------------------------------*/
 
 /*******************************************************************************
@@ -56,26 +74,32 @@ uint16_t FLASH_If_Init(void)
 
 /*******************************************************************************
 * Function Name  : FLASH_If_Erase
-* Description    : Erase sector
+* Description    : Erase sector. The erase is only recorded: the page is
+*                  compared with its data when they arrive and erased only if
+*                  they differ, or by FLASH_If_Flush if no data arrive.
 * Input          : None
 * Output         : None
 * Return         : None
 *******************************************************************************/
 uint16_t FLASH_If_Erase(uint32_t SectorAddress)
 {
-#if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
-	FLASH_ClearFlag(FLASH_FLAG_PGAERR | FLASH_FLAG_OPTVERR);
-	FLASH_ErasePage(SectorAddress);
-#else
-	FLASH_ErasePage(SectorAddress);
-#endif /* STM32L1XX_XD */
+	uint32_t Page = FLASH_IF_PAGE(SectorAddress);
+
+	if (Page >= FLASH_IF_PAGES) {
+		FLASH_If_ErasePage(SectorAddress);
+	} else if ((FLASH_If_Deferred[Page / 32] & (1UL << (Page % 32))) == 0) {
+		FLASH_If_Deferred[Page / 32] |= 1UL << (Page % 32);
+		FLASH_If_DeferredCount++;
+	}
 
 	return MAL_OK;
 }
 
 /*******************************************************************************
 * Function Name  : FLASH_If_Write
-* Description    : Write sectors
+* Description    : Write sectors, page by page. A page whose erase is
+*                  deferred and that already holds the data is skipped, else
+*                  it is erased first.
 * Input          : None
 * Output         : None
 * Return         : None
@@ -83,71 +107,208 @@ uint16_t FLASH_If_Erase(uint32_t SectorAddress)
 uint16_t FLASH_If_Write(uint32_t SectorAddress, uint32_t DataLength)
 {
 	uint32_t idx = 0;
-#if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
-	__IO uint32_t *malPointer = (uint32_t *) MAL_Buffer;
-	__IO uint32_t *memPointer = (uint32_t *) SectorAddress;
-	__IO uint32_t memBuffer[32];	/* Temporary buffer holding data that will be written in a half-page space */
-	__IO uint32_t *mempBuffer = memBuffer;
-	__IO uint32_t *tmp;
-#endif /* STM32L1XX_XD */
+	uint32_t Length;
+	uint8_t *pData = MAL_Program_Buffer;
 
 	if (DataLength & 0x3) {	/* Not an aligned data */
 		for (idx = DataLength; idx < ((DataLength & 0xFFFC) + 4); idx++) {
-			MAL_Buffer[idx] = 0xFF;
+			MAL_Program_Buffer[idx] = 0xFF;
 		}
+		DataLength = (DataLength & 0xFFFC) + 4;
 	}
-#if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
-	/* Reinitialize the intermediate buffer pointer */
-	mempBuffer = memBuffer;
 
-	/* If the address is not aligned to half-page fill the first location with existing data */
-	if (((uint32_t) memPointer & 0x7F) != 0) {
-		/* get the aligned address */
-		tmp = (uint32_t *) ((uint32_t) memPointer & 0xFFFFFF80);
+	while (DataLength != 0) {
+		/* Up to the end of the page */
+		Length = DFU_FLASH_PAGE_SIZE
+		    - (SectorAddress & (DFU_FLASH_PAGE_SIZE - 1));
+		if (Length > DataLength) {
+			Length = DataLength;
+		}
 
-		/* Read the first part from the memory */
-		while (tmp < memPointer) {
-			*(uint32_t *) (mempBuffer++) = *(uint32_t *) (tmp++);
+		if (FLASH_If_Prepare(SectorAddress, pData, Length) == 0) {
+			FLASH_If_Program(SectorAddress, (uint32_t *) pData,
+					 Length);
 		}
+
+		SectorAddress += Length;
+		pData += Length;
+		DataLength -= Length;
 	}
 
-	while (malPointer < (uint32_t *) (MAL_Buffer + DataLength)) {
-		/* Fill with the received buffer */
-		while (mempBuffer < (memBuffer + 32)) {
-			/* If there are still data available in the received buffer */
-			if (malPointer < ((uint32_t *) MAL_Buffer + DataLength)) {
-				*(uint32_t *) (mempBuffer++) =
-				    *(uint32_t *) (malPointer++);
-			} else {	/* no more data available in the received buffer: fill remaining with dummy 0 */
-
-				*(uint32_t *) (mempBuffer++) = 0;
-			}
+	return MAL_OK;
+}
+
+/*******************************************************************************
+* Function Name  : FLASH_If_Flush
+* Description    : Erase the pages whose erase is still deferred, none of
+*                  their data having arrived.
+* Input          : None
+* Output         : None
+* Return         : MAL_OK
+*******************************************************************************/
+uint16_t FLASH_If_Flush(void)
+{
+	uint32_t Page;
+
+	for (Page = 0; Page < FLASH_IF_PAGES; Page++) {
+		if (FLASH_If_Deferred[Page / 32] & (1UL << (Page % 32))) {
+			FLASH_If_ErasePage(INTERNAL_FLASH_BASE
+					   + (Page * DFU_FLASH_PAGE_SIZE));
+			FLASH_If_Deferred[Page / 32] &= ~(1UL << (Page % 32));
 		}
+	}
+	FLASH_If_DeferredCount = 0;
 
-		/* Write the buffer to the memory */
-		FLASH_ProgramHalfPage(((uint32_t) memPointer & 0xFFFFFF80),
-				      (uint32_t *) (memBuffer));
+	return MAL_OK;
+}
 
-		/* Increment the memory pointer */
-		memPointer =
-		    (uint32_t *) (((uint32_t) memPointer & 0xFFFFFF80) +
-				  (32 * 4));
+/*******************************************************************************
+* Function Name  : FLASH_If_Restart
+* Description    : Start over for a new download: erase the pages whose
+*                  erase is still deferred and restart the count of the
+*                  unchanged pages.
+* Input          : None
+* Output         : None
+* Return         : MAL_OK
+*******************************************************************************/
+uint16_t FLASH_If_Restart(void)
+{
+	FLASH_If_Skipped = 0;
 
-		/* Reinitialize the intermediate buffer pointer */
-		mempBuffer = memBuffer;
-	}
+	return FLASH_If_Flush();
+}
 
-#else
+/*******************************************************************************
+* Function Name  : FLASH_If_GetDeferred
+* Description    : Number of pages whose erase is deferred.
+* Input          : None
+* Output         : None
+* Return         : Page count.
+*******************************************************************************/
+uint32_t FLASH_If_GetDeferred(void)
+{
+	return FLASH_If_DeferredCount;
+}
+
+/*******************************************************************************
+* Function Name  : FLASH_If_GetSkipped
+* Description    : Number of pages skipped in the current download.
+* Input          : None
+* Output         : None
+* Return         : Page count.
+*******************************************************************************/
+uint32_t FLASH_If_GetSkipped(void)
+{
+	return FLASH_If_Skipped;
+}
 
-	/* Data received are Word multiple */
-	for (idx = 0; idx < DataLength; idx = idx + 4) {
-		FLASH_ProgramWord(SectorAddress,
-				  *(uint32_t *) (MAL_Buffer + idx));
-		SectorAddress += 4;
+/*******************************************************************************
+* Function Name  : FLASH_If_Prepare
+* Description    : Get a page ready for its part of a block. When its erase
+*                  is deferred, the page is compared with what erase and
+*                  program would leave: the data over the part written, the
+*                  erased value elsewhere. It is skipped if equal, erased now
+*                  otherwise.
+* Input          : - Address: start of the part written, in a single page.
+*                  - pData: data of the part.
+*                  - Length: bytes of the part.
+* Output         : None
+* Return         : 1 if the page already holds the data, 0 to program it.
+*******************************************************************************/
+static uint8_t FLASH_If_Prepare(uint32_t Address, uint8_t * pData,
+				uint32_t Length)
+{
+	uint32_t Page = FLASH_IF_PAGE(Address);
+	uint8_t *pFlash = (uint8_t *) (Address & ~(DFU_FLASH_PAGE_SIZE - 1));
+	uint8_t *pStart = (uint8_t *) Address;
+	uint8_t *pEnd = pStart + Length;
+	uint8_t *pPageEnd = pFlash + DFU_FLASH_PAGE_SIZE;
+
+	if ((Page >= FLASH_IF_PAGES)
+	    || ((FLASH_If_Deferred[Page / 32] & (1UL << (Page % 32))) == 0)) {
+		return 0;
+	}
+	FLASH_If_Deferred[Page / 32] &= ~(1UL << (Page % 32));
+	FLASH_If_DeferredCount--;
+
+	while ((pFlash < pStart) && (*pFlash == FLASH_IF_ERASED)) {
+		pFlash++;
 	}
+	if (pFlash == pStart) {
+		while ((pFlash < pEnd) && (*pFlash == *pData)) {
+			pFlash++;
+			pData++;
+		}
+	}
+	if (pFlash == pEnd) {
+		while ((pFlash < pPageEnd) && (*pFlash == FLASH_IF_ERASED)) {
+			pFlash++;
+		}
+	}
+	if (pFlash == pPageEnd) {
+		FLASH_If_Skipped++;
+		return 1;
+	}
+
+	FLASH_If_ErasePage((uint32_t) pPageEnd - DFU_FLASH_PAGE_SIZE);
+	return 0;
+}
+
+/*******************************************************************************
+* Function Name  : FLASH_If_ErasePage
+* Description    : Erase a page now.
+* Input          : - PageAddress: page address.
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void FLASH_If_ErasePage(uint32_t PageAddress)
+{
+#if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
+	FLASH_ClearFlag(FLASH_FLAG_PGAERR | FLASH_FLAG_OPTVERR);
+	FLASH_ErasePage(PageAddress);
+#else
+	FLASH_ErasePage(PageAddress);
 #endif /* STM32L1XX_XD */
+}
 
-	return MAL_OK;
+/*******************************************************************************
+* Function Name  : FLASH_If_Program
+* Description    : Program words straight from the program buffer: whole
+*                  aligned half-pages at once on STM32L1, words otherwise.
+*                  The blocks being multiples of DFU_FLASH_BLOCK_SIZE, only a
+*                  block starting off a half-page boundary or the last,
+*                  shorter one are programmed by words on STM32L1.
+* Input          : - Address: flash address.
+*                  - pData: word aligned data.
+*                  - Length: bytes, multiple of 4.
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void FLASH_If_Program(uint32_t Address, uint32_t * pData,
+			     uint32_t Length)
+{
+	uint32_t EndAddress = Address + Length;
+
+	while (Address < EndAddress) {
+#if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
+		if (((Address & (DFU_FLASH_BLOCK_SIZE - 1)) == 0)
+		    && ((EndAddress - Address) >= DFU_FLASH_BLOCK_SIZE)) {
+			/* Whole half-page. This runs from the main loop: no
+			   interrupt may read the flash during the write */
+			__disable_irq();
+			FLASH_ProgramHalfPage(Address, pData);
+			__enable_irq();
+
+			Address += DFU_FLASH_BLOCK_SIZE;
+			pData += DFU_FLASH_BLOCK_SIZE / 4;
+			continue;
+		}
+		FLASH_FastProgramWord(Address, *pData++);
+#else
+		FLASH_ProgramWord(Address, *pData++);
+#endif /* STM32L1XX_XD */
+		Address += 4;
+	}
 }
 
 /*******************************************************************************
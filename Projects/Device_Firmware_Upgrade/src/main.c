@@ -88,8 +88,11 @@ int main(void)
 	Set_USBClock();
 	USB_Init();
 
-	/* Main loop */
+	/* Main loop: erase and program the media while the next block is
+	   received under interrupt, then complete the manifestation */
 	while (1) {
+		MAL_Process();
+		DFU_Manifest_Process();
 	}
 }
 
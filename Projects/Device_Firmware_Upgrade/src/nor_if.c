@@ -88,10 +88,10 @@ uint16_t NOR_If_Write(uint32_t Address, uint32_t DataLength)
 {
 	if ((DataLength & 1) == 1) {	/* Not an aligned data */
 		DataLength += 1;
-		MAL_Buffer[DataLength - 1] = 0xFF;
+		MAL_Program_Buffer[DataLength - 1] = 0xFF;
 	}
 
-	FSMC_NOR_WriteBuffer((uint16_t *) MAL_Buffer, (Address & 0x00FFFFFF),
+	FSMC_NOR_WriteBuffer((uint16_t *) MAL_Program_Buffer, (Address & 0x00FFFFFF),
 			     DataLength >> 1);
 
 	return MAL_OK;
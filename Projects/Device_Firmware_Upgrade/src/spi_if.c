@@ -79,13 +79,13 @@ uint16_t SPI_If_Write(uint32_t SectorAddress, uint32_t DataLength)
 	if (DataLength & 0xFF) {	/* Not a 256 aligned data */
 		for (idx = DataLength; idx < ((DataLength & 0xFF00) + 0x100);
 		     idx++) {
-			MAL_Buffer[idx] = 0xFF;
+			MAL_Program_Buffer[idx] = 0xFF;
 		}
 		pages = (((DataLength & 0xFF00)) >> 8) + 1;
 	}
 
 	for (idx = 0; idx < pages; idx++) {
-		sFLASH_WritePage(&MAL_Buffer[idx * 256], SectorAddress, 256);
+		sFLASH_WritePage(&MAL_Program_Buffer[idx * 256], SectorAddress, 256);
 		SectorAddress += 0x100;
 	}
 	return MAL_OK;
@@ -119,7 +119,7 @@ uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC] = {
 	0xFF,			/*DetachTimeOut= 255 ms */
 	0x00,
 	wTransferSizeB0,
-	wTransferSizeB1,	/* TransferSize = 1024 Byte */
+	wTransferSizeB1,	/* TransferSize = wTransferSize */
 	0x1A,			/* bcdDFUVersion */
 	0x01
     /***********************************************************/
@@ -201,7 +201,7 @@ uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC] = {
 	0xFF,			/*DetachTimeOut= 255 ms */
 	0x00,
 	wTransferSizeB0,
-	wTransferSizeB1,	/* TransferSize = 1024 Byte */
+	wTransferSizeB1,	/* TransferSize = wTransferSize */
 	0x1A,			/* bcdDFUVersion */
 	0x01
     /***********************************************************/
@@ -253,7 +253,7 @@ uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC] = {
 	0xFF,			/*DetachTimeOut= 255 ms */
 	0x00,
 	wTransferSizeB0,
-	wTransferSizeB1,	/* TransferSize = 128 Bytes */
+	wTransferSizeB1,	/* TransferSize = wTransferSize */
 	0x1A,			/* bcdDFUVersion */
 	0x01
     /***********************************************************/
@@ -305,7 +305,7 @@ uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC] = {
 	0xFF,			/*DetachTimeOut= 255 ms */
 	0x00,
 	wTransferSizeB0,
-	wTransferSizeB1,	/* TransferSize = 128 Bytes */
+	wTransferSizeB1,	/* TransferSize = wTransferSize */
 	0x1A,			/* bcdDFUVersion */
 	0x01
     /***********************************************************/
@@ -472,4 +472,14 @@ uint8_t DFU_StringInterface2_3[DFU_SIZ_STRING_INTERFACE2] = {
 	    'g', 0
 };
 #endif /* USE_STM3210E_EVAL */
+
+uint8_t DFU_StringStatus[DFU_SIZ_STRING_STATUS] = {
+	DFU_SIZ_STRING_STATUS,
+	0x03,
+	/* Status: "Unchanged pages: 0000", the count set at manifestation */
+	'U', 0, 'n', 0, 'c', 0, 'h', 0, 'a', 0, 'n', 0, 'g', 0, 'e', 0, 'd', 0,
+	' ', 0, 'p', 0, 'a', 0, 'g', 0, 'e', 0, 's', 0, ':', 0, ' ', 0,
+	'0', 0, '0', 0, '0', 0, '0', 0
+};
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -33,6 +33,7 @@
 #include "usb_desc.h"
 #include "usb_pwr.h"
 #include "dfu_mal.h"
+#include "dfu_lz.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -41,6 +42,7 @@
 uint32_t wBlockNum = 0, wlength = 0;
 uint32_t Manifest_State = Manifest_complete;
 uint32_t Pointer = ApplicationAddress;	/* Base Address to Erase, Program or Read */
+static __IO uint8_t Manifest_Pending = 0;	/* dfuMANIFEST reported to the host */
 
 DEVICE Device_Table = {
 	EP_NUM,
@@ -84,14 +86,7 @@ ONE_DESCRIPTOR Config_Descriptor = {
 	DFU_SIZ_CONFIG_DESC
 };
 
-#ifdef USE_STM3210E_EVAL
-ONE_DESCRIPTOR DFU_String_Descriptor[7] =
-#elif defined(USE_STM3210B_EVAL)
-ONE_DESCRIPTOR DFU_String_Descriptor[6] =
-#elif defined(USE_STM32L152_EVAL) || defined(USE_STM32L152D_EVAL) ||defined(USE_STM32373C_EVAL) ||defined(USE_STM32303C_EVAL)
-ONE_DESCRIPTOR DFU_String_Descriptor[5] =
-#endif /* USE_STM3210E_EVAL */
-{
+ONE_DESCRIPTOR DFU_String_Descriptor[DFU_STRING_STATUS_INDEX + 1] = {
 	{(uint8_t *) DFU_StringLangId, DFU_SIZ_STRING_LANGID}
 	,
 	{(uint8_t *) DFU_StringVendor, DFU_SIZ_STRING_VENDOR}
@@ -111,6 +106,8 @@ ONE_DESCRIPTOR DFU_String_Descriptor[5] =
 	,
 	{(uint8_t *) DFU_StringInterface2_1, DFU_SIZ_STRING_INTERFACE2}
 #endif /* USE_STM3210E_EVAL */
+	,
+	{(uint8_t *) DFU_StringStatus, DFU_SIZ_STRING_STATUS}
 };
 
 /* Extern variables ----------------------------------------------------------*/
@@ -118,6 +115,8 @@ extern uint8_t DeviceState;
 extern uint8_t DeviceStatus[6];
 
 /* Private function prototypes -----------------------------------------------*/
+static void DFU_SetStatusString(uint32_t Count);
+
 /* Private functions ---------------------------------------------------------*/
 
 /*******************************************************************************
@@ -224,7 +223,9 @@ void DFU_Status_In(void)
 
 /*******************************************************************************
 * Function Name  : DFU_Status_Out.
-* Description    : DFU status OUT routine.
+* Description    : DFU status OUT routine. A received block is handed over to
+*                  the main loop, which erases or programs it while the host
+*                  sends the next one.
 * Input          : None.
 * Output         : None.
 * Return         : None.
@@ -233,6 +234,7 @@ void DFU_Status_Out(void)
 {
 	DEVICE_INFO *pInfo = &Device_Info;
 	uint32_t Addr;
+	uint16_t Status = MAL_OK;
 
 	if (pInfo->USBbRequest == DFU_GETSTATUS) {
 		if (DeviceState == STATE_dfuDNBUSY) {
@@ -252,27 +254,67 @@ void DFU_Status_Out(void)
 					Pointer += MAL_Buffer[2] << 8;
 					Pointer += MAL_Buffer[3] << 16;
 					Pointer += MAL_Buffer[4] << 24;
-					MAL_Erase(Pointer);
+					Status = MAL_Submit(MAL_ERASE, Pointer, 0);
+				}
+#ifdef DFU_COMPRESSED
+				else if ((MAL_Buffer[0] == CMD_COMPRESSED)
+					 && (wlength == 9)) {
+					/* Decoded length and CRC-32 of the image
+					   sent compressed to Pointer onward */
+					if (MAL_Complete() == MAL_BUSY) {
+						Status = MAL_BUSY;
+					} else {
+						uint32_t Length, Crc;
+
+						Length = MAL_Buffer[1];
+						Length += MAL_Buffer[2] << 8;
+						Length += MAL_Buffer[3] << 16;
+						Length += MAL_Buffer[4] << 24;
+						Crc = MAL_Buffer[5];
+						Crc += MAL_Buffer[6] << 8;
+						Crc += MAL_Buffer[7] << 16;
+						Crc += (uint32_t) MAL_Buffer[8] << 24;
+						DFU_LZ_Start(Pointer, Length, Crc);
+					}
 				}
+#endif /* DFU_COMPRESSED */
 			}
 
 			else if (wBlockNum > 1)	// Download Command
 			{
-				Addr =
-				    ((wBlockNum - 2) * wTransferSize) + Pointer;
-				MAL_Write(Addr, wlength);
+#ifdef DFU_COMPRESSED
+				if (DFU_LZ_Active()) {
+					/* In sequence, the block number unused */
+					Status = MAL_Submit(MAL_DECODE, Pointer,
+							    wlength);
+				} else
+#endif /* DFU_COMPRESSED */
+				{
+					Addr = ((wBlockNum - 2) * wTransferSize)
+					    + Pointer;
+					Status = MAL_Submit(MAL_WRITE, Addr,
+							    wlength);
+				}
 			}
-			wlength = 0;
-			wBlockNum = 0;
 
 			DeviceState = STATE_dfuDNLOAD_SYNC;
 			DeviceStatus[4] = DeviceState;
 			DeviceStatus[1] = 0;
 			DeviceStatus[2] = 0;
 			DeviceStatus[3] = 0;
+
+			if (Status == MAL_BUSY) {
+				/* The previous block is still being written: keep
+				   this one, it is handed over on a next GETSTATUS */
+				return;
+			}
+			wlength = 0;
+			wBlockNum = 0;
 			return;
 		} else if (DeviceState == STATE_dfuMANIFEST) {	/* Manifestation in progress */
-			DFU_write_crc();
+			/* Completed by DFU_Manifest_Process once the media is
+			   idle, without waiting for another GETSTATUS */
+			Manifest_Pending = 1;
 			return;
 		}
 	}
@@ -294,11 +336,16 @@ RESULT DFU_Data_Setup(uint8_t RequestNo)
 	if (Type_Recipient == (CLASS_REQUEST | INTERFACE_RECIPIENT)) {
 		if (RequestNo == DFU_UPLOAD && (DeviceState == STATE_dfuIDLE
 						|| DeviceState ==
-						STATE_dfuUPLOAD_IDLE)) {
+						STATE_dfuUPLOAD_IDLE)
+		    && (MAL_Complete() != MAL_BUSY)) {	/* No read while programming or erasing */
 			CopyRoutine = UPLOAD;
 		} else if (RequestNo == DFU_DNLOAD
 			   && (DeviceState == STATE_dfuIDLE
 			       || DeviceState == STATE_dfuDNLOAD_IDLE)) {
+			if (DeviceState == STATE_dfuIDLE) {
+				/* New download: no erase left from a previous one */
+				MAL_Restart();
+			}
 			DeviceState = STATE_dfuDNLOAD_SYNC;
 			CopyRoutine = DNLOAD;
 		} else if (RequestNo == DFU_GETSTATE) {
@@ -396,6 +443,10 @@ RESULT DFU_NoData_Setup(uint8_t RequestNo)
 				DeviceStatus[5] = 0;	/*iString */
 				wBlockNum = 0;
 				wlength = 0;
+				MAL_Restart();
+#ifdef DFU_COMPRESSED
+				DFU_LZ_Stop();
+#endif /* DFU_COMPRESSED */
 			}
 			return USB_SUCCESS;
 		}
@@ -440,7 +491,7 @@ uint8_t *DFU_GetStringDescriptor(uint16_t Length)
 {
 	uint8_t wValue0 = pInformation->USBwValue0;
 
-	if (wValue0 > 8) {
+	if (wValue0 > DFU_STRING_STATUS_INDEX) {
 		return NULL;
 	} else {
 		return Standard_GetDescriptorData(Length,
@@ -513,11 +564,19 @@ uint8_t *UPLOAD(uint16_t Length)
 		MAL_Buffer[0] = CMD_GETCOMMANDS;
 		MAL_Buffer[1] = CMD_SETADDRESSPOINTER;
 		MAL_Buffer[2] = CMD_ERASE;
+#ifdef DFU_COMPRESSED
+		MAL_Buffer[3] = CMD_COMPRESSED;
 
+		if (Length == 0) {
+			pInformation->Ctrl_Info.Usb_wLength = 4;
+			return NULL;
+		}
+#else
 		if (Length == 0) {
 			pInformation->Ctrl_Info.Usb_wLength = 3;
 			return NULL;
 		}
+#endif /* DFU_COMPRESSED */
 
 		return (&MAL_Buffer[0]);
 	} else if (wBlockNum > 1) {
@@ -617,10 +676,15 @@ uint8_t *GETSTATUS(uint16_t Length)
 		if (wlength != 0) {
 			DeviceState = STATE_dfuDNBUSY;
 			DeviceStatus[4] = DeviceState;
-			if ((wBlockNum == 0) && (MAL_Buffer[0] == CMD_ERASE)) {
-				MAL_GetStatus(Pointer, 0, DeviceStatus);
+			if ((wBlockNum > 1) || ((wBlockNum == 0)
+						&& (MAL_Buffer[0] == CMD_ERASE))) {
+				/* Handed over at once, unless the media is still
+				   busy with the previous block */
+				MAL_GetStatus(DeviceStatus);
 			} else {
-				MAL_GetStatus(Pointer, 1, DeviceStatus);
+				DeviceStatus[1] = 0;
+				DeviceStatus[2] = 0;
+				DeviceStatus[3] = 0;
 			}
 		} else {	/* (wlength==0) */
 
@@ -639,6 +703,10 @@ uint8_t *GETSTATUS(uint16_t Length)
 			DeviceStatus[1] = 1;	/*bwPollTimeout = 1ms */
 			DeviceStatus[2] = 0;
 			DeviceStatus[3] = 0;
+			if (MAL_Complete() == MAL_BUSY) {
+				/* Until the last block is written */
+				MAL_GetStatus(DeviceStatus);
+			}
 			//break;
 		} else if (Manifest_State == Manifest_complete
 			   && Config_Descriptor.Descriptor[20]
@@ -662,9 +730,41 @@ uint8_t *GETSTATUS(uint16_t Length)
 		return (&(DeviceStatus[0]));
 }
 
+/*******************************************************************************
+* Function Name  : DFU_Manifest_Process.
+* Description    : Complete the manifestation from the main loop: once the
+*                  last block is written, erase the pages no block was
+*                  written to, report the pages left untouched, then verify
+*                  and reset. A device that is not manifestation tolerant
+*                  gets no further GETSTATUS.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void DFU_Manifest_Process(void)
+{
+	if ((Manifest_Pending == 0) || (MAL_Complete() == MAL_BUSY)) {
+		return;
+	}
+
+	if (MAL_GetDeferred() != 0) {
+		/* Run by MAL_Process, completion checked on a next call */
+		MAL_Submit(MAL_FLUSH, INTERNAL_FLASH_BASE, MAL_GetDeferred());
+		return;
+	}
+
+	/* Media idle: the count is final */
+	DFU_SetStatusString(MAL_GetSkipped());
+	DeviceStatus[5] = DFU_STRING_STATUS_INDEX;	/*iString */
+
+	Manifest_Pending = 0;
+	DFU_write_crc();
+}
+
 /*******************************************************************************
 * Function Name  : DFU_write_crc.
-* Description    : DFU Write CRC routine.
+* Description    : DFU Write CRC routine. A compressed image is verified
+*                  first, an error reported instead of the manifestation.
 * Input          : None.
 * Output         : None.
 * Return         : None.
@@ -673,6 +773,19 @@ void DFU_write_crc(void)
 {
 	Manifest_State = Manifest_complete;
 
+#ifdef DFU_COMPRESSED
+	if (DFU_LZ_Check() != MAL_OK) {
+		/* Compressed image incomplete or corrupted */
+		DeviceState = STATE_dfuERROR;
+		DeviceStatus[0] = STATUS_ERRVERIFY;
+		DeviceStatus[4] = DeviceState;
+		DeviceStatus[1] = 0;
+		DeviceStatus[2] = 0;
+		DeviceStatus[3] = 0;
+		return;
+	}
+#endif /* DFU_COMPRESSED */
+
 	if (Config_Descriptor.Descriptor[20] & 0x04) {
 		DeviceState = STATE_dfuMANIFEST_SYNC;
 		DeviceStatus[4] = DeviceState;
@@ -693,4 +806,26 @@ void DFU_write_crc(void)
 	}
 }
 
+/*******************************************************************************
+* Function Name  : DFU_SetStatusString.
+* Description    : Write a count in the last 4 digits of the status string.
+* Input          : Count: value, 9999 at most shown.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void DFU_SetStatusString(uint32_t Count)
+{
+	uint8_t idx = 0;
+
+	if (Count > 9999) {
+		Count = 9999;
+	}
+
+	for (idx = 0; idx < 4; idx++) {
+		DFU_StringStatus[DFU_SIZ_STRING_STATUS - 2 - (2 * idx)] =
+		    '0' + (Count % 10);
+		Count /= 10;
+	}
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
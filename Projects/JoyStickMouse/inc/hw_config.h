@@ -37,7 +37,14 @@
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /* Exported define -----------------------------------------------------------*/
-#define CURSOR_STEP     20
+/* The joystick is sampled at each USB frame (SOF) */
+#define JOY_FRAMES_PER_S           1000
+
+/* Acceleration curve: cursor speed in pixels per second against the time the
+   same direction has been held, one entry per CURSOR_ACCEL_STEP ms. The last
+   entry holds from then on */
+#define CURSOR_ACCEL_STEP          100
+#define CURSOR_SPEED_CURVE         { 150, 300, 450, 625, 800, 1000, 1200 }
 
 #define DOWN            2
 #define LEFT            3
@@ -52,7 +59,9 @@ void Enter_LowPowerMode(void);
 void Leave_LowPowerMode(void);
 void USB_Interrupts_Config(void);
 void USB_Cable_Config(FunctionalState NewState);
-void Joystick_Send(uint8_t Keys);
+void Joystick_Init(void);
+void Joystick_Sample(void);
+void Joystick_Send(void);
 uint8_t JoyState(void);
 void Get_SerialNum(void);
 
@@ -38,6 +38,12 @@
 ErrorStatus HSEStartUpStatus;
 EXTI_InitTypeDef EXTI_InitStructure;
 
+/* Joystick state, only used from the USB interrupt */
+static uint8_t Joy_Keys = 0;	/* direction sampled in the last frame */
+static uint32_t Joy_Held = 0;	/* frames it has been held, up to the curve end */
+static int32_t Joy_Motion_X = 0;	/* motion not reported yet, in */
+static int32_t Joy_Motion_Y = 0;	/* 1/JOY_FRAMES_PER_S pixels */
+
 /* Extern variables ----------------------------------------------------------*/
 extern __IO uint8_t PrevXferComplete;
 
@@ -425,37 +431,104 @@ uint8_t JoyState(void)
 }
 
 /*******************************************************************************
-* Function Name : Joystick_Send.
-* Description   : prepares buffer to be sent containing Joystick event infos.
-* Input         : Keys: keys received from terminal.
+* Function Name : Joystick_Init.
+* Description   : Drop the pending motion and free EP1, called on USB reset.
+* Input         : None.
 * Output        : None.
 * Return value  : None.
 *******************************************************************************/
-void Joystick_Send(uint8_t Keys)
+void Joystick_Init(void)
 {
-	uint8_t Mouse_Buffer[4] = { 0, 0, 0, 0 };
-	int8_t X = 0, Y = 0;
+	Joy_Keys = 0;
+	Joy_Held = 0;
+	Joy_Motion_X = 0;
+	Joy_Motion_Y = 0;
+	PrevXferComplete = 1;
+}
+
+/*******************************************************************************
+* Function Name : Joystick_Sample.
+* Description   : Add one frame of cursor motion for the direction pressed,
+*                 at the speed the acceleration curve gives for the time it
+*                 has been held. Called on each SOF.
+* Input         : None.
+* Output        : None.
+* Return value  : None.
+*******************************************************************************/
+void Joystick_Sample(void)
+{
+	static const uint16_t Cursor_Speed[] = CURSOR_SPEED_CURVE;
+	uint8_t Keys = JoyState();
+	uint32_t index;
+
+	/* A new direction starts again from the bottom of the curve */
+	if (Keys != Joy_Keys) {
+		Joy_Keys = Keys;
+		Joy_Held = 0;
+	}
+
+	index = Joy_Held / CURSOR_ACCEL_STEP;
+	if (index < (sizeof(Cursor_Speed) / sizeof(Cursor_Speed[0])) - 1) {
+		Joy_Held++;
+	} else {
+		index = (sizeof(Cursor_Speed) / sizeof(Cursor_Speed[0])) - 1;
+	}
 
 	switch (Keys) {
 	case JOY_LEFT:
-		X -= CURSOR_STEP;
+		Joy_Motion_X -= Cursor_Speed[index];
 		break;
 	case JOY_RIGHT:
-
-		X += CURSOR_STEP;
+		Joy_Motion_X += Cursor_Speed[index];
 		break;
 	case JOY_UP:
-		Y -= CURSOR_STEP;
+		Joy_Motion_Y -= Cursor_Speed[index];
 		break;
 	case JOY_DOWN:
-		Y += CURSOR_STEP;
+		Joy_Motion_Y += Cursor_Speed[index];
 		break;
 	default:
+		break;
+	}
+
+	Joystick_Send();
+}
+
+/*******************************************************************************
+* Function Name : Joystick_Send.
+* Description   : Load the whole pixels of motion accumulated since the last
+*                 report in EP1 when it is free. The fractions are kept for
+*                 the next report. Called on each SOF and on EP1 IN completion,
+*                 so all the motion of a polling interval goes in one report.
+* Input         : None.
+* Output        : None.
+* Return value  : None.
+*******************************************************************************/
+void Joystick_Send(void)
+{
+	uint8_t Mouse_Buffer[4] = { 0, 0, 0, 0 };
+	int32_t X, Y;
+
+	if (!PrevXferComplete) {
 		return;
 	}
+
+	X = Joy_Motion_X / JOY_FRAMES_PER_S;
+	Y = Joy_Motion_Y / JOY_FRAMES_PER_S;
+
+	if ((X == 0) && (Y == 0)) {
+		return;
+	}
+
+	/* The rest goes in the next report */
+	X = (X > 127) ? 127 : ((X < -127) ? -127 : X);
+	Y = (Y > 127) ? 127 : ((Y < -127) ? -127 : Y);
+	Joy_Motion_X -= X * JOY_FRAMES_PER_S;
+	Joy_Motion_Y -= Y * JOY_FRAMES_PER_S;
+
 	/* prepare buffer to send */
-	Mouse_Buffer[1] = X;
-	Mouse_Buffer[2] = Y;
+	Mouse_Buffer[1] = (int8_t) X;
+	Mouse_Buffer[2] = (int8_t) Y;
 
 	/* Reset the control token to inform upper layer that a transfer is ongoing */
 	PrevXferComplete = 0;
@@ -465,7 +538,6 @@ void Joystick_Send(uint8_t Keys)
 
 	/* Enable endpoint for transmission */
 	SetEPTxValid(ENDP1);
-
 }
 
 /*******************************************************************************
@@ -57,13 +57,10 @@ int main(void)
 
 	USB_Init();
 
+	/* The joystick is sampled and reported from the USB interrupt at each
+	   frame, sleep in between */
 	while (1) {
-
-		if (bDeviceState == CONFIGURED) {
-			if ((JoyState() != 0) && (PrevXferComplete)) {
-				Joystick_Send(JoyState());
-			}
-		}
+		__WFI();
 	}
 }
 
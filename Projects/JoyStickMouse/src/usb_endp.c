@@ -29,6 +29,7 @@
 #include "hw_config.h"
 #include "usb_lib.h"
 #include "usb_istr.h"
+#include "usb_pwr.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -50,6 +51,23 @@ void EP1_IN_Callback(void)
 	/* Set the transfer complete token to inform upper layer that the current 
 	   transfer has been complete */
 	PrevXferComplete = 1;
+
+	/* Send the motion accumulated during the transfer */
+	Joystick_Send();
+}
+
+/*******************************************************************************
+* Function Name  : SOF_Callback
+* Description    : Sample the joystick once per frame.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void SOF_Callback(void)
+{
+	if (bDeviceState == CONFIGURED) {
+		Joystick_Sample();
+	}
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -166,6 +166,9 @@ void Joystick_Reset(void)
 	SetEPRxStatus(ENDP1, EP_RX_DIS);
 	SetEPTxStatus(ENDP1, EP_TX_NAK);
 
+	/* No motion pending, EP1 free */
+	Joystick_Init();
+
 	/* Set this device to response on default address */
 	SetDeviceAddress(0);
 	bDeviceState = ATTACHED;
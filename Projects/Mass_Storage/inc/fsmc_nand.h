@@ -31,6 +31,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f10x.h"
+#include "nand_ecc.h"
 
 /* Exported types ------------------------------------------------------------*/
 typedef struct {
@@ -77,6 +78,8 @@ typedef struct {
 #define NAND_BUSY                  ((uint32_t)0x00000000)
 #define NAND_ERROR                 ((uint32_t)0x00000001)
 #define NAND_READY                 ((uint32_t)0x00000040)
+#define NAND_ECC_BITFLIP           ((uint32_t)0x00000800)	/* corrected bit error */
+#define NAND_ECC_FAILURE           ((uint32_t)0x00001000)	/* uncorrectable page */
 
 /* FSMC NAND memory parameters */
 #define NAND_PAGE_SIZE             ((uint16_t)0x0200)	/* 512 bytes per page w/o Spare Area */
@@ -85,6 +88,15 @@ typedef struct {
 #define NAND_SPARE_AREA_SIZE       ((uint16_t)0x0010)	/* last 16 bytes as spare area */
 #define NAND_MAX_ZONE              ((uint16_t)0x0004)	/* 4 zones of 1024 block */
 
+/* Page ECC: computed by the FSMC ECC unit, or by the table driven Hamming
+   code of nand_ecc.c when NAND_SW_ECC is defined (compiler command line).
+   The code is stored inverted in the spare area so that an erased page reads
+   back as valid */
+#ifndef NAND_SW_ECC
+#define NAND_HW_ECC
+#endif /* NAND_SW_ECC */
+#define NAND_SPARE_ECC_OFFSET      6	/* after the FTL logical index and status */
+
 /* FSMC NAND memory address computation */
 #define ADDR_1st_CYCLE(ADDR)       (uint8_t)((ADDR)& 0xFF)	/* 1st addressing cycle */
 #define ADDR_2nd_CYCLE(ADDR)       (uint8_t)(((ADDR)& 0xFF00) >> 8)	/* 2nd addressing cycle */
@@ -34,8 +34,23 @@
 /* Exported constants --------------------------------------------------------*/
 #define MAL_OK   0
 #define MAL_FAIL 1
+#define MAL_BUSY 2
 #define MAX_LUN  1
 
+/* Asynchronous transfers: MAL_SLOTS requests may be outstanding, each one
+   moving up to MAL_MAX_BURST blocks of 512 bytes */
+#define MAL_SLOTS      2
+#ifndef MAL_MAX_BURST
+#ifdef USE_STM3210E_EVAL
+#define MAL_MAX_BURST  4
+#else
+#define MAL_MAX_BURST  1
+#endif
+#endif /* MAL_MAX_BURST */
+
+#define MAL_READ       0
+#define MAL_WRITE      1
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 
@@ -45,6 +60,12 @@ uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t * Readbuff,
 		  uint16_t Transfer_Length);
 uint16_t MAL_Write(uint8_t lun, uint32_t Memory_Offset, uint32_t * Writebuff,
 		   uint16_t Transfer_Length);
+uint16_t MAL_GetMaxBlocks(uint8_t lun);
+uint16_t MAL_Submit(uint8_t lun, uint8_t Slot, uint8_t Dir,
+		    uint32_t Memory_Offset, uint32_t * Buff,
+		    uint16_t Transfer_Length);
+uint16_t MAL_Complete(uint8_t Slot);
+void MAL_Process(void);
 #endif /* __MASS_MAL_H */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -41,6 +41,7 @@
 void Write_Memory(uint8_t lun, uint32_t Memory_Offset,
 		  uint32_t Transfer_Length);
 void Read_Memory(uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length);
+void Memory_Resume(void);
 #endif /* __memory_H */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
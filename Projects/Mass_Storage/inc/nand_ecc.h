@@ -0,0 +1,58 @@
+/**
+  ******************************************************************************
+  * @file    nand_ecc.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for nand_ecc.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NAND_ECC_H
+#define __NAND_ECC_H
+
+/* Includes ------------------------------------------------------------------*/
+/* Only standard types are used so that the ECC kernel can be built on a host */
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* ECC block: one 512 bytes page protected by a 24 bits Hamming code, laid out
+   like the FSMC ECCR register (ECCPageSize_512Bytes): bit 2n holds the line or
+   column parity P' and bit 2n+1 the parity P for address bit n */
+#define NAND_ECC_BLOCK_SIZE        512
+#define NAND_ECC_MASK              ((uint32_t)0x00FFFFFF)
+
+/* ECC correction status */
+#define NAND_ECC_NO_ERROR          0
+#define NAND_ECC_CORRECTED         1	/* one data bit flipped back */
+#define NAND_ECC_CODE_ERROR        2	/* the stored ECC itself was hit */
+#define NAND_ECC_UNCORRECTABLE     3	/* two or more bits in error */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+uint32_t NAND_ECC_Calculate(const uint8_t * pBuffer);
+uint32_t NAND_ECC_Correct(uint8_t * pBuffer, uint32_t StoredECC,
+			  uint32_t ComputedECC);
+
+#endif /* __NAND_ECC_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
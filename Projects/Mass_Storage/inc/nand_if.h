@@ -41,8 +41,17 @@
 #define VALID_BLOCK (1 << 14 )
 #define USED_BLOCK  (1 << 15 )
 
+/* Set in the spare logical index of a block filled by NAND_RetireBlock: if a
+   reset leaves it and the worn block both claiming the logical block,
+   NAND_BuildLUT keeps the untagged one */
+#define COPY_BLOCK  (1 << 14 )
+
 #define MAX_PHY_BLOCKS_PER_ZONE  1024
 #define MAX_LOG_BLOCKS_PER_ZONE  1000
+
+/* Corrected ECC errors seen on a block before its data is moved away and the
+   block is marked bad */
+#define NAND_ECC_RETIRE_THRESHOLD  4
 /* Private Structures---------------------------------------------------------*/
 typedef struct __SPARE_AREA {
 	uint16_t LogicalIndex;
@@ -89,6 +89,8 @@
 #define ADDRESS_OUT_OF_RANGE                        0x21
 #define MEDIUM_NOT_PRESENT 			    0x3A
 #define MEDIUM_HAVE_CHANGED			    0x28
+#define WRITE_FAULT                                 0x03
+#define UNRECOVERED_READ_ERROR                      0x11
 
 #define READ_FORMAT_CAPACITY_DATA_LEN               0x0C
 #define READ_CAPACITY10_DATA_LEN                    0x08
@@ -41,6 +41,11 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
+static void FSMC_NAND_ECCStart(void);
+static uint32_t FSMC_NAND_ECCGet(uint8_t * pPage);
+static void FSMC_NAND_WritePageSpare(uint32_t ECC);
+static uint32_t FSMC_NAND_ReadPageSpare(void);
+
 /* Private functions ---------------------------------------------------------*/
 /*******************************************************************************
 * Function Name  : FSMC_NAND_Init
@@ -97,7 +102,8 @@ void FSMC_NAND_Init(void)
 	FSMC_NANDInitStructure.FSMC_Bank = FSMC_Bank2_NAND;
 	FSMC_NANDInitStructure.FSMC_Waitfeature = FSMC_Waitfeature_Enable;
 	FSMC_NANDInitStructure.FSMC_MemoryDataWidth = FSMC_MemoryDataWidth_8b;
-	FSMC_NANDInitStructure.FSMC_ECC = FSMC_ECC_Enable;
+	/* ECC is enabled page by page, see FSMC_NAND_ECCStart */
+	FSMC_NANDInitStructure.FSMC_ECC = FSMC_ECC_Disable;
 	FSMC_NANDInitStructure.FSMC_ECCPageSize = FSMC_ECCPageSize_512Bytes;
 	FSMC_NANDInitStructure.FSMC_TCLRSetupTime = 0x00;
 	FSMC_NANDInitStructure.FSMC_TARSetupTime = 0x00;
@@ -138,6 +144,7 @@ void FSMC_NAND_ReadID(NAND_IDTypeDef * NAND_ID)
 /******************************************************************************
 * Function Name  : FSMC_NAND_WriteSmallPage
 * Description    : This routine is for writing one or several 512 Bytes Page size.
+*                  The page ECC is programmed in the spare area of each page.
 * Input          : - pBuffer: pointer on the Buffer containing data to be written   
 *                  - Address: First page address
 *                  - NumPageToWrite: Number of page to write  
@@ -175,11 +182,16 @@ uint32_t FSMC_NAND_WriteSmallPage(uint8_t * pBuffer, NAND_ADDRESS Address,
 		size = NAND_PAGE_SIZE + (NAND_PAGE_SIZE * numpagewritten);
 
 		/* Write data */
+		FSMC_NAND_ECCStart();
 		for (; index < size; index++) {
 			*(__IO uint8_t *) (Bank_NAND_ADDR | DATA_AREA) =
 			    pBuffer[index];
 		}
 
+		/* Write the page ECC in the same program operation */
+		FSMC_NAND_WritePageSpare(FSMC_NAND_ECCGet
+					 (pBuffer + size - NAND_PAGE_SIZE));
+
 		*(__IO uint8_t *) (Bank_NAND_ADDR | CMD_AREA) =
 		    NAND_CMD_WRITE_TRUE1;
 
@@ -202,7 +214,8 @@ uint32_t FSMC_NAND_WriteSmallPage(uint8_t * pBuffer, NAND_ADDRESS Address,
 /******************************************************************************
 * Function Name  : FSMC_NAND_ReadSmallPage
 * Description    : This routine is for sequential read from one or several 
-*                  512 Bytes Page size.
+*                  512 Bytes Page size. Each page is checked against the ECC
+*                  stored in its spare area and single bit errors are fixed.
 * Input          : - pBuffer: pointer on the Buffer to fill  
 *                  - Address: First page address
 *                  - NumPageToRead: Number of page to read
@@ -214,13 +227,17 @@ uint32_t FSMC_NAND_WriteSmallPage(uint8_t * pBuffer, NAND_ADDRESS Address,
 *                  And the new status of the increment address operation. It can be:
 *                  - NAND_VALID_ADDRESS: When the new address is valid address
 *                  - NAND_INVALID_ADDRESS: When the new address is invalid address
+*                  Or'ed with the ECC status of the pages read:
+*                  - NAND_ECC_BITFLIP: at least one bit error was corrected
+*                  - NAND_ECC_FAILURE: at least one page is uncorrectable
 *******************************************************************************/
 uint32_t FSMC_NAND_ReadSmallPage(uint8_t * pBuffer, NAND_ADDRESS Address,
 				 uint32_t NumPageToRead)
 {
 	uint32_t index = 0x00, numpageread = 0x00, addressstatus =
 	    NAND_VALID_ADDRESS;
-	uint32_t status = NAND_READY, size = 0x00;
+	uint32_t status = NAND_READY, size = 0x00, eccstatus = 0x00;
+	uint32_t computedecc = 0x00;
 
 	while ((NumPageToRead != 0x0) && (addressstatus == NAND_VALID_ADDRESS)) {
 		/* Page Read command and page address */
@@ -241,11 +258,28 @@ uint32_t FSMC_NAND_ReadSmallPage(uint8_t * pBuffer, NAND_ADDRESS Address,
 		size = NAND_PAGE_SIZE + (NAND_PAGE_SIZE * numpageread);
 
 		/* Get Data into Buffer */
+		FSMC_NAND_ECCStart();
 		for (; index < size; index++) {
 			pBuffer[index] =
 			    *(__IO uint8_t *) (Bank_NAND_ADDR | DATA_AREA);
 		}
 
+		/* Check the page against the ECC that follows it */
+		computedecc = FSMC_NAND_ECCGet(pBuffer + size - NAND_PAGE_SIZE);
+		switch (NAND_ECC_Correct(pBuffer + size - NAND_PAGE_SIZE,
+					 FSMC_NAND_ReadPageSpare(),
+					 computedecc)) {
+		case NAND_ECC_CORRECTED:
+		case NAND_ECC_CODE_ERROR:
+			eccstatus |= NAND_ECC_BITFLIP;
+			break;
+		case NAND_ECC_UNCORRECTABLE:
+			eccstatus |= NAND_ECC_FAILURE;
+			break;
+		default:
+			break;
+		}
+
 		numpageread++;
 
 		NumPageToRead--;
@@ -256,7 +290,7 @@ uint32_t FSMC_NAND_ReadSmallPage(uint8_t * pBuffer, NAND_ADDRESS Address,
 
 	status = FSMC_NAND_GetStatus();
 
-	return (status | addressstatus);
+	return (status | addressstatus | eccstatus);
 }
 
 /******************************************************************************
@@ -521,4 +555,98 @@ uint32_t FSMC_NAND_AddressIncrement(NAND_ADDRESS * Address)
 	return (status);
 }
 
+/******************************************************************************
+* Function Name  : FSMC_NAND_ECCStart
+* Description    : Restarts the FSMC ECC computation before a page transfer.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void FSMC_NAND_ECCStart(void)
+{
+#ifdef NAND_HW_ECC
+	FSMC_NANDECCCmd(FSMC_Bank_NAND, ENABLE);
+#endif
+}
+
+/******************************************************************************
+* Function Name  : FSMC_NAND_ECCGet
+* Description    : Returns the ECC of the page just transferred, either from
+*                  the FSMC ECC unit or from the software Hamming code.
+* Input          : - pPage: pointer on the 512 bytes of the page
+* Output         : None
+* Return         : Page ECC (24 LSB)
+*******************************************************************************/
+static uint32_t FSMC_NAND_ECCGet(uint8_t * pPage)
+{
+#ifdef NAND_HW_ECC
+	uint32_t ecc = 0x00;
+
+	(void) pPage;		/* computed on the fly by the FSMC */
+
+	/* Wait for the last byte to leave the FIFO before sampling ECCR */
+	while (FSMC_GetFlagStatus(FSMC_Bank_NAND, FSMC_FLAG_FEMPT) == RESET) {
+	}
+	ecc = FSMC_GetECC(FSMC_Bank_NAND) & NAND_ECC_MASK;
+	FSMC_NANDECCCmd(FSMC_Bank_NAND, DISABLE);
+
+	return ecc;
+#else
+	return NAND_ECC_Calculate(pPage);
+#endif
+}
+
+/******************************************************************************
+* Function Name  : FSMC_NAND_WritePageSpare
+* Description    : Writes the spare area following the page data: FTL bytes
+*                  are left erased and the ECC is stored inverted.
+* Input          : - ECC: page ECC
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void FSMC_NAND_WritePageSpare(uint32_t ECC)
+{
+	uint32_t index = 0x00;
+	uint8_t data = 0xFF;
+
+	ECC = ~ECC;
+
+	for (index = 0; index < NAND_SPARE_AREA_SIZE; index++) {
+		data = 0xFF;
+		if ((index >= NAND_SPARE_ECC_OFFSET)
+		    && (index < NAND_SPARE_ECC_OFFSET + 3)) {
+			data =
+			    (uint8_t) (ECC >>
+				       (8 * (index - NAND_SPARE_ECC_OFFSET)));
+		}
+		*(__IO uint8_t *) (Bank_NAND_ADDR | DATA_AREA) = data;
+	}
+}
+
+/******************************************************************************
+* Function Name  : FSMC_NAND_ReadPageSpare
+* Description    : Reads the spare area following the page data.
+* Input          : None
+* Output         : None
+* Return         : ECC stored for the page (24 LSB)
+*******************************************************************************/
+static uint32_t FSMC_NAND_ReadPageSpare(void)
+{
+	uint32_t index = 0x00, ecc = 0x00;
+	uint8_t data = 0x00;
+
+	for (index = 0; index < NAND_SPARE_AREA_SIZE; index++) {
+		data = *(__IO uint8_t *) (Bank_NAND_ADDR | DATA_AREA);
+		if ((index >= NAND_SPARE_ECC_OFFSET)
+		    && (index < NAND_SPARE_ECC_OFFSET + 3)) {
+			ecc |=
+			    (uint32_t) data << (8 *
+						(index -
+						 NAND_SPARE_ECC_OFFSET));
+		}
+	}
+
+	return (~ecc & NAND_ECC_MASK);
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -42,7 +42,16 @@ __IO uint32_t Status = 0;
 SD_CardInfo mSDCardInfo;
 #endif
 
+/* Status of the asynchronous slots: MAL_OK, MAL_FAIL or MAL_BUSY */
+static __IO uint16_t MAL_SlotStatus[MAL_SLOTS];
+#ifdef USE_STM3210E_EVAL
+static SD_Request MAL_SDRequest[MAL_SLOTS];
+#endif
+
 /* Private function prototypes -----------------------------------------------*/
+#ifdef USE_STM3210E_EVAL
+static void MAL_SDComplete(SD_Request * req);
+#endif
 /* Private functions ---------------------------------------------------------*/
 /*******************************************************************************
 * Function Name  : MAL_Init
@@ -133,8 +142,11 @@ uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t * Readbuff,
 		break;
 #ifdef USE_STM3210E_EVAL
 	case 1:
-		NAND_Read(Memory_Offset, Readbuff, Transfer_Length);
-		;
+		/* uncorrectable ECC errors fail the read */
+		if (NAND_Read(Memory_Offset, Readbuff, Transfer_Length) !=
+		    NAND_OK) {
+			return MAL_FAIL;
+		}
 		break;
 #endif
 	default:
@@ -143,6 +155,121 @@ uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t * Readbuff,
 	return MAL_OK;
 }
 
+/*******************************************************************************
+* Function Name  : MAL_GetMaxBlocks
+* Description    : Number of blocks a single MAL_Submit may move on this media.
+* Input          : - lun: logical unit.
+* Output         : None
+* Return         : Number of blocks.
+*******************************************************************************/
+uint16_t MAL_GetMaxBlocks(uint8_t lun)
+{
+	/* the NAND write state machine expects one page per call */
+	if (lun == 0) {
+		return MAL_MAX_BURST;
+	}
+	return 1;
+}
+
+/*******************************************************************************
+* Function Name  : MAL_Submit
+* Description    : Start a read or a write on one of the MAL_SLOTS slots. On
+*                  the SDIO card the request is queued and completes under
+*                  interrupt, other media are accessed synchronously.
+* Input          : - lun: logical unit.
+*                  - Slot: slot number, 0 to MAL_SLOTS - 1.
+*                  - Dir: MAL_READ or MAL_WRITE.
+*                  - Memory_Offset: byte address on the media.
+*                  - Buff: word aligned buffer, untouched until completion.
+*                  - Transfer_Length: bytes to move, multiple of 512.
+* Output         : None
+* Return         : MAL_OK if started or done, MAL_FAIL otherwise.
+*******************************************************************************/
+uint16_t MAL_Submit(uint8_t lun, uint8_t Slot, uint8_t Dir,
+		    uint32_t Memory_Offset, uint32_t * Buff,
+		    uint16_t Transfer_Length)
+{
+	/* a slot is reused only once its previous request is over */
+	while (MAL_Complete(Slot) == MAL_BUSY) {
+		MAL_Process();
+	}
+
+#ifdef USE_STM3210E_EVAL
+	if (lun == 0) {
+		MAL_SDRequest[Slot].Buffer = (uint8_t *) Buff;
+		MAL_SDRequest[Slot].Addr = Memory_Offset;
+		MAL_SDRequest[Slot].NumberOfBlocks = Transfer_Length / 512;
+		MAL_SDRequest[Slot].Write = Dir;
+		MAL_SDRequest[Slot].Callback = MAL_SDComplete;
+
+		MAL_SlotStatus[Slot] = MAL_BUSY;
+		if (SD_SubmitRequest(&MAL_SDRequest[Slot]) != SD_OK) {
+			MAL_SlotStatus[Slot] = MAL_FAIL;
+		}
+		return (MAL_SlotStatus[Slot] == MAL_FAIL) ? MAL_FAIL : MAL_OK;
+	}
+#endif /* USE_STM3210E_EVAL */
+
+	if (Dir == MAL_WRITE) {
+		MAL_SlotStatus[Slot] =
+		    MAL_Write(lun, Memory_Offset, Buff, Transfer_Length);
+	} else {
+		MAL_SlotStatus[Slot] =
+		    MAL_Read(lun, Memory_Offset, Buff, Transfer_Length);
+	}
+	return MAL_SlotStatus[Slot];
+}
+
+/*******************************************************************************
+* Function Name  : MAL_Complete
+* Description    : Non blocking check of the last request of a slot.
+* Input          : - Slot: slot number.
+* Output         : None
+* Return         : MAL_BUSY while running, then MAL_OK or MAL_FAIL.
+*******************************************************************************/
+uint16_t MAL_Complete(uint8_t Slot)
+{
+#ifdef USE_STM3210E_EVAL
+	if ((MAL_SlotStatus[Slot] == MAL_BUSY)
+	    && (MAL_SDRequest[Slot].State == SD_REQ_DONE)) {
+		MAL_SlotStatus[Slot] =
+		    (MAL_SDRequest[Slot].Status == SD_OK) ? MAL_OK : MAL_FAIL;
+	}
+#endif /* USE_STM3210E_EVAL */
+	return MAL_SlotStatus[Slot];
+}
+
+/*******************************************************************************
+* Function Name  : MAL_Process
+* Description    : Background processing of the asynchronous requests, to be
+*                  called periodically (the card busy phase raises no IRQ).
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void MAL_Process(void)
+{
+#ifdef USE_STM3210E_EVAL
+	SD_ProcessQueue();
+#endif /* USE_STM3210E_EVAL */
+}
+
+#ifdef USE_STM3210E_EVAL
+/*******************************************************************************
+* Function Name  : MAL_SDComplete
+* Description    : SDIO request completion, runs under the SDIO or DMA IRQ.
+*                  The USB interrupt is raised so that the transfer parked on
+*                  this slot resumes in the USB context.
+* Input          : - req: completed request.
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void MAL_SDComplete(SD_Request * req)
+{
+	NVIC_SetPendingIRQ(USB_LP_CAN1_RX0_IRQn);
+}
+#endif /* USE_STM3210E_EVAL */
+
 /*******************************************************************************
 * Function Name  : MAL_GetStatus
 * Description    : Get status
@@ -39,14 +39,28 @@
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#define SLOT_SIZE       (MAL_MAX_BURST * 512)
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-__IO uint32_t Block_Read_count = 0;
 __IO uint32_t Block_offset;
 __IO uint32_t Counter = 0;
 uint32_t Idx;
-uint32_t Data_Buffer[BULK_MAX_PACKET_SIZE * 2];	/* 512 bytes */
+/* While the host moves one slot over USB the media works on the other one */
+uint32_t Data_Buffer[MAL_SLOTS][SLOT_SIZE / 4];
 uint8_t TransferState = TXFR_IDLE;
+
+static uint32_t Slot_Length[MAL_SLOTS];	/* bytes requested in each slot */
+static uint32_t Slot_Size;	/* bytes moved by one media request */
+static uint8_t Slot_Head;	/* slot being sent to or filled by the host */
+static uint8_t Slot_Pending;	/* written slots whose status is not checked */
+static uint8_t Memory_Lun;
+static uint32_t Media_Offset;	/* next media byte address to request */
+static uint32_t Media_Length;	/* bytes not yet requested from the media */
+static uint32_t Host_Length;	/* bytes not yet moved over USB */
+static uint16_t Write_Status;
+static __IO uint8_t Memory_Waiting = 0;	/* transfer parked on a busy slot */
+
 /* Extern variables ----------------------------------------------------------*/
 extern uint8_t Bulk_Data_Buff[BULK_MAX_PACKET_SIZE];	/* data buffer */
 extern uint16_t Data_Len;
@@ -57,6 +71,11 @@ extern uint32_t Mass_Memory_Size[2];
 extern uint32_t Mass_Block_Size[2];
 
 /* Private function prototypes -----------------------------------------------*/
+static void Read_Ahead(uint8_t slot);
+static void Read_Next(void);
+static void Write_Next(void);
+static void Memory_Drain(void);
+
 /* Extern function prototypes ------------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 
@@ -69,49 +88,25 @@ extern uint32_t Mass_Block_Size[2];
 *******************************************************************************/
 void Read_Memory(uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length)
 {
-	static uint32_t Offset, Length;
+	uint8_t slot;
 
 	if (TransferState == TXFR_IDLE) {
-		Offset = Memory_Offset * Mass_Block_Size[lun];
-		Length = Transfer_Length * Mass_Block_Size[lun];
+		Memory_Lun = lun;
+		Media_Offset = Memory_Offset * Mass_Block_Size[lun];
+		Media_Length = Transfer_Length * Mass_Block_Size[lun];
+		Host_Length = Media_Length;
+		Slot_Head = 0;
+		Block_offset = 0;
 		TransferState = TXFR_ONGOING;
-	}
 
-	if (TransferState == TXFR_ONGOING) {
-		if (!Block_Read_count) {
-			MAL_Read(lun,
-				 Offset, Data_Buffer, Mass_Block_Size[lun]);
-
-			USB_SIL_Write(EP1_IN, (uint8_t *) Data_Buffer,
-				      BULK_MAX_PACKET_SIZE);
-
-			Block_Read_count =
-			    Mass_Block_Size[lun] - BULK_MAX_PACKET_SIZE;
-			Block_offset = BULK_MAX_PACKET_SIZE;
-		} else {
-			USB_SIL_Write(EP1_IN,
-				      (uint8_t *) Data_Buffer + Block_offset,
-				      BULK_MAX_PACKET_SIZE);
-
-			Block_Read_count -= BULK_MAX_PACKET_SIZE;
-			Block_offset += BULK_MAX_PACKET_SIZE;
+		/* keep every slot busy on the media from the start */
+		for (slot = 0; slot < MAL_SLOTS; slot++) {
+			Read_Ahead(slot);
 		}
-
-		SetEPTxCount(ENDP1, BULK_MAX_PACKET_SIZE);
-		SetEPTxStatus(ENDP1, EP_TX_VALID);
-		Offset += BULK_MAX_PACKET_SIZE;
-		Length -= BULK_MAX_PACKET_SIZE;
-
-		CSW.dDataResidue -= BULK_MAX_PACKET_SIZE;
-		Led_RW_ON();
 	}
-	if (Length == 0) {
-		Block_Read_count = 0;
-		Block_offset = 0;
-		Offset = 0;
-		Bot_State = BOT_DATA_IN_LAST;
-		TransferState = TXFR_IDLE;
-		Led_RW_OFF();
+
+	if (TransferState == TXFR_ONGOING) {
+		Read_Next();
 	}
 }
 
@@ -124,45 +119,238 @@ void Read_Memory(uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length)
 *******************************************************************************/
 void Write_Memory(uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length)
 {
-
-	static uint32_t W_Offset, W_Length;
-
-	uint32_t temp = Counter + 64;
+	uint32_t temp = Counter + Data_Len;
 
 	if (TransferState == TXFR_IDLE) {
-		W_Offset = Memory_Offset * Mass_Block_Size[lun];
-		W_Length = Transfer_Length * Mass_Block_Size[lun];
+		Memory_Lun = lun;
+		Media_Offset = Memory_Offset * Mass_Block_Size[lun];
+		Host_Length = Transfer_Length * Mass_Block_Size[lun];
+		Slot_Size = MAL_GetMaxBlocks(lun) * Mass_Block_Size[lun];
+		Slot_Head = 0;
+		Slot_Pending = 0;
+		Counter = 0;
+		temp = Data_Len;
+		Write_Status = MAL_OK;
 		TransferState = TXFR_ONGOING;
 	}
 
 	if (TransferState == TXFR_ONGOING) {
 
 		for (Idx = 0; Counter < temp; Counter++) {
-			*((uint8_t *) Data_Buffer + Counter) =
+			*((uint8_t *) Data_Buffer[Slot_Head] + Counter) =
 			    Bulk_Data_Buff[Idx++];
 		}
 
-		W_Offset += Data_Len;
-		W_Length -= Data_Len;
+		Host_Length -= Data_Len;
+		CSW.dDataResidue -= Data_Len;
+		Led_RW_ON();
 
-		if (!(W_Length % Mass_Block_Size[lun])) {
+		/* a full slot goes to the media while the next one is filled */
+		if ((Counter == Slot_Size) || (Host_Length == 0)) {
+			if (MAL_Submit(lun, Slot_Head, MAL_WRITE, Media_Offset,
+				       Data_Buffer[Slot_Head], Counter) != MAL_OK) {
+				Write_Status = MAL_FAIL;
+			}
+			Slot_Pending |= (1 << Slot_Head);
+			Media_Offset += Counter;
 			Counter = 0;
-			MAL_Write(lun,
-				  W_Offset - Mass_Block_Size[lun],
-				  Data_Buffer, Mass_Block_Size[lun]);
+			Slot_Head = (Slot_Head + 1) % MAL_SLOTS;
 		}
 
-		CSW.dDataResidue -= Data_Len;
-		SetEPRxStatus(ENDP2, EP_RX_VALID);	/* enable the next transaction */
-		Led_RW_ON();
+		if (Bot_State == BOT_CSW_Send) {
+			Host_Length = 0;
+		}
+		Write_Next();
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Memory_Resume
+* Description    : Resume a transfer parked on a slot still owned by the
+*                  media. Called in the USB interrupt context after each
+*                  USB_Istr(), which also runs on every SOF.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Memory_Resume(void)
+{
+	MAL_Process();
+
+	if ((Memory_Waiting == 0) || (TransferState != TXFR_ONGOING)) {
+		return;
 	}
 
-	if ((W_Length == 0) || (Bot_State == BOT_CSW_Send)) {
-		Counter = 0;
-		Set_CSW(CSW_CMD_PASSED, SEND_CSW_ENABLE);
+	if (Bot_State == BOT_DATA_IN) {
+		Read_Next();
+	} else if (Bot_State == BOT_DATA_OUT) {
+		Write_Next();
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Read_Ahead
+* Description    : Request the next chunk of a read into a free slot.
+* Input          : - slot: slot to fill.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Read_Ahead(uint8_t slot)
+{
+	uint32_t length;
+
+	if (Media_Length == 0) {
+		return;
+	}
+
+	length = MAL_GetMaxBlocks(Memory_Lun) * Mass_Block_Size[Memory_Lun];
+	if (length > Media_Length) {
+		length = Media_Length;
+	}
+
+	Slot_Length[slot] = length;
+	MAL_Submit(Memory_Lun, slot, MAL_READ, Media_Offset, Data_Buffer[slot],
+		   length);
+
+	Media_Offset += length;
+	Media_Length -= length;
+}
+
+/*******************************************************************************
+* Function Name  : Read_Next
+* Description    : Send the next IN packet once its slot has been read, or
+*                  park the transfer until then.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Read_Next(void)
+{
+	uint16_t status;
+
+	status = MAL_Complete(Slot_Head);
+	if (status == MAL_BUSY) {
+		Memory_Waiting = 1;
+		return;
+	}
+	Memory_Waiting = 0;
+
+	if (status != MAL_OK) {
+		Memory_Drain();
+		Bot_Abort(DIR_IN);
+		Set_Scsi_Sense_Data(Memory_Lun, MEDIUM_ERROR,
+				    UNRECOVERED_READ_ERROR);
+		Set_CSW(CSW_CMD_FAILED, SEND_CSW_DISABLE);
+		Led_RW_OFF();
+		return;
+	}
+
+	USB_SIL_Write(EP1_IN, (uint8_t *) Data_Buffer[Slot_Head] + Block_offset,
+		      BULK_MAX_PACKET_SIZE);
+	SetEPTxCount(ENDP1, BULK_MAX_PACKET_SIZE);
+	SetEPTxStatus(ENDP1, EP_TX_VALID);
+
+	Block_offset += BULK_MAX_PACKET_SIZE;
+	Host_Length -= BULK_MAX_PACKET_SIZE;
+	CSW.dDataResidue -= BULK_MAX_PACKET_SIZE;
+	Led_RW_ON();
+
+	/* the packet is in PMA now: the slot goes back to the media */
+	if (Block_offset == Slot_Length[Slot_Head]) {
+		Block_offset = 0;
+		Read_Ahead(Slot_Head);
+		Slot_Head = (Slot_Head + 1) % MAL_SLOTS;
+	}
+
+	if (Host_Length == 0) {
+		Block_offset = 0;
+		Bot_State = BOT_DATA_IN_LAST;
 		TransferState = TXFR_IDLE;
 		Led_RW_OFF();
 	}
 }
 
+/*******************************************************************************
+* Function Name  : Write_Next
+* Description    : Accept the next OUT packet when its slot is free again, or
+*                  send the CSW once every slot is written. EP2 is left NAK
+*                  meanwhile.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Write_Next(void)
+{
+	uint16_t status;
+	uint8_t slot;
+
+	if (Host_Length != 0) {
+		/* packets of the current slot can be taken until it is full */
+		if ((Counter == 0) && (Slot_Pending & (1 << Slot_Head))) {
+			status = MAL_Complete(Slot_Head);
+			if (status == MAL_BUSY) {
+				Memory_Waiting = 1;
+				return;
+			}
+			if (status != MAL_OK) {
+				Write_Status = MAL_FAIL;
+			}
+			Slot_Pending &= ~(1 << Slot_Head);
+		}
+		Memory_Waiting = 0;
+		SetEPRxStatus(ENDP2, EP_RX_VALID);	/* enable the next transaction */
+		return;
+	}
+
+	/* the status is only known once the media is done with every slot */
+	for (slot = 0; slot < MAL_SLOTS; slot++) {
+		if (!(Slot_Pending & (1 << slot))) {
+			continue;
+		}
+		status = MAL_Complete(slot);
+		if (status == MAL_BUSY) {
+			Memory_Waiting = 1;
+			return;
+		}
+		if (status != MAL_OK) {
+			Write_Status = MAL_FAIL;
+		}
+		Slot_Pending &= ~(1 << slot);
+	}
+	Memory_Waiting = 0;
+	Counter = 0;
+	TransferState = TXFR_IDLE;
+	Led_RW_OFF();
+
+	if (Write_Status != MAL_OK) {
+		Set_Scsi_Sense_Data(Memory_Lun, MEDIUM_ERROR, WRITE_FAULT);
+		Set_CSW(CSW_CMD_FAILED, SEND_CSW_ENABLE);
+	} else {
+		Set_CSW(CSW_CMD_PASSED, SEND_CSW_ENABLE);
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Memory_Drain
+* Description    : Wait for the slots still owned by the media after an error
+*                  so that the next command starts with free buffers.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Memory_Drain(void)
+{
+	uint8_t slot;
+
+	for (slot = 0; slot < MAL_SLOTS; slot++) {
+		while (MAL_Complete(slot) == MAL_BUSY) {
+			MAL_Process();
+		}
+	}
+	Memory_Waiting = 0;
+	Media_Length = 0;
+	Block_offset = 0;
+	TransferState = TXFR_IDLE;
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
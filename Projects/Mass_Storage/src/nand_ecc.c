@@ -0,0 +1,160 @@
+/**
+  ******************************************************************************
+  * @file    nand_ecc.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Table driven Hamming ECC for 512 bytes NAND pages, bit compatible
+  *          with the FSMC hardware ECC (1 bit correction, 2 bits detection).
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "nand_ecc.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#define ECC_LINE_BITS              9	/* byte address bits of a 512 bytes page */
+#define ECC_PAIR_PP_MASK           ((uint32_t)0x00555555)
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* For each byte value: bits 0..5 hold the column parities P1' P1 P2' P2 P4'
+   P4 in the ECCR order, bit 6 holds the parity of the whole byte */
+static const uint8_t ECC_ColumnTable[256] = {
+	0x00, 0x55, 0x56, 0x03, 0x59, 0x0C, 0x0F, 0x5A,
+	0x5A, 0x0F, 0x0C, 0x59, 0x03, 0x56, 0x55, 0x00,
+	0x65, 0x30, 0x33, 0x66, 0x3C, 0x69, 0x6A, 0x3F,
+	0x3F, 0x6A, 0x69, 0x3C, 0x66, 0x33, 0x30, 0x65,
+	0x66, 0x33, 0x30, 0x65, 0x3F, 0x6A, 0x69, 0x3C,
+	0x3C, 0x69, 0x6A, 0x3F, 0x65, 0x30, 0x33, 0x66,
+	0x03, 0x56, 0x55, 0x00, 0x5A, 0x0F, 0x0C, 0x59,
+	0x59, 0x0C, 0x0F, 0x5A, 0x00, 0x55, 0x56, 0x03,
+	0x69, 0x3C, 0x3F, 0x6A, 0x30, 0x65, 0x66, 0x33,
+	0x33, 0x66, 0x65, 0x30, 0x6A, 0x3F, 0x3C, 0x69,
+	0x0C, 0x59, 0x5A, 0x0F, 0x55, 0x00, 0x03, 0x56,
+	0x56, 0x03, 0x00, 0x55, 0x0F, 0x5A, 0x59, 0x0C,
+	0x0F, 0x5A, 0x59, 0x0C, 0x56, 0x03, 0x00, 0x55,
+	0x55, 0x00, 0x03, 0x56, 0x0C, 0x59, 0x5A, 0x0F,
+	0x6A, 0x3F, 0x3C, 0x69, 0x33, 0x66, 0x65, 0x30,
+	0x30, 0x65, 0x66, 0x33, 0x69, 0x3C, 0x3F, 0x6A,
+	0x6A, 0x3F, 0x3C, 0x69, 0x33, 0x66, 0x65, 0x30,
+	0x30, 0x65, 0x66, 0x33, 0x69, 0x3C, 0x3F, 0x6A,
+	0x0F, 0x5A, 0x59, 0x0C, 0x56, 0x03, 0x00, 0x55,
+	0x55, 0x00, 0x03, 0x56, 0x0C, 0x59, 0x5A, 0x0F,
+	0x0C, 0x59, 0x5A, 0x0F, 0x55, 0x00, 0x03, 0x56,
+	0x56, 0x03, 0x00, 0x55, 0x0F, 0x5A, 0x59, 0x0C,
+	0x69, 0x3C, 0x3F, 0x6A, 0x30, 0x65, 0x66, 0x33,
+	0x33, 0x66, 0x65, 0x30, 0x6A, 0x3F, 0x3C, 0x69,
+	0x03, 0x56, 0x55, 0x00, 0x5A, 0x0F, 0x0C, 0x59,
+	0x59, 0x0C, 0x0F, 0x5A, 0x00, 0x55, 0x56, 0x03,
+	0x66, 0x33, 0x30, 0x65, 0x3F, 0x6A, 0x69, 0x3C,
+	0x3C, 0x69, 0x6A, 0x3F, 0x65, 0x30, 0x33, 0x66,
+	0x65, 0x30, 0x33, 0x66, 0x3C, 0x69, 0x6A, 0x3F,
+	0x3F, 0x6A, 0x69, 0x3C, 0x66, 0x33, 0x30, 0x65,
+	0x00, 0x55, 0x56, 0x03, 0x59, 0x0C, 0x0F, 0x5A,
+	0x5A, 0x0F, 0x0C, 0x59, 0x03, 0x56, 0x55, 0x00
+};
+
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : NAND_ECC_Calculate
+* Description    : Computes the 24 bits Hamming code of one 512 bytes page.
+*                  The result has the same layout as the FSMC ECCR register.
+* Input          : - pBuffer: pointer on the 512 bytes page data.
+* Output         : None
+* Return         : ECC value (24 LSB).
+*******************************************************************************/
+uint32_t NAND_ECC_Calculate(const uint8_t * pBuffer)
+{
+	uint32_t index = 0, column = 0, line = 0, total = 0, ecc = 0, bit = 0;
+	uint8_t entry = 0;
+
+	/* Every byte contributes its value to the column parities and, when it
+	   has an odd number of ones, its address to the line parities */
+	for (index = 0; index < NAND_ECC_BLOCK_SIZE; index++) {
+		column ^= pBuffer[index];
+		if (ECC_ColumnTable[pBuffer[index]] & 0x40) {
+			line ^= index;
+		}
+	}
+
+	entry = ECC_ColumnTable[column];
+	total = (entry >> 6) & 0x01;
+	ecc = entry & 0x3F;
+
+	/* P' of a line bit is the parity of the odd bytes not addressed by it */
+	for (bit = 0; bit < ECC_LINE_BITS; bit++) {
+		if (line & (1 << bit)) {
+			ecc |= (uint32_t) 0x02 << (6 + 2 * bit);
+		}
+		if (((line >> bit) ^ total) & 0x01) {
+			ecc |= (uint32_t) 0x01 << (6 + 2 * bit);
+		}
+	}
+
+	return ecc;
+}
+
+/*******************************************************************************
+* Function Name  : NAND_ECC_Correct
+* Description    : Compares the stored and computed ECC of a page and fixes a
+*                  single bit error in place.
+* Input          : - pBuffer: pointer on the 512 bytes page data.
+*                  - StoredECC: ECC read back from the spare area.
+*                  - ComputedECC: ECC computed on the data just read.
+* Output         : None
+* Return         : NAND_ECC_NO_ERROR, NAND_ECC_CORRECTED, NAND_ECC_CODE_ERROR
+*                  or NAND_ECC_UNCORRECTABLE.
+*******************************************************************************/
+uint32_t NAND_ECC_Correct(uint8_t * pBuffer, uint32_t StoredECC,
+			  uint32_t ComputedECC)
+{
+	uint32_t syndrome = 0, address = 0, bit = 0;
+
+	syndrome = (StoredECC ^ ComputedECC) & NAND_ECC_MASK;
+
+	if (syndrome == 0) {
+		return NAND_ECC_NO_ERROR;
+	}
+
+	/* A single data bit error flips exactly one bit of every P/P' pair */
+	if (((syndrome ^ (syndrome >> 1)) & ECC_PAIR_PP_MASK) ==
+	    ECC_PAIR_PP_MASK) {
+		for (bit = 0; bit < 12; bit++) {
+			if ((syndrome >> (2 * bit + 1)) & 0x01) {
+				address |= (1 << bit);
+			}
+		}
+		pBuffer[address >> 3] ^= (uint8_t) (1 << (address & 0x07));
+		return NAND_ECC_CORRECTED;
+	}
+
+	/* A single flipped bit in the syndrome is an error in the code itself */
+	if ((syndrome & (syndrome - 1)) == 0) {
+		return NAND_ECC_CODE_ERROR;
+	}
+
+	return NAND_ECC_UNCORRECTABLE;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
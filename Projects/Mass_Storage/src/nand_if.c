@@ -45,8 +45,7 @@ BLOCK_STATE Block_State;
 NAND_ADDRESS wAddress, fAddress;
 uint16_t phBlock, LogAddress, Initial_Page, CurrentZone = 0;
 uint16_t Written_Pages = 0;
-
-uint16_t LUT[1024];		//Look Up Table Buffer
+uint8_t ECC_BitFlips[MAX_PHY_BLOCKS_PER_ZONE];	/* corrected errors per block */
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 static uint16_t NAND_CleanLUT(uint8_t ZoneNbr);
@@ -58,6 +57,10 @@ static uint16_t NAND_Copy(NAND_ADDRESS Address_Src, NAND_ADDRESS Address_Dest,
 			  uint16_t PageToCopy);
 static NAND_ADDRESS NAND_ConvertPhyAddress(uint32_t Address);
 static uint16_t NAND_BuildLUT(uint8_t ZoneNbr);
+static uint16_t NAND_RetireBlock(uint16_t LogBlock);
+static uint16_t NAND_Verify(NAND_ADDRESS Address);
+static uint32_t NAND_PageIndex(NAND_ADDRESS Address);
+static void NAND_SelectZone(uint16_t ZoneNbr);
 
 /*******************************************************************************
 * Function Name  : NAND_Init
@@ -71,6 +74,7 @@ uint16_t NAND_Init(void)
 	uint16_t Status = NAND_OK;
 
 	FSMC_NAND_Init();
+	NAND_SelectZone(0);
 	Status = NAND_BuildLUT(0);
 	Write_State = WRITE_IDLE;
 	return Status;
@@ -91,7 +95,7 @@ uint16_t NAND_Write(uint32_t Memory_Offset, uint32_t * Writebuff,
 
 	/*check Zone: if second zone is requested build second LUT */
 	if (wAddress.Zone != CurrentZone) {
-		CurrentZone = wAddress.Zone;
+		NAND_SelectZone(wAddress.Zone);
 		NAND_BuildLUT(CurrentZone);
 	}
 
@@ -219,7 +223,8 @@ uint16_t NAND_Write(uint32_t Memory_Offset, uint32_t * Writebuff,
 
 /*******************************************************************************
 * Function Name  : NAND_Read
-* Description    : Read sectors
+* Description    : Read sectors, blocks showing repeated corrected ECC errors
+*                  are retired once their data has been read back
 * Input          : None
 * Output         : None
 * Return         : Status
@@ -228,21 +233,48 @@ uint16_t NAND_Read(uint32_t Memory_Offset, uint32_t * Readbuff,
 		   uint16_t Transfer_Length)
 {
 	NAND_ADDRESS phAddress;
+	uint16_t LogBlock;
+	uint32_t status;
 
 	phAddress = NAND_GetAddress(Memory_Offset / 512);
 
 	if (phAddress.Zone != CurrentZone) {
-		CurrentZone = phAddress.Zone;
+		NAND_SelectZone(phAddress.Zone);
 		NAND_BuildLUT(CurrentZone);
 	}
 
 	if (LUT[phAddress.Block] & BAD_BLOCK) {
 		return NAND_FAIL;
 	} else {
+		LogBlock = phAddress.Block;
 		phAddress.Block =
 		    LUT[phAddress.Block] & ~(USED_BLOCK | VALID_BLOCK);
-		FSMC_NAND_ReadSmallPage((uint8_t *) Readbuff, phAddress,
-					Transfer_Length / 512);
+		status = FSMC_NAND_ReadSmallPage((uint8_t *) Readbuff,
+						 phAddress,
+						 Transfer_Length / 512);
+
+		if (status & NAND_ECC_FAILURE) {
+			return NAND_FAIL;
+		}
+
+		if ((status & NAND_ECC_BITFLIP)
+		    && (LUT[LogBlock] & USED_BLOCK)) {
+			if (ECC_BitFlips[phAddress.Block] < 0xFF) {
+				ECC_BitFlips[phAddress.Block]++;
+			}
+			/* Never relocate under an ongoing write sequence */
+			if ((ECC_BitFlips[phAddress.Block] >=
+			     NAND_ECC_RETIRE_THRESHOLD)
+			    && (Write_State == WRITE_IDLE)) {
+				/* The data read are corrected: on failure the
+				   block stays in place, retired on a next
+				   corrected read */
+				if (NAND_RetireBlock(LogBlock) != NAND_OK) {
+					ECC_BitFlips[phAddress.Block] =
+					    NAND_ECC_RETIRE_THRESHOLD - 1;
+				}
+			}
+		}
 	}
 	return NAND_OK;
 }
@@ -334,20 +366,32 @@ SPARE_AREA ReadSpareArea(uint32_t address)
 * Description    : Copy page
 * Input          : None
 * Output         : None
-* Return         : Status
+* Return         : NAND_FAIL if a page was uncorrectable or not programmed,
+*                  all the pages being copied anyway
 *******************************************************************************/
 static uint16_t NAND_Copy(NAND_ADDRESS Address_Src, NAND_ADDRESS Address_Dest,
 			  uint16_t PageToCopy)
 {
 	uint8_t Copybuff[512];
+	uint16_t Status = NAND_OK;
+	uint32_t status;
+
 	for (; PageToCopy > 0; PageToCopy--) {
-		FSMC_NAND_ReadSmallPage((uint8_t *) Copybuff, Address_Src, 1);
-		FSMC_NAND_WriteSmallPage((uint8_t *) Copybuff, Address_Dest, 1);
+		status = FSMC_NAND_ReadSmallPage((uint8_t *) Copybuff,
+						 Address_Src, 1);
+		if (status & NAND_ECC_FAILURE) {
+			Status = NAND_FAIL;
+		}
+		status = FSMC_NAND_WriteSmallPage((uint8_t *) Copybuff,
+						  Address_Dest, 1);
+		if (!(status & NAND_READY)) {
+			Status = NAND_FAIL;
+		}
 		FSMC_NAND_AddressIncrement(&Address_Src);
 		FSMC_NAND_AddressIncrement(&Address_Dest);
 	}
 
-	return NAND_OK;
+	return Status;
 }
 
 /*******************************************************************************
@@ -406,10 +450,11 @@ static uint16_t NAND_Write_Cleanup(void)
 				  NAND_BLOCK_SIZE - wAddress.Page);
 		}
 
-		/* assign logical address to new block */
+		/* assign logical address to new block, leaving the page ECC intact */
 		tempSpareArea[0] = LogAddress | USED_BLOCK;
-		tempSpareArea[1] = 0xFFFF;
-		tempSpareArea[2] = 0xFFFF;
+		for (Page_Back = 1; Page_Back < 8; Page_Back++) {
+			tempSpareArea[Page_Back] = 0xFFFF;
+		}
 
 		fAddress.Page = 0x00;
 		FSMC_NAND_WriteSpareArea((uint8_t *) tempSpareArea, fAddress,
@@ -421,8 +466,9 @@ static uint16_t NAND_Write_Cleanup(void)
 	} else {		/* unused block case */
 		/* assign logical address to the new used block */
 		tempSpareArea[0] = LogAddress | USED_BLOCK;
-		tempSpareArea[1] = 0xFFFF;
-		tempSpareArea[2] = 0xFFFF;
+		for (Page_Back = 1; Page_Back < 8; Page_Back++) {
+			tempSpareArea[Page_Back] = 0xFFFF;
+		}
 
 		wAddress.Page = 0x00;
 		FSMC_NAND_WriteSpareArea((uint8_t *) tempSpareArea, wAddress,
@@ -465,8 +511,9 @@ static NAND_ADDRESS NAND_ConvertPhyAddress(uint32_t Address)
 static uint16_t NAND_BuildLUT(uint8_t ZoneNbr)
 {
 
-	uint16_t pBadBlock, pCurrentBlock, pFreeBlock;
+	uint16_t pBadBlock, pCurrentBlock, pFreeBlock, pLogBlock;
 	SPARE_AREA SpareArea;
+	NAND_ADDRESS Address;
   /*****************************************************************************
                                   1st step : Init.
   *****************************************************************************/
@@ -500,10 +547,37 @@ static uint16_t NAND_BuildLUT(uint8_t ZoneNbr)
 				return NAND_FAIL;
 			}
 		} else if (SpareArea.LogicalIndex != 0xFFFF) {
+			pLogBlock = SpareArea.LogicalIndex & 0x3FF;
+
+			if (LUT[pLogBlock] & USED_BLOCK) {
+				/* Claimed twice: a retirement was cut before the
+				   worn block was erased. Keep the untagged block
+				   and erase the copy back to a free block */
+				Address.Zone = ZoneNbr;
+				Address.Page = 0;
+				Address.Block = LUT[pLogBlock] & 0x3FF;
+				LUT[pCurrentBlock] &= (uint16_t) (~FREE_BLOCK);
+
+				if (SpareArea.LogicalIndex & COPY_BLOCK) {
+					Address.Block = pCurrentBlock;
+				} else if (ReadSpareArea(NAND_PageIndex(Address)).
+					   LogicalIndex & COPY_BLOCK) {
+					LUT[pLogBlock] =
+					    (LUT[pLogBlock] & ~0x3FF) | pCurrentBlock;
+				} else {
+					/* Not a retirement: keep the first one */
+					pCurrentBlock++;
+					continue;
+				}
 
-			LUT[SpareArea.LogicalIndex & 0x3FF] |=
-			    pCurrentBlock | VALID_BLOCK | USED_BLOCK;
-			LUT[pCurrentBlock] &= (uint16_t) (~FREE_BLOCK);
+				if (FSMC_NAND_EraseBlock(Address) & NAND_READY) {
+					LUT[Address.Block] |= FREE_BLOCK;
+				}
+			} else {
+				LUT[pLogBlock] |=
+				    pCurrentBlock | VALID_BLOCK | USED_BLOCK;
+				LUT[pCurrentBlock] &= (uint16_t) (~FREE_BLOCK);
+			}
 		}
 		pCurrentBlock++;
 	}
@@ -530,6 +604,133 @@ static uint16_t NAND_BuildLUT(uint8_t ZoneNbr)
 	}
 	return NAND_OK;
 }
+
+/*******************************************************************************
+* Function Name  : NAND_RetireBlock
+* Description    : Move a logical block out of a physical block that keeps
+*                  needing ECC correction and mark the worn block bad. The
+*                  worn block is only erased once the copy is written, read
+*                  back and claims the logical block.
+* Input          : LogBlock: logical block in the current zone
+* Output         : None
+* Return         : NAND_OK, or NAND_FAIL with the logical block left in the
+*                  worn block
+*******************************************************************************/
+static uint16_t NAND_RetireBlock(uint16_t LogBlock)
+{
+	uint16_t tempSpareArea[8];
+	NAND_ADDRESS OldAddress, NewAddress;
+	SPARE_AREA SpareArea;
+	uint8_t index;
+
+	OldAddress.Zone = NewAddress.Zone = CurrentZone;
+	OldAddress.Page = NewAddress.Page = 0;
+	OldAddress.Block = LUT[LogBlock] & 0x3FF;
+	NewAddress.Block = NAND_GetFreeBlock();
+
+	/* the spare block must be a good block claimed by no logical block */
+	SpareArea = ReadSpareArea(NAND_PageIndex(NewAddress));
+	if ((NewAddress.Block == OldAddress.Block)
+	    || (SpareArea.LogicalIndex != 0xFFFF)
+	    || (SpareArea.DataStatus == 0) || (SpareArea.BlockStatus == 0)) {
+		return NAND_FAIL;
+	}
+
+	/* a write cut by a reset may have left data in it */
+	if (!(FSMC_NAND_EraseBlock(NewAddress) & NAND_READY)) {
+		return NAND_FAIL;
+	}
+
+	/* copy the whole block while its errors are still correctable, then
+	   read the copy back */
+	if ((NAND_Copy(OldAddress, NewAddress, NAND_BLOCK_SIZE) != NAND_OK)
+	    || (NAND_Verify(NewAddress) != NAND_OK)) {
+		FSMC_NAND_EraseBlock(NewAddress);
+		return NAND_FAIL;
+	}
+
+	for (index = 0; index < 8; index++) {
+		tempSpareArea[index] = 0xFFFF;
+	}
+	tempSpareArea[0] = LogBlock | USED_BLOCK | COPY_BLOCK;
+	if (!(FSMC_NAND_WriteSpareArea((uint8_t *) tempSpareArea, NewAddress, 1)
+	      & NAND_READY)) {
+		FSMC_NAND_EraseBlock(NewAddress);
+		return NAND_FAIL;
+	}
+
+	/* erase the old copy then flag it bad for NAND_BuildLUT. A reset
+	   before leaves both blocks claiming LogBlock, the copy being dropped */
+	FSMC_NAND_EraseBlock(OldAddress);
+	tempSpareArea[0] = 0xFFFF;
+	tempSpareArea[1] = 0x0000;	/* DataStatus */
+	tempSpareArea[2] = 0x0000;	/* BlockStatus */
+	if (!(FSMC_NAND_WriteSpareArea((uint8_t *) tempSpareArea, OldAddress, 1)
+	      & NAND_READY)) {
+		NAND_CleanLUT(CurrentZone);
+		return NAND_FAIL;
+	}
+
+	ECC_BitFlips[OldAddress.Block] = 0;
+	return NAND_CleanLUT(CurrentZone);
+}
+
+/*******************************************************************************
+* Function Name  : NAND_Verify
+* Description    : Read a block back, each page checked against its ECC
+* Input          : Address: block address, page 0
+* Output         : None
+* Return         : NAND_OK if no page needed correction, NAND_FAIL otherwise
+*******************************************************************************/
+static uint16_t NAND_Verify(NAND_ADDRESS Address)
+{
+	uint8_t Verifybuff[512];
+	uint16_t PageToRead;
+	uint32_t status;
+
+	for (PageToRead = NAND_BLOCK_SIZE; PageToRead > 0; PageToRead--) {
+		status = FSMC_NAND_ReadSmallPage(Verifybuff, Address, 1);
+		if (!(status & NAND_READY)
+		    || (status & (NAND_ECC_BITFLIP | NAND_ECC_FAILURE))) {
+			return NAND_FAIL;
+		}
+		FSMC_NAND_AddressIncrement(&Address);
+	}
+
+	return NAND_OK;
+}
+
+/*******************************************************************************
+* Function Name  : NAND_PageIndex
+* Description    : Physical page index of an address, as taken by
+*                  ReadSpareArea
+* Input          : Address: NAND address
+* Output         : None
+* Return         : Page index
+*******************************************************************************/
+static uint32_t NAND_PageIndex(NAND_ADDRESS Address)
+{
+	return ((Address.Zone * MAX_PHY_BLOCKS_PER_ZONE + Address.Block)
+		* NAND_BLOCK_SIZE) + Address.Page;
+}
+
+/*******************************************************************************
+* Function Name  : NAND_SelectZone
+* Description    : Switch the current zone, the ECC error counters only track
+*                  the blocks of the zone held in the LUT
+* Input          : ZoneNbr: new zone
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void NAND_SelectZone(uint16_t ZoneNbr)
+{
+	uint16_t index;
+
+	CurrentZone = ZoneNbr;
+	for (index = 0; index < MAX_PHY_BLOCKS_PER_ZONE; index++) {
+		ECC_BitFlips[index] = 0;
+	}
+}
 #endif
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -33,6 +33,7 @@
 #include "usb_lib.h"
 #include "usb_istr.h"
 #include "usb_pwr.h"
+#include "memory.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -188,6 +189,9 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
 #endif
 {
 	USB_Istr();
+
+	/* media requests completed meanwhile, this IRQ is also raised by them */
+	Memory_Resume();
 }
 
 #if defined(STM32F10X_HD) || defined(STM32F10X_XL) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
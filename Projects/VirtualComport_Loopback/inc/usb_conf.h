@@ -76,7 +76,7 @@
 /*#define WKUP_CALLBACK*/
 /*#define SUSP_CALLBACK*/
 /*#define RESET_CALLBACK*/
-/*#define SOF_CALLBACK*/
+#define SOF_CALLBACK
 /*#define ESOF_CALLBACK*/
 /* CTR service routines */
 /* associated to defined endpoints */
@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file    vcp_bench.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for vcp_bench.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __VCP_BENCH_H
+#define __VCP_BENCH_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "platform_config.h"
+#include "usb_type.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* Statistics returned by VCP_BENCH_GET_STATS, all fields little endian */
+typedef struct {
+	uint32_t Mode;		/* VCP_BENCH_SOURCE / VCP_BENCH_SINK flags */
+	uint32_t Frames;	/* SOFs seen since the start */
+	uint32_t InPackets;	/* packets sourced on EP1, taken by the host */
+	uint32_t InBytes;
+	uint32_t OutPackets;	/* packets sunk from EP3 */
+	uint32_t OutBytes;
+	uint32_t OutErrors;	/* sunk bytes not matching the pattern */
+	uint32_t MaxInPerFrame;	/* most EP1 packets taken in one frame */
+	uint32_t MaxOutPerFrame;	/* most EP3 packets seen in one frame */
+} VCP_BENCH_STATS;
+
+/* Exported constants --------------------------------------------------------*/
+/* Vendor requests, device recipient */
+#define VCP_BENCH_START             0x51	/* wValue: mode flags */
+#define VCP_BENCH_STOP              0x52
+#define VCP_BENCH_GET_STATS         0x53
+
+/* Mode flags */
+#define VCP_BENCH_SOURCE            0x01	/* device sends the pattern */
+#define VCP_BENCH_SINK              0x02	/* device checks the pattern */
+
+/* SET_LINE_CODING with this bitrate starts the source and sink, any other
+   coding goes back to the loopback */
+#define VCP_BENCH_BAUDRATE          1234567
+
+/* xorshift32 seed of both pattern generators */
+#define VCP_BENCH_SEED              0x2545F491
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void VCP_Bench_Start(uint8_t Mode);
+void VCP_Bench_Stop(void);
+void VCP_Bench_LineCoding(uint32_t Bitrate);
+void VCP_Bench_In(void);
+void VCP_Bench_Out(void);
+void VCP_Bench_Frame(void);
+uint8_t *VCP_Bench_GetStats(uint16_t Length);
+
+/* External variables --------------------------------------------------------*/
+extern __IO uint8_t VCP_Bench_Mode;
+
+#endif /* __VCP_BENCH_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
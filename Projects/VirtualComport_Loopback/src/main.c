@@ -30,6 +30,7 @@
 #include "usb_lib.h"
 #include "usb_desc.h"
 #include "usb_pwr.h"
+#include "vcp_bench.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -59,7 +60,8 @@ int main(void)
 	USB_Init();
 
 	while (1) {
-		if (bDeviceState == CONFIGURED) {
+		/* The benchmark runs from the endpoint callbacks */
+		if ((bDeviceState == CONFIGURED) && (VCP_Bench_Mode == 0)) {
 			CDC_Receive_DATA();
 			/*Check to see if we have data yet */
 			if (Receive_length != 0) {
@@ -32,6 +32,7 @@
 #include "hw_config.h"
 #include "usb_istr.h"
 #include "usb_pwr.h"
+#include "vcp_bench.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -58,6 +59,9 @@ uint32_t Receive_length;
 void EP1_IN_Callback(void)
 {
 	packet_sent = 1;
+
+	/* Accounts a pattern packet, reloads EP1 while sourcing */
+	VCP_Bench_In();
 }
 
 /*******************************************************************************
@@ -69,10 +73,30 @@ void EP1_IN_Callback(void)
 *******************************************************************************/
 void EP3_OUT_Callback(void)
 {
+	if (VCP_Bench_Mode & VCP_BENCH_SINK) {
+		VCP_Bench_Out();
+		return;
+	}
+
 	packet_receive = 1;
 	Receive_length = GetEPRxCount(ENDP3);
 	PMAToUserBufferCopy((unsigned char *)Receive_Buffer, ENDP3_RXADDR,
 			    Receive_length);
 }
 
+/*******************************************************************************
+* Function Name  : SOF_Callback / INTR_SOFINTR_Callback
+* Description    :
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void SOF_Callback(void)
+{
+	if (bDeviceState == CONFIGURED) {
+		/* Per frame utilisation of the benchmark */
+		VCP_Bench_Frame();
+	}
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -32,6 +32,7 @@
 #include "usb_desc.h"
 #include "usb_pwr.h"
 #include "hw_config.h"
+#include "vcp_bench.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -228,6 +229,8 @@ void Virtual_Com_Port_SetDeviceAddress(void)
 void Virtual_Com_Port_Status_In(void)
 {
 	if (Request == SET_LINE_CODING) {
+		/* A magic bitrate switches to the benchmark */
+		VCP_Bench_LineCoding(linecoding.bitrate);
 		Request = 0;
 	}
 }
@@ -265,6 +268,10 @@ RESULT Virtual_Com_Port_Data_Setup(uint8_t RequestNo)
 			CopyRoutine = Virtual_Com_Port_SetLineCoding;
 		}
 		Request = SET_LINE_CODING;
+	} else if (RequestNo == VCP_BENCH_GET_STATS) {
+		if (Type_Recipient == (VENDOR_REQUEST | DEVICE_RECIPIENT)) {
+			CopyRoutine = VCP_Bench_GetStats;
+		}
 	}
 
 	if (CopyRoutine == NULL) {
@@ -293,6 +300,14 @@ RESULT Virtual_Com_Port_NoData_Setup(uint8_t RequestNo)
 		} else if (RequestNo == SET_CONTROL_LINE_STATE) {
 			return USB_SUCCESS;
 		}
+	} else if (Type_Recipient == (VENDOR_REQUEST | DEVICE_RECIPIENT)) {
+		if (RequestNo == VCP_BENCH_START) {
+			VCP_Bench_Start(pInformation->USBwValue0);
+			return USB_SUCCESS;
+		} else if (RequestNo == VCP_BENCH_STOP) {
+			VCP_Bench_Stop();
+			return USB_SUCCESS;
+		}
 	}
 
 	return USB_UNSUPPORT;
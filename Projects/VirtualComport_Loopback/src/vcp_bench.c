@@ -0,0 +1,292 @@
+/**
+  ******************************************************************************
+  * @file    vcp_bench.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Throughput benchmark mode: the device sources and/or sinks a
+  *          pseudo-random pattern at full speed on the CDC data endpoints
+  *          and keeps statistics the host reads back with a vendor request.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "usb_desc.h"
+#include "usb_mem.h"
+#include "hw_config.h"
+#include "vcp_bench.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Byte stream of the xorshift32 generator, least significant byte first */
+typedef struct {
+	uint32_t State;
+	uint32_t Word;
+	uint8_t Left;
+} VCP_BENCH_PRBS;
+
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+__IO uint8_t VCP_Bench_Mode = 0;
+
+static VCP_BENCH_STATS VCP_Bench_Stats;
+static VCP_BENCH_PRBS VCP_Bench_TxPrbs;
+static VCP_BENCH_PRBS VCP_Bench_RxPrbs;
+static uint8_t VCP_Bench_Buffer[VIRTUAL_COM_PORT_DATA_SIZE];
+static uint32_t VCP_Bench_FrameIn = 0;
+static uint32_t VCP_Bench_FrameOut = 0;
+static uint8_t VCP_Bench_ByLineCoding = 0;
+static uint8_t VCP_Bench_InLoaded = 0;	/* EP1 holds a pattern packet */
+
+/* Extern variables ----------------------------------------------------------*/
+extern __IO uint32_t packet_sent;
+
+/* Private function prototypes -----------------------------------------------*/
+static void VCP_Bench_Load(void);
+static void VCP_Bench_Seed(VCP_BENCH_PRBS * Prbs);
+static uint8_t VCP_Bench_Next(VCP_BENCH_PRBS * Prbs);
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : VCP_Bench_Start.
+* Description    : Reset the statistics and the patterns, then start sourcing
+*                  on EP1 and/or sinking on EP3.
+* Input          : Mode: VCP_BENCH_SOURCE and/or VCP_BENCH_SINK.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Bench_Start(uint8_t Mode)
+{
+	uint8_t *pStats = (uint8_t *) & VCP_Bench_Stats;
+	uint32_t i;
+
+	for (i = 0; i < sizeof(VCP_Bench_Stats); i++) {
+		pStats[i] = 0;
+	}
+	VCP_Bench_Seed(&VCP_Bench_TxPrbs);
+	VCP_Bench_Seed(&VCP_Bench_RxPrbs);
+	VCP_Bench_FrameIn = 0;
+	VCP_Bench_FrameOut = 0;
+	VCP_Bench_ByLineCoding = 0;
+
+	Mode &= (VCP_BENCH_SOURCE | VCP_BENCH_SINK);
+	VCP_Bench_Stats.Mode = Mode;
+	VCP_Bench_Mode = Mode;
+
+	/* A packet still in EP1 starts the source once the host takes it */
+	if ((Mode & VCP_BENCH_SOURCE) && (packet_sent == 1)) {
+		VCP_Bench_Load();
+	}
+	if (Mode & VCP_BENCH_SINK) {
+		SetEPRxValid(ENDP3);
+	}
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Bench_Stop.
+* Description    : Go back to the loopback. The statistics are kept. A packet
+*                  still in EP1 is left to the host: the loopback sends again
+*                  once its completion sets packet_sent.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Bench_Stop(void)
+{
+	VCP_Bench_Mode = 0;
+	VCP_Bench_ByLineCoding = 0;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Bench_LineCoding.
+* Description    : SET_LINE_CODING hook: the magic bitrate starts the source
+*                  and the sink, another one stops a bench it had started.
+* Input          : Bitrate: bitrate of the new line coding.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Bench_LineCoding(uint32_t Bitrate)
+{
+	if (Bitrate == VCP_BENCH_BAUDRATE) {
+		VCP_Bench_Start(VCP_BENCH_SOURCE | VCP_BENCH_SINK);
+		VCP_Bench_ByLineCoding = 1;
+	} else if (VCP_Bench_ByLineCoding) {
+		VCP_Bench_Stop();
+	}
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Bench_In.
+* Description    : EP1 IN completion: account the pattern packet the host
+*                  took, then queue the next one while sourcing.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Bench_In(void)
+{
+	if (VCP_Bench_InLoaded) {
+		VCP_Bench_InLoaded = 0;
+		VCP_Bench_Stats.InPackets++;
+		VCP_Bench_Stats.InBytes += VIRTUAL_COM_PORT_DATA_SIZE;
+		VCP_Bench_FrameIn++;
+	}
+
+	if (VCP_Bench_Mode & VCP_BENCH_SOURCE) {
+		VCP_Bench_Load();
+	}
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Bench_Load.
+* Description    : Load the next packet of the pattern in the free EP1.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void VCP_Bench_Load(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < VIRTUAL_COM_PORT_DATA_SIZE; i++) {
+		VCP_Bench_Buffer[i] = VCP_Bench_Next(&VCP_Bench_TxPrbs);
+	}
+
+	UserToPMABufferCopy(VCP_Bench_Buffer, ENDP1_TXADDR,
+			    VIRTUAL_COM_PORT_DATA_SIZE);
+	SetEPTxCount(ENDP1, VIRTUAL_COM_PORT_DATA_SIZE);
+	SetEPTxValid(ENDP1);
+
+	VCP_Bench_InLoaded = 1;
+	packet_sent = 0;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Bench_Out.
+* Description    : EP3 packet received: check it against the pattern and
+*                  re-arm the endpoint at once.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Bench_Out(void)
+{
+	uint32_t count;
+	uint32_t i;
+
+	count = GetEPRxCount(ENDP3);
+	PMAToUserBufferCopy(VCP_Bench_Buffer, ENDP3_RXADDR, count);
+	SetEPRxValid(ENDP3);
+
+	for (i = 0; i < count; i++) {
+		if (VCP_Bench_Buffer[i] != VCP_Bench_Next(&VCP_Bench_RxPrbs)) {
+			VCP_Bench_Stats.OutErrors++;
+		}
+	}
+
+	VCP_Bench_Stats.OutPackets++;
+	VCP_Bench_Stats.OutBytes += count;
+	VCP_Bench_FrameOut++;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Bench_Frame.
+* Description    : SOF: close the per frame utilisation counters.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Bench_Frame(void)
+{
+	if (VCP_Bench_Mode == 0) {
+		return;
+	}
+
+	VCP_Bench_Stats.Frames++;
+	if (VCP_Bench_FrameIn > VCP_Bench_Stats.MaxInPerFrame) {
+		VCP_Bench_Stats.MaxInPerFrame = VCP_Bench_FrameIn;
+	}
+	if (VCP_Bench_FrameOut > VCP_Bench_Stats.MaxOutPerFrame) {
+		VCP_Bench_Stats.MaxOutPerFrame = VCP_Bench_FrameOut;
+	}
+	VCP_Bench_FrameIn = 0;
+	VCP_Bench_FrameOut = 0;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Bench_GetStats.
+* Description    : VCP_BENCH_GET_STATS data stage.
+* Input          : Length.
+* Output         : None.
+* Return         : Address of the statistics.
+*******************************************************************************/
+uint8_t *VCP_Bench_GetStats(uint16_t Length)
+{
+	if (Length == 0) {
+		pInformation->Ctrl_Info.Usb_wLength = sizeof(VCP_Bench_Stats);
+		return NULL;
+	}
+	return (uint8_t *) & VCP_Bench_Stats +
+	    pInformation->Ctrl_Info.Usb_wOffset;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Bench_Seed.
+* Description    : Restart a pattern generator.
+* Input          : Prbs: generator.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void VCP_Bench_Seed(VCP_BENCH_PRBS * Prbs)
+{
+	Prbs->State = VCP_BENCH_SEED;
+	Prbs->Word = 0;
+	Prbs->Left = 0;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Bench_Next.
+* Description    : Next byte of a pattern.
+* Input          : Prbs: generator.
+* Output         : None.
+* Return         : Pattern byte.
+*******************************************************************************/
+static uint8_t VCP_Bench_Next(VCP_BENCH_PRBS * Prbs)
+{
+	uint8_t value;
+
+	if (Prbs->Left == 0) {
+		Prbs->State ^= Prbs->State << 13;
+		Prbs->State ^= Prbs->State >> 17;
+		Prbs->State ^= Prbs->State << 5;
+		Prbs->Word = Prbs->State;
+		Prbs->Left = 4;
+	}
+
+	value = (uint8_t) Prbs->Word;
+	Prbs->Word >>= 8;
+	Prbs->Left--;
+
+	return value;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -34,6 +34,17 @@
 #include "usb_type.h"
 
 /* Exported types ------------------------------------------------------------*/
+/* IN pipe counters, the average packet fill is Bytes / Packets */
+typedef struct {
+	uint32_t Packets;	/* IN data packets sent */
+	uint32_t Bytes;		/* bytes carried by these packets */
+	uint32_t Zlps;		/* zero length packets ending a transfer */
+	uint32_t FlushFull;	/* flushes on a full packet ready */
+	uint32_t FlushThreshold;	/* flushes on VCOMPORT_IN_FLUSH_THRESHOLD */
+	uint32_t FlushTimeout;	/* flushes on VCOMPORT_IN_FLUSH_TIMEOUT_US */
+	uint32_t FlushIdle;	/* flushes on an idle USART line */
+} VCP_IN_STATS;
+
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /* Exported define -----------------------------------------------------------*/
@@ -43,6 +54,22 @@
 #define LED_OFF               0xFF
 
 #define USART_RX_DATA_SIZE   2048
+/* IN flush policy: a full packet is sent at once, a partial one is held until
+   THRESHOLD bytes are pending or its oldest byte waited TIMEOUT_US (counted
+   in 1 ms frames). An idle USART line flushes at once */
+#define VCOMPORT_IN_FLUSH_THRESHOLD    32
+#define VCOMPORT_IN_FLUSH_TIMEOUT_US   5000
+/* Longest IN transfer, a multiple of the packet size: a port sending without
+   pause still ends a transfer, and hands over to the other ports, at this
+   many bytes */
+#define VCOMPORT_IN_MAX_TRANSFER       1024
+
+/* Packets queued from the OUT endpoint to the USART TX DMA (power of 2) */
+#define USART_TX_SLOTS       8
+
+/* Port carrying COBS framed messages for the application (vcp_frame.c)
+   instead of bridging its USART: uncomment to enable */
+/* #define VCP_FRAME_PORT       0 */
 /* Exported functions ------------------------------------------------------- */
 void Set_System(void);
 void Set_USBClock(void);
@@ -50,14 +77,22 @@ void Enter_LowPowerMode(void);
 void Leave_LowPowerMode(void);
 void USB_Interrupts_Config(void);
 void USB_Cable_Config(FunctionalState NewState);
-void USART_Config_Default(void);
-bool USART_Config(void);
-void USB_To_USART_Send_Data(uint8_t * data_buffer, uint8_t Nb_bytes);
-void USART_To_USB_Send_Data(void);
+void USART_Config_Default(uint8_t Port);
+bool USART_Config(uint8_t Port);
+void USART_Rx_DMA_Config(uint8_t Port);
+void USART_Tx_DMA_Config(uint8_t Port);
+void USB_To_USART_Send_Data(uint8_t Port);
+void USART_Tx_DMA_Complete(uint8_t Port);
+void USART_Tx_Resume(void);
+void USART_To_USB_Send_Data(uint8_t Port);
 void Handle_USBAsynchXfer(void);
+void Handle_USBAsynchXferComplete(uint8_t Port);
+uint8_t *VCP_In_Window(uint8_t Port, uint32_t * Head, uint32_t * Free);
+void VCP_In_Commit(uint8_t Port, uint32_t Head);
 void Get_SerialNum(void);
 
 /* External variables --------------------------------------------------------*/
+extern VCP_IN_STATS VCP_In_Stats[];
 
 #endif	/*__HW_CONFIG_H*/
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
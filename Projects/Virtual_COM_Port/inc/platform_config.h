@@ -151,6 +151,51 @@
 #define EVAL_COM1_IRQHandler              USART1_IRQHandler
 #endif
 
+/* DMA1 channels serving the EVAL_COM1 requests and the registers they use */
+#if defined (USE_STM32L152_EVAL) || defined (USE_STM32373C_EVAL)
+#define EVAL_COM1_RX_DMA_CHANNEL            DMA1_Channel6
+#define EVAL_COM1_TX_DMA_CHANNEL            DMA1_Channel7
+#define EVAL_COM1_TX_DMA_IRQn               DMA1_Channel7_IRQn
+#define EVAL_COM1_TX_DMA_IRQHandler         DMA1_Channel7_IRQHandler
+#define EVAL_COM1_TX_DMA_IT_TC              DMA1_IT_TC7
+#else
+#define EVAL_COM1_RX_DMA_CHANNEL            DMA1_Channel5
+#define EVAL_COM1_TX_DMA_CHANNEL            DMA1_Channel4
+#define EVAL_COM1_TX_DMA_IRQn               DMA1_Channel4_IRQn
+#define EVAL_COM1_TX_DMA_IRQHandler         DMA1_Channel4_IRQHandler
+#define EVAL_COM1_TX_DMA_IT_TC              DMA1_IT_TC4
+#endif
+
+#if defined (USE_STM32373C_EVAL) || defined (USE_STM32303C_EVAL)
+#define EVAL_COM1_RX_DATA_ADDRESS           ((uint32_t)&EVAL_COM1->RDR)
+#define EVAL_COM1_TX_DATA_ADDRESS           ((uint32_t)&EVAL_COM1->TDR)
+#else
+#define EVAL_COM1_RX_DATA_ADDRESS           ((uint32_t)&EVAL_COM1->DR)
+#define EVAL_COM1_TX_DATA_ADDRESS           ((uint32_t)&EVAL_COM1->DR)
+#endif
+
+/* Second CDC-ACM port on EVAL_COM2, see VCP_PORTS in usb_conf.h */
+#if defined (USE_STM32L152_EVAL)
+#define EVAL_COM2_IRQHandler                USART3_IRQHandler
+#define EVAL_COM2_RX_DMA_CHANNEL            DMA1_Channel3
+#define EVAL_COM2_TX_DMA_CHANNEL            DMA1_Channel2
+#define EVAL_COM2_TX_DMA_IRQn               DMA1_Channel2_IRQn
+#define EVAL_COM2_TX_DMA_IRQHandler         DMA1_Channel2_IRQHandler
+#define EVAL_COM2_TX_DMA_IT_TC              DMA1_IT_TC2
+#elif defined (USE_STM3210B_EVAL) || defined (USE_STM3210E_EVAL)
+#define EVAL_COM2_IRQHandler                USART2_IRQHandler
+#define EVAL_COM2_RX_DMA_CHANNEL            DMA1_Channel6
+#define EVAL_COM2_TX_DMA_CHANNEL            DMA1_Channel7
+#define EVAL_COM2_TX_DMA_IRQn               DMA1_Channel7_IRQn
+#define EVAL_COM2_TX_DMA_IRQHandler         DMA1_Channel7_IRQHandler
+#define EVAL_COM2_TX_DMA_IT_TC              DMA1_IT_TC7
+#endif
+
+#if defined (EVAL_COM2_IRQHandler)
+#define EVAL_COM2_RX_DATA_ADDRESS           ((uint32_t)&EVAL_COM2->DR)
+#define EVAL_COM2_TX_DATA_ADDRESS           ((uint32_t)&EVAL_COM2->DR)
+#endif
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 
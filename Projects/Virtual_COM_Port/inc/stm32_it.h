@@ -50,8 +50,19 @@ void USB_LP_CAN1_RX0_IRQHandler(void);
 
 #if defined (USE_STM32L152_EVAL) || (USE_STM32373C_EVAL)
 void USART2_IRQHandler(void);
+void DMA1_Channel7_IRQHandler(void);
 #else
 void USART1_IRQHandler(void);
+void DMA1_Channel4_IRQHandler(void);
+#endif /* USE_STM32L152_EVAL */
+
+/* Second CDC-ACM port */
+#if defined (USE_STM32L152_EVAL)
+void USART3_IRQHandler(void);
+void DMA1_Channel2_IRQHandler(void);
+#elif defined (USE_STM3210B_EVAL) || defined (USE_STM3210E_EVAL)
+void USART2_IRQHandler(void);
+void DMA1_Channel7_IRQHandler(void);
 #endif /* USE_STM32L152_EVAL */
 #endif /* __STM32_IT_H */
 
@@ -36,12 +36,29 @@
 /* Exported functions ------------------------------------------------------- */
 /* External variables --------------------------------------------------------*/
 
+/*-------------------------------------------------------------*/
+/* VCP_PORTS */
+/* number of CDC-ACM ports, one per EVAL_COM of the board. */
+/* Two ports make a composite device (IAD) */
+/*-------------------------------------------------------------*/
+#ifndef VCP_PORTS
+#if defined (USE_STM3210B_EVAL) || defined (USE_STM3210E_EVAL) || defined (USE_STM32L152_EVAL)
+#define VCP_PORTS                       (2)
+#else
+#define VCP_PORTS                       (1)
+#endif
+#endif /* VCP_PORTS */
+
 /*-------------------------------------------------------------*/
 /* EP_NUM */
 /* defines how many endpoints are used by the device */
 /*-------------------------------------------------------------*/
 
+#if (VCP_PORTS > 1)
+#define EP_NUM                          (6)
+#else
 #define EP_NUM                          (4)
+#endif
 
 /*-------------------------------------------------------------*/
 /* --------------   Buffer Description Table  -----------------*/
@@ -55,12 +72,22 @@
 #define ENDP0_RXADDR        (0x40)
 #define ENDP0_TXADDR        (0x80)
 
-/* EP1  */
+/* Port 0: EP1 bulk IN, EP2 interrupt IN, EP3 bulk OUT */
 /* tx buffer base address */
 #define ENDP1_TXADDR        (0xC0)
 #define ENDP2_TXADDR        (0x100)
 #define ENDP3_RXADDR        (0x110)
 
+/* Port 1: EP4 bulk IN and OUT, EP5 interrupt IN. The 512 bytes of PMA are
+   full after it: a third port does not fit with a 64 bytes EP0 */
+#define ENDP4_TXADDR        (0x150)
+#define ENDP4_RXADDR        (0x190)
+#define ENDP5_TXADDR        (0x1D0)
+
+#if (VCP_PORTS > 2)
+#error "Only two CDC-ACM ports fit in the packet memory"
+#endif
+
 /*-------------------------------------------------------------*/
 /* -------------------   ISTR events  -------------------------*/
 /*-------------------------------------------------------------*/
@@ -83,7 +110,9 @@
 /*#define  EP1_IN_Callback   NOP_Process*/
 #define  EP2_IN_Callback   NOP_Process
 #define  EP3_IN_Callback   NOP_Process
+#if (VCP_PORTS < 2)
 #define  EP4_IN_Callback   NOP_Process
+#endif
 #define  EP5_IN_Callback   NOP_Process
 #define  EP6_IN_Callback   NOP_Process
 #define  EP7_IN_Callback   NOP_Process
@@ -91,7 +120,9 @@
 #define  EP1_OUT_Callback   NOP_Process
 #define  EP2_OUT_Callback   NOP_Process
 /*#define  EP3_OUT_Callback   NOP_Process*/
+#if (VCP_PORTS < 2)
 #define  EP4_OUT_Callback   NOP_Process
+#endif
 #define  EP5_OUT_Callback   NOP_Process
 #define  EP6_OUT_Callback   NOP_Process
 #define  EP7_OUT_Callback   NOP_Process
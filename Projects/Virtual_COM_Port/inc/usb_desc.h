@@ -44,7 +44,12 @@
 #define VIRTUAL_COM_PORT_INT_SIZE               8
 
 #define VIRTUAL_COM_PORT_SIZ_DEVICE_DESC        18
+#if (VCP_PORTS > 1)
+/* Each port adds an interface association and its two interfaces */
+#define VIRTUAL_COM_PORT_SIZ_CONFIG_DESC        (9 + (8 + 58) * VCP_PORTS)
+#else
 #define VIRTUAL_COM_PORT_SIZ_CONFIG_DESC        67
+#endif /* VCP_PORTS */
 #define VIRTUAL_COM_PORT_SIZ_STRING_LANGID      4
 #define VIRTUAL_COM_PORT_SIZ_STRING_VENDOR      38
 #define VIRTUAL_COM_PORT_SIZ_STRING_PRODUCT     50
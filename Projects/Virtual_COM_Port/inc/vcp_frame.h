@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file    vcp_frame.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for vcp_frame.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __VCP_FRAME_H
+#define __VCP_FRAME_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "platform_config.h"
+#include "usb_type.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Decoded payload size limit, longer frames are dropped */
+#define VCP_FRAME_MAX_SIZE          256
+/* Frame buffers shared by the decoder and the application (power of 2) */
+#define VCP_FRAME_POOL              4
+/* Sent frames whose latency is tracked at once (power of 2) */
+#define VCP_FRAME_TX_MARKS          8
+
+/* Exported types ------------------------------------------------------------*/
+/* Received frame, owned by the application between VCP_Frame_Get and
+   VCP_Frame_Release */
+typedef struct {
+	uint8_t Data[VCP_FRAME_MAX_SIZE];
+	uint16_t Length;
+	uint16_t Stamp;		/* USB frame number the frame was completed in */
+} VCP_FRAME;
+
+/* Latencies are in ms (USB frames), measured on the 11-bit frame number */
+typedef struct {
+	uint32_t RxFrames;
+	uint32_t RxErrors;	/* malformed or oversized frames dropped */
+	uint32_t RxParked;	/* OUT packets held until a buffer was released */
+	uint32_t RxLatencySum;	/* decode to release */
+	uint32_t RxLatencyMax;
+	uint32_t TxFrames;
+	uint32_t TxFull;	/* frames refused, the IN ring was full */
+	uint32_t TxLatencySum;	/* VCP_Frame_Send to the last packet on the IN
+				   endpoint */
+	uint32_t TxLatencyMax;
+} VCP_FRAME_STATS;
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+void VCP_Frame_Init(void);
+void VCP_Frame_Receive(void);
+void VCP_Frame_Resume(void);
+void VCP_Frame_Sent(uint16_t Length);
+VCP_FRAME *VCP_Frame_Get(void);
+void VCP_Frame_Release(VCP_FRAME * Frame);
+bool VCP_Frame_Send(const uint8_t * Data, uint16_t Length);
+
+/* External variables --------------------------------------------------------*/
+extern VCP_FRAME_STATS VCP_Frame_Stats;
+
+#endif /* __VCP_FRAME_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -33,24 +33,97 @@
 #include "usb_desc.h"
 #include "hw_config.h"
 #include "usb_pwr.h"
+#include "vcp_frame.h"
 
 /* Private typedef -----------------------------------------------------------*/
+/* Resources of one CDC-ACM port */
+typedef struct {
+	COM_TypeDef Com;	/* EVAL_COMx bridged by the port */
+	USART_TypeDef *Usart;
+	DMA_Channel_TypeDef *RxDma;
+	DMA_Channel_TypeDef *TxDma;
+	uint32_t RxData;	/* USART data register addresses */
+	uint32_t TxData;
+	uint8_t InEp;		/* bulk IN endpoint and its PMA buffer */
+	uint16_t InAddr;
+	uint8_t OutEp;		/* bulk OUT endpoint */
+} VCP_PORT_HW;
+
+/* State of one CDC-ACM port */
+typedef struct {
+	USART_InitTypeDef Init;
+
+	/* Circular DMA target: Rx_ptr_in follows the DMA write position. On the
+	   VCP_FRAME_PORT the ring is filled by VCP_In_Commit instead */
+	uint8_t Rx_Buffer[USART_RX_DATA_SIZE];
+	__IO uint32_t Rx_ptr_in;
+	uint32_t Rx_ptr_out;
+	uint32_t Rx_length;	/* left to send in the current IN transfer */
+	__IO uint8_t Rx_Idle;
+	uint8_t Rx_Held;
+	uint16_t Rx_Stamp;
+
+	/* Packet ring from the OUT endpoint to the USART TX DMA: Tx_in only
+	   moves in the USB context and Tx_out in the DMA interrupt, both are
+	   free running */
+	uint8_t Tx_Buffer[USART_TX_SLOTS][BULK_MAX_PACKET_SIZE];
+	uint8_t Tx_Length[USART_TX_SLOTS];
+	__IO uint8_t Tx_in;
+	__IO uint8_t Tx_out;
+	__IO uint8_t Tx_Busy;
+	__IO uint8_t Tx_Parked;
+
+	uint8_t USB_Tx_State;
+	/* Size of the last IN packet, a full one leaves the transfer open */
+	uint16_t USB_Tx_Last;
+	uint32_t USB_Tx_Total;	/* bytes of the current IN transfer */
+} VCP_PORT;
+
 /* Private define ------------------------------------------------------------*/
+#if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)|| defined (STM32F37X)
+#define USB_LP_IRQ                  USB_LP_IRQn
+#else
+#define USB_LP_IRQ                  USB_LP_CAN1_RX0_IRQn
+#endif
+
+#if defined (VCP_FRAME_PORT)
+#define VCP_FRAMED(Port)            ((Port) == VCP_FRAME_PORT)
+#else
+#define VCP_FRAMED(Port)            0
+#endif /* VCP_FRAME_PORT */
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 ErrorStatus HSEStartUpStatus;
-USART_InitTypeDef USART_InitStructure;
 EXTI_InitTypeDef EXTI_InitStructure;
-uint8_t USART_Rx_Buffer[USART_RX_DATA_SIZE];
-uint32_t USART_Rx_ptr_in = 0;
-uint32_t USART_Rx_ptr_out = 0;
-uint32_t USART_Rx_length = 0;
 
-uint8_t USB_Tx_State = 0;
+static const VCP_PORT_HW VCP_Port_Hw[VCP_PORTS] = {
+	{COM1, EVAL_COM1, EVAL_COM1_RX_DMA_CHANNEL, EVAL_COM1_TX_DMA_CHANNEL,
+	 EVAL_COM1_RX_DATA_ADDRESS, EVAL_COM1_TX_DATA_ADDRESS,
+	 ENDP1, ENDP1_TXADDR, ENDP3}
+#if (VCP_PORTS > 1)
+	,
+	{COM2, EVAL_COM2, EVAL_COM2_RX_DMA_CHANNEL, EVAL_COM2_TX_DMA_CHANNEL,
+	 EVAL_COM2_RX_DATA_ADDRESS, EVAL_COM2_TX_DATA_ADDRESS,
+	 ENDP4, ENDP4_TXADDR, ENDP4}
+#endif
+};
+
+static VCP_PORT VCP_Port[VCP_PORTS];
+VCP_IN_STATS VCP_In_Stats[VCP_PORTS];
+
+/* Gathers the packets straddling a Rx_Buffer wrap */
+static uint8_t USB_Tx_Wrap[VIRTUAL_COM_PORT_DATA_SIZE];
+
 static void IntToUnicode(uint32_t value, uint8_t * pbuf, uint8_t len);
+static void Handle_PortXfer(uint8_t Port);
+static void USART_Rx_Latch(uint8_t Port);
+static void USART_Tx_Start(uint8_t Port);
+static uint32_t USART_Rx_Pending(uint8_t Port);
+static void USB_Tx_SendPacket(uint8_t Port);
 /* Extern variables ----------------------------------------------------------*/
 
-extern LINE_CODING linecoding;
+extern LINE_CODING linecoding[];
 
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -251,6 +324,22 @@ void USB_Interrupts_Config(void)
 	NVIC_InitStructure.NVIC_IRQChannel = EVAL_COM1_IRQn;
 	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
 	NVIC_Init(&NVIC_InitStructure);
+
+	/* Enable the USART TX DMA Interrupt */
+	NVIC_InitStructure.NVIC_IRQChannel = EVAL_COM1_TX_DMA_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_Init(&NVIC_InitStructure);
+
+#if (VCP_PORTS > 1)
+	/* Same for the second port */
+	NVIC_InitStructure.NVIC_IRQChannel = EVAL_COM2_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_Init(&NVIC_InitStructure);
+
+	NVIC_InitStructure.NVIC_IRQChannel = EVAL_COM2_TX_DMA_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_Init(&NVIC_InitStructure);
+#endif /* VCP_PORTS */
 }
 
 /*******************************************************************************
@@ -279,14 +368,25 @@ void USB_Cable_Config(FunctionalState NewState)
 
 /*******************************************************************************
 * Function Name  :  USART_Config_Default.
-* Description    :  configure the EVAL_COM1 with default values.
-* Input          :  None.
+* Description    :  configure the port USART with default values.
+* Input          :  Port: CDC-ACM port number.
 * Return         :  None.
 *******************************************************************************/
-void USART_Config_Default(void)
+void USART_Config_Default(uint8_t Port)
 {
-	/* EVAL_COM1 default configuration */
-	/* EVAL_COM1 configured as follow:
+	USART_InitTypeDef *pInit = &VCP_Port[Port].Init;
+
+	if (VCP_FRAMED(Port)) {
+		/* The USART is left alone, only the IN ring is used */
+		VCP_Port[Port].Rx_ptr_in = 0;
+		VCP_Port[Port].Rx_ptr_out = 0;
+		VCP_Port[Port].Rx_length = 0;
+		VCP_Port[Port].Rx_Idle = 0;
+		return;
+	}
+
+	/* EVAL_COMx default configuration */
+	/* EVAL_COMx configured as follow:
 	   - BaudRate = 9600 baud  
 	   - Word Length = 8 Bits
 	   - One Stop Bit
@@ -294,193 +394,624 @@ void USART_Config_Default(void)
 	   - Hardware flow control disabled
 	   - Receive and transmit enabled
 	 */
-	USART_InitStructure.USART_BaudRate = 9600;
-	USART_InitStructure.USART_WordLength = USART_WordLength_8b;
-	USART_InitStructure.USART_StopBits = USART_StopBits_1;
-	USART_InitStructure.USART_Parity = USART_Parity_Odd;
-	USART_InitStructure.USART_HardwareFlowControl =
-	    USART_HardwareFlowControl_None;
-	USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
+	pInit->USART_BaudRate = 9600;
+	pInit->USART_WordLength = USART_WordLength_8b;
+	pInit->USART_StopBits = USART_StopBits_1;
+	pInit->USART_Parity = USART_Parity_Odd;
+	pInit->USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+	pInit->USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
 
 	/* Configure and enable the USART */
-	STM_EVAL_COMInit(COM1, &USART_InitStructure);
+	STM_EVAL_COMInit(VCP_Port_Hw[Port].Com, pInit);
 
-	/* Enable the USART Receive interrupt */
-	USART_ITConfig(EVAL_COM1, USART_IT_RXNE, ENABLE);
+	/* Receive and transmit through the DMA */
+	USART_Rx_DMA_Config(Port);
+	USART_Tx_DMA_Config(Port);
 }
 
 /*******************************************************************************
 * Function Name  :  USART_Config.
-* Description    :  Configure the EVAL_COM1 according to the line coding structure.
-* Input          :  None.
+* Description    :  Configure the port USART according to its line coding.
+* Input          :  Port: CDC-ACM port number.
 * Return         :  Configuration status
                     TRUE : configuration done with success
                     FALSE : configuration aborted.
 *******************************************************************************/
-bool USART_Config(void)
+bool USART_Config(uint8_t Port)
 {
+	USART_InitTypeDef *pInit = &VCP_Port[Port].Init;
+	LINE_CODING *pCoding = &linecoding[Port];
+
+	if (VCP_FRAMED(Port)) {
+		return (TRUE);
+	}
 
 	/* set the Stop bit */
-	switch (linecoding.format) {
+	switch (pCoding->format) {
 	case 0:
-		USART_InitStructure.USART_StopBits = USART_StopBits_1;
+		pInit->USART_StopBits = USART_StopBits_1;
 		break;
 	case 1:
-		USART_InitStructure.USART_StopBits = USART_StopBits_1_5;
+		pInit->USART_StopBits = USART_StopBits_1_5;
 		break;
 	case 2:
-		USART_InitStructure.USART_StopBits = USART_StopBits_2;
+		pInit->USART_StopBits = USART_StopBits_2;
 		break;
 	default:
 		{
-			USART_Config_Default();
+			USART_Config_Default(Port);
 			return (FALSE);
 		}
 	}
 
 	/* set the parity bit */
-	switch (linecoding.paritytype) {
+	switch (pCoding->paritytype) {
 	case 0:
-		USART_InitStructure.USART_Parity = USART_Parity_No;
+		pInit->USART_Parity = USART_Parity_No;
 		break;
 	case 1:
-		USART_InitStructure.USART_Parity = USART_Parity_Even;
+		pInit->USART_Parity = USART_Parity_Even;
 		break;
 	case 2:
-		USART_InitStructure.USART_Parity = USART_Parity_Odd;
+		pInit->USART_Parity = USART_Parity_Odd;
 		break;
 	default:
 		{
-			USART_Config_Default();
+			USART_Config_Default(Port);
 			return (FALSE);
 		}
 	}
 
 	/*set the data type : only 8bits and 9bits is supported */
-	switch (linecoding.datatype) {
+	switch (pCoding->datatype) {
 	case 0x07:
 		/* With this configuration a parity (Even or Odd) should be set */
-		USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+		pInit->USART_WordLength = USART_WordLength_8b;
 		break;
 	case 0x08:
-		if (USART_InitStructure.USART_Parity == USART_Parity_No) {
-			USART_InitStructure.USART_WordLength =
-			    USART_WordLength_8b;
+		if (pInit->USART_Parity == USART_Parity_No) {
+			pInit->USART_WordLength = USART_WordLength_8b;
 		} else {
-			USART_InitStructure.USART_WordLength =
-			    USART_WordLength_9b;
+			pInit->USART_WordLength = USART_WordLength_9b;
 		}
 
 		break;
 	default:
 		{
-			USART_Config_Default();
+			USART_Config_Default(Port);
 			return (FALSE);
 		}
 	}
 
-	USART_InitStructure.USART_BaudRate = linecoding.bitrate;
-	USART_InitStructure.USART_HardwareFlowControl =
-	    USART_HardwareFlowControl_None;
-	USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
+	pInit->USART_BaudRate = pCoding->bitrate;
+	pInit->USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+	pInit->USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
 
 	/* Configure and enable the USART */
-	STM_EVAL_COMInit(COM1, &USART_InitStructure);
+	STM_EVAL_COMInit(VCP_Port_Hw[Port].Com, pInit);
+
+	/* Restart the reception, data received with the old coding is dropped */
+	USART_Rx_DMA_Config(Port);
 
 	return (TRUE);
 }
 
+/*******************************************************************************
+* Function Name  : USART_Rx_DMA_Config.
+* Description    : Run the port reception through a circular DMA into its
+*                  Rx_Buffer. Only the idle line interrupt is kept, to flush
+*                  a burst as soon as the line goes quiet.
+* Input          : Port: CDC-ACM port number.
+* Return         : None.
+*******************************************************************************/
+void USART_Rx_DMA_Config(uint8_t Port)
+{
+	const VCP_PORT_HW *pHw = &VCP_Port_Hw[Port];
+	VCP_PORT *pPort = &VCP_Port[Port];
+	DMA_InitTypeDef DMA_InitStructure;
+
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+	USART_ITConfig(pHw->Usart, USART_IT_RXNE, DISABLE);
+	USART_DMACmd(pHw->Usart, USART_DMAReq_Rx, DISABLE);
+	DMA_Cmd(pHw->RxDma, DISABLE);
+	DMA_DeInit(pHw->RxDma);
+
+	DMA_InitStructure.DMA_PeripheralBaseAddr = pHw->RxData;
+	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) pPort->Rx_Buffer;
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+	DMA_InitStructure.DMA_BufferSize = USART_RX_DATA_SIZE;
+	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+	DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+	DMA_Init(pHw->RxDma, &DMA_InitStructure);
+
+	pPort->Rx_ptr_in = 0;
+	pPort->Rx_ptr_out = 0;
+	pPort->Rx_length = 0;
+	pPort->Rx_Idle = 0;
+
+	DMA_Cmd(pHw->RxDma, ENABLE);
+	USART_DMACmd(pHw->Usart, USART_DMAReq_Rx, ENABLE);
+	USART_ITConfig(pHw->Usart, USART_IT_IDLE, ENABLE);
+}
+
+/*******************************************************************************
+* Function Name  : USART_Tx_DMA_Config.
+* Description    : Prepare the port TX DMA and empty its packet ring. The DMA
+*                  is started on each queued packet.
+* Input          : Port: CDC-ACM port number.
+* Return         : None.
+*******************************************************************************/
+void USART_Tx_DMA_Config(uint8_t Port)
+{
+	const VCP_PORT_HW *pHw = &VCP_Port_Hw[Port];
+	VCP_PORT *pPort = &VCP_Port[Port];
+	DMA_InitTypeDef DMA_InitStructure;
+
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+	DMA_Cmd(pHw->TxDma, DISABLE);
+	DMA_DeInit(pHw->TxDma);
+
+	DMA_InitStructure.DMA_PeripheralBaseAddr = pHw->TxData;
+	DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) pPort->Tx_Buffer[0];
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+	DMA_InitStructure.DMA_BufferSize = BULK_MAX_PACKET_SIZE;
+	DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+	DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+	DMA_Init(pHw->TxDma, &DMA_InitStructure);
+
+	pPort->Tx_in = 0;
+	pPort->Tx_out = 0;
+	pPort->Tx_Busy = 0;
+
+	DMA_ITConfig(pHw->TxDma, DMA_IT_TC, ENABLE);
+	USART_DMACmd(pHw->Usart, USART_DMAReq_Tx, ENABLE);
+}
+
 /*******************************************************************************
 * Function Name  : USB_To_USART_Send_Data.
-* Description    : send the received data from USB to the UART 0.
-* Input          : data_buffer: data address.
-                   Nb_bytes: number of bytes to send.
+* Description    : Queue the packet received on the port OUT endpoint for its
+*                  USART TX DMA. The endpoint is re-armed while a slot is
+*                  free, otherwise it stays NAKed until the DMA releases one.
+* Input          : Port: CDC-ACM port number.
 * Return         : none.
 *******************************************************************************/
-void USB_To_USART_Send_Data(uint8_t * data_buffer, uint8_t Nb_bytes)
+void USB_To_USART_Send_Data(uint8_t Port)
 {
+	VCP_PORT *pPort = &VCP_Port[Port];
+	uint32_t primask;
+	uint8_t slot;
+
+	slot = pPort->Tx_in & (USART_TX_SLOTS - 1);
+	pPort->Tx_Length[slot] =
+	    USB_SIL_Read(VCP_Port_Hw[Port].OutEp, pPort->Tx_Buffer[slot]);
+
+	if (pPort->Tx_Length[slot] != 0) {
+		pPort->Tx_in++;
+
+		/* Start the DMA unless it is already draining the ring */
+		primask = __get_PRIMASK();
+		__disable_irq();
+		if (pPort->Tx_Busy == 0) {
+			pPort->Tx_Busy = 1;
+			USART_Tx_Start(Port);
+		}
+		__set_PRIMASK(primask);
+	}
 
-	uint32_t i;
+	pPort->Tx_Parked = 1;
+	USART_Tx_Resume();
+}
 
-	for (i = 0; i < Nb_bytes; i++) {
-		USART_SendData(EVAL_COM1, *(data_buffer + i));
-		while (USART_GetFlagStatus(EVAL_COM1, USART_FLAG_TXE) ==
-		       RESET) ;
+/*******************************************************************************
+* Function Name  : USART_Tx_DMA_Complete.
+* Description    : USART TX DMA transfer complete: release the slot and start
+*                  the next one. A parked endpoint is resumed from the USB
+*                  context.
+* Input          : Port: CDC-ACM port number.
+* Return         : none.
+*******************************************************************************/
+void USART_Tx_DMA_Complete(uint8_t Port)
+{
+	VCP_PORT *pPort = &VCP_Port[Port];
+
+	pPort->Tx_out++;
+
+	if (pPort->Tx_out != pPort->Tx_in) {
+		USART_Tx_Start(Port);
+	} else {
+		pPort->Tx_Busy = 0;
+	}
+
+	if (pPort->Tx_Parked) {
+		NVIC_SetPendingIRQ(USB_LP_IRQ);
+	}
+}
+
+/*******************************************************************************
+* Function Name  : USART_Tx_Resume.
+* Description    : Re-arm the OUT endpoints left NAKed on a full ring once a
+*                  slot is free again. To be called from the USB context only.
+* Input          : None.
+* Return         : none.
+*******************************************************************************/
+void USART_Tx_Resume(void)
+{
+	VCP_PORT *pPort;
+	uint8_t ep;
+	uint8_t Port;
+
+	for (Port = 0; Port < VCP_PORTS; Port++) {
+		pPort = &VCP_Port[Port];
+		ep = VCP_Port_Hw[Port].OutEp;
+
+		if (pPort->Tx_Parked == 0) {
+			continue;
+		}
+
+		/* A bus reset re-armed the endpoint behind our back */
+		if (GetEPRxStatus(ep) != EP_RX_NAK) {
+			pPort->Tx_Parked = 0;
+			continue;
+		}
+
+		if ((uint8_t) (pPort->Tx_in - pPort->Tx_out) < USART_TX_SLOTS) {
+			pPort->Tx_Parked = 0;
+			SetEPRxValid(ep);
+		}
 	}
 }
 
+/*******************************************************************************
+* Function Name  : USART_Tx_Start.
+* Description    : Point the TX DMA to the oldest queued packet and start it.
+* Input          : Port: CDC-ACM port number.
+* Return         : none.
+*******************************************************************************/
+static void USART_Tx_Start(uint8_t Port)
+{
+	DMA_Channel_TypeDef *dma = VCP_Port_Hw[Port].TxDma;
+	VCP_PORT *pPort = &VCP_Port[Port];
+	uint8_t slot;
+
+	slot = pPort->Tx_out & (USART_TX_SLOTS - 1);
+
+	DMA_Cmd(dma, DISABLE);
+	dma->CMAR = (uint32_t) pPort->Tx_Buffer[slot];
+	DMA_SetCurrDataCounter(dma, pPort->Tx_Length[slot]);
+	DMA_Cmd(dma, ENABLE);
+}
+
 /*******************************************************************************
 * Function Name  : Handle_USBAsynchXfer.
-* Description    : send data to USB.
+* Description    : SOF: give every idle port the chance to start an IN
+*                  transfer, the first one served rotating each frame.
 * Input          : None.
 * Return         : none.
 *******************************************************************************/
 void Handle_USBAsynchXfer(void)
 {
+	static uint8_t First = 0;
+	uint8_t i;
 
-	uint16_t USB_Tx_ptr;
-	uint16_t USB_Tx_length;
+	for (i = 0; i < VCP_PORTS; i++) {
+		Handle_PortXfer((First + i) % VCP_PORTS);
+	}
 
-	if (USB_Tx_State != 1) {
-		if (USART_Rx_ptr_out == USART_RX_DATA_SIZE) {
-			USART_Rx_ptr_out = 0;
-		}
+	First = (First + 1) % VCP_PORTS;
+}
 
-		if (USART_Rx_ptr_out == USART_Rx_ptr_in) {
-			USB_Tx_State = 0;
+/*******************************************************************************
+* Function Name  : Handle_PortXfer.
+* Description    : Start an IN transfer with all the pending data of a port
+*                  when the IN flush policy allows it.
+* Input          : Port: CDC-ACM port number.
+* Return         : none.
+*******************************************************************************/
+static void Handle_PortXfer(uint8_t Port)
+{
+	VCP_PORT *pPort = &VCP_Port[Port];
+	VCP_IN_STATS *pStats = &VCP_In_Stats[Port];
+	uint32_t pending;
+	uint16_t frame;
+	uint8_t idle;
+
+	if (pPort->USB_Tx_State != 1) {
+		idle = pPort->Rx_Idle;
+		pPort->Rx_Idle = 0;
+
+		USART_Rx_Latch(Port);
+		pending = USART_Rx_Pending(Port);
+
+		if (pending == 0) {
+			pPort->USB_Tx_State = 0;
+			pPort->Rx_Held = 0;
 			return;
 		}
 
-		if (USART_Rx_ptr_out > USART_Rx_ptr_in) {	/* rollback */
-			USART_Rx_length = USART_RX_DATA_SIZE - USART_Rx_ptr_out;
+		/* Age of the oldest pending byte, from the frame it was seen */
+		frame = GetFNR() & FNR_FN;
+		if (pPort->Rx_Held == 0) {
+			pPort->Rx_Held = 1;
+			pPort->Rx_Stamp = frame;
+		}
+
+		if (pending >= VIRTUAL_COM_PORT_DATA_SIZE) {
+			pStats->FlushFull++;
+		} else if (idle) {
+			pStats->FlushIdle++;
+		} else if (pending >= VCOMPORT_IN_FLUSH_THRESHOLD) {
+			pStats->FlushThreshold++;
+		} else if ((uint32_t) ((frame - pPort->Rx_Stamp) & FNR_FN) *
+			   1000 >= VCOMPORT_IN_FLUSH_TIMEOUT_US) {
+			pStats->FlushTimeout++;
 		} else {
-			USART_Rx_length = USART_Rx_ptr_in - USART_Rx_ptr_out;
+			/* Coalesce with the next bytes */
+			return;
 		}
+		/* One transfer for everything pending, across the ring wrap */
+		if (pending > VCOMPORT_IN_MAX_TRANSFER) {
+			/* The rest keeps its age for the next transfer */
+			pending = VCOMPORT_IN_MAX_TRANSFER;
+		} else {
+			pPort->Rx_Held = 0;
+		}
+		pPort->Rx_length = pending;
+		pPort->USB_Tx_Total = pending;
+		pPort->USB_Tx_State = 1;
+		USB_Tx_SendPacket(Port);
+	}
+}
 
-		if (USART_Rx_length > VIRTUAL_COM_PORT_DATA_SIZE) {
-			USB_Tx_ptr = USART_Rx_ptr_out;
-			USB_Tx_length = VIRTUAL_COM_PORT_DATA_SIZE;
+/*******************************************************************************
+* Function Name  : Handle_USBAsynchXferComplete.
+* Description    : IN packet sent: chain the next one of the transfer. After a
+*                  full last packet the transfer is extended with the data
+*                  received meanwhile, up to VCOMPORT_IN_MAX_TRANSFER bytes,
+*                  or terminated with a ZLP. A finished transfer hands over
+*                  to the other ports first.
+* Input          : Port: CDC-ACM port number.
+* Return         : none.
+*******************************************************************************/
+void Handle_USBAsynchXferComplete(uint8_t Port)
+{
+	VCP_PORT *pPort = &VCP_Port[Port];
+	uint32_t pending;
+	uint8_t i;
 
-			USART_Rx_ptr_out += VIRTUAL_COM_PORT_DATA_SIZE;
-			USART_Rx_length -= VIRTUAL_COM_PORT_DATA_SIZE;
-		} else {
-			USB_Tx_ptr = USART_Rx_ptr_out;
-			USB_Tx_length = USART_Rx_length;
+	if (pPort->USB_Tx_State != 1) {
+		return;
+	}
+
+	if ((pPort->Rx_length == 0)
+	    && (pPort->USB_Tx_Last == VIRTUAL_COM_PORT_DATA_SIZE)) {
+		pending = 0;
+		if (pPort->USB_Tx_Total < VCOMPORT_IN_MAX_TRANSFER) {
+			USART_Rx_Latch(Port);
+			pending = USART_Rx_Pending(Port);
+			if (pending > VCOMPORT_IN_MAX_TRANSFER
+			    - pPort->USB_Tx_Total) {
+				/* The rest keeps its age for the next transfer */
+				pending = VCOMPORT_IN_MAX_TRANSFER
+				    - pPort->USB_Tx_Total;
+			} else {
+				pPort->Rx_Held = 0;
+			}
+		}
+		pPort->Rx_length = pending;
+		pPort->USB_Tx_Total += pending;
+
+		/* Nothing to add: an empty Rx_length sends the ZLP */
+		USB_Tx_SendPacket(Port);
+		return;
+	}
+
+	if (pPort->Rx_length != 0) {
+		USB_Tx_SendPacket(Port);
+		return;
+	}
+
+	/* Short packet or ZLP sent: the transfer is over */
+	pPort->USB_Tx_State = 0;
+	for (i = 1; i <= VCP_PORTS; i++) {
+		Handle_PortXfer((Port + i) % VCP_PORTS);
+	}
+}
+
+/*******************************************************************************
+* Function Name  : USB_Tx_SendPacket.
+* Description    : Send the next packet of the port IN transfer from its ring.
+* Input          : Port: CDC-ACM port number.
+* Return         : none.
+*******************************************************************************/
+static void USB_Tx_SendPacket(uint8_t Port)
+{
+	const VCP_PORT_HW *pHw = &VCP_Port_Hw[Port];
+	VCP_PORT *pPort = &VCP_Port[Port];
+	uint8_t *src;
+	uint16_t len;
+	uint16_t first;
+	uint16_t i;
+
+	len = VIRTUAL_COM_PORT_DATA_SIZE;
+	if (pPort->Rx_length < len) {
+		len = pPort->Rx_length;
+	}
+
+	if (pPort->Rx_ptr_out == USART_RX_DATA_SIZE) {
+		pPort->Rx_ptr_out = 0;
+	}
 
-			USART_Rx_ptr_out += USART_Rx_length;
-			USART_Rx_length = 0;
+	if (pPort->Rx_ptr_out + len > USART_RX_DATA_SIZE) {
+		/* The PMA copy needs a contiguous source */
+		first = USART_RX_DATA_SIZE - pPort->Rx_ptr_out;
+		for (i = 0; i < first; i++) {
+			USB_Tx_Wrap[i] = pPort->Rx_Buffer[pPort->Rx_ptr_out + i];
 		}
-		USB_Tx_State = 1;
-		UserToPMABufferCopy(&USART_Rx_Buffer[USB_Tx_ptr], ENDP1_TXADDR,
-				    USB_Tx_length);
-		SetEPTxCount(ENDP1, USB_Tx_length);
-		SetEPTxValid(ENDP1);
+		for (i = first; i < len; i++) {
+			USB_Tx_Wrap[i] = pPort->Rx_Buffer[i - first];
+		}
+		src = USB_Tx_Wrap;
+		pPort->Rx_ptr_out = len - first;
+	} else {
+		src = &pPort->Rx_Buffer[pPort->Rx_ptr_out];
+		pPort->Rx_ptr_out += len;
+	}
+
+	pPort->Rx_length -= len;
+	pPort->USB_Tx_Last = len;
+
+	if (len == 0) {
+		VCP_In_Stats[Port].Zlps++;
+	} else {
+		VCP_In_Stats[Port].Packets++;
+		VCP_In_Stats[Port].Bytes += len;
+	}
+#if defined (VCP_FRAME_PORT)
+	if (VCP_FRAMED(Port)) {
+		VCP_Frame_Sent(len);
+	}
+#endif /* VCP_FRAME_PORT */
+	UserToPMABufferCopy(src, pHw->InAddr, len);
+	SetEPTxCount(pHw->InEp, len);
+	SetEPTxValid(pHw->InEp);
+}
+
+/*******************************************************************************
+* Function Name  : USART_Rx_Pending.
+* Description    : Number of bytes received and not yet given to USB.
+* Input          : Port: CDC-ACM port number.
+* Return         : byte count.
+*******************************************************************************/
+static uint32_t USART_Rx_Pending(uint8_t Port)
+{
+	VCP_PORT *pPort = &VCP_Port[Port];
+	uint32_t ptr_in = pPort->Rx_ptr_in;
+
+	if (pPort->Rx_ptr_out == USART_RX_DATA_SIZE) {
+		pPort->Rx_ptr_out = 0;
 	}
 
+	if (pPort->Rx_ptr_out > ptr_in) {	/* rollback */
+		return USART_RX_DATA_SIZE - pPort->Rx_ptr_out + ptr_in;
+	}
+
+	return ptr_in - pPort->Rx_ptr_out;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_In_Window.
+* Description    : Free part of a port IN ring, to be filled from Head (with
+*                  wrap) and published with VCP_In_Commit. For a port whose
+*                  USART reception is off, see VCP_FRAME_PORT.
+* Input          : Port: CDC-ACM port number.
+* Output         : Head: first free byte.
+*                  Free: free bytes.
+* Return         : IN ring base address, USART_RX_DATA_SIZE bytes.
+*******************************************************************************/
+uint8_t *VCP_In_Window(uint8_t Port, uint32_t * Head, uint32_t * Free)
+{
+	VCP_PORT *pPort = &VCP_Port[Port];
+	uint32_t ptr_out = pPort->Rx_ptr_out;
+
+	if (ptr_out == USART_RX_DATA_SIZE) {
+		ptr_out = 0;
+	}
+
+	*Head = pPort->Rx_ptr_in;
+	/* One byte kept free to tell a full ring from an empty one */
+	*Free = (ptr_out + USART_RX_DATA_SIZE - *Head - 1) % USART_RX_DATA_SIZE;
+
+	return pPort->Rx_Buffer;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_In_Commit.
+* Description    : Publish the bytes written in the IN ring up to Head. They
+*                  are flushed at the next SOF.
+* Input          : Port: CDC-ACM port number.
+*                  Head: first byte not written.
+* Return         : none.
+*******************************************************************************/
+void VCP_In_Commit(uint8_t Port, uint32_t Head)
+{
+	VCP_Port[Port].Rx_ptr_in = Head;
+	VCP_Port[Port].Rx_Idle = 1;
 }
 
 /*******************************************************************************
 * Function Name  : UART_To_USB_Send_Data.
-* Description    : send the received data from UART 0 to USB.
-* Input          : None.
+* Description    : USART interrupt of a port. On an idle line the data
+*                  received so far is sent to USB at the next SOF whatever
+*                  its size. Rx_ptr_in is only moved from the USB context.
+* Input          : Port: CDC-ACM port number.
 * Return         : none.
 *******************************************************************************/
-void USART_To_USB_Send_Data(void)
+void USART_To_USB_Send_Data(uint8_t Port)
 {
+	USART_TypeDef *usart = VCP_Port_Hw[Port].Usart;
 
-	if (linecoding.datatype == 7) {
-		USART_Rx_Buffer[USART_Rx_ptr_in] =
-		    USART_ReceiveData(EVAL_COM1) & 0x7F;
-	} else if (linecoding.datatype == 8) {
-		USART_Rx_Buffer[USART_Rx_ptr_in] = USART_ReceiveData(EVAL_COM1);
+	if (USART_GetITStatus(usart, USART_IT_IDLE) != RESET) {
+		/* The bytes are already in memory through the DMA */
+#if defined (STM32F30X) || defined (STM32F37X)
+		USART_ClearITPendingBit(usart, USART_IT_IDLE);
+#else
+		(void)USART_ReceiveData(usart);
+#endif
+		VCP_Port[Port].Rx_Idle = 1;
 	}
 
-	USART_Rx_ptr_in++;
+	/* If overrun condition occurs, clear the ORE flag and recover communication */
+	if (USART_GetFlagStatus(usart, USART_FLAG_ORE) != RESET) {
+		(void)USART_ReceiveData(usart);
+	}
+}
+
+/*******************************************************************************
+* Function Name  : USART_Rx_Latch.
+* Description    : Move Rx_ptr_in to the DMA write position. With 7 bits data
+*                  the parity bit is stripped from the new bytes.
+* Input          : Port: CDC-ACM port number.
+* Return         : none.
+*******************************************************************************/
+static void USART_Rx_Latch(uint8_t Port)
+{
+	VCP_PORT *pPort = &VCP_Port[Port];
+	uint32_t ptr_in;
+
+	if (VCP_FRAMED(Port)) {
+		return;
+	}
+
+	ptr_in =
+	    USART_RX_DATA_SIZE - DMA_GetCurrDataCounter(VCP_Port_Hw[Port].RxDma);
 
 	/* To avoid buffer overflow */
-	if (USART_Rx_ptr_in == USART_RX_DATA_SIZE) {
-		USART_Rx_ptr_in = 0;
+	if (ptr_in >= USART_RX_DATA_SIZE) {
+		ptr_in = 0;
 	}
+
+	if (linecoding[Port].datatype == 7) {
+		while (pPort->Rx_ptr_in != ptr_in) {
+			pPort->Rx_Buffer[pPort->Rx_ptr_in] &= 0x7F;
+			if (++pPort->Rx_ptr_in == USART_RX_DATA_SIZE) {
+				pPort->Rx_ptr_in = 0;
+			}
+		}
+	}
+
+	pPort->Rx_ptr_in = ptr_in;
 }
 
 /*******************************************************************************
@@ -30,6 +30,7 @@
 #include "usb_lib.h"
 #include "usb_desc.h"
 #include "usb_pwr.h"
+#include "vcp_frame.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -48,12 +49,26 @@
 *******************************************************************************/
 int main(void)
 {
+#if defined (VCP_FRAME_PORT)
+	VCP_FRAME *frame;
+#endif /* VCP_FRAME_PORT */
+
 	Set_System();
 	Set_USBClock();
 	USB_Interrupts_Config();
 	USB_Init();
 
 	while (1) {
+#if defined (VCP_FRAME_PORT)
+		/* Echo the received frames, each one released once queued */
+		frame = VCP_Frame_Get();
+		if (frame != NULL) {
+			while (VCP_Frame_Send(frame->Data, frame->Length) ==
+			       FALSE) {
+			}
+			VCP_Frame_Release(frame);
+		}
+#endif /* VCP_FRAME_PORT */
 	}
 }
 
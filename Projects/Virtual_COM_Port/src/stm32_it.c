@@ -32,6 +32,7 @@
 #include "stm32_it.h"
 #include "usb_lib.h"
 #include "usb_istr.h"
+#include "vcp_frame.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -169,6 +170,13 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
 #endif
 {
 	USB_Istr();
+
+	/* Resume the OUT pipe once the USART TX DMA has room again */
+	USART_Tx_Resume();
+#if defined (VCP_FRAME_PORT)
+	/* or once the application released a frame */
+	VCP_Frame_Resume();
+#endif /* VCP_FRAME_PORT */
 }
 
 /*******************************************************************************
@@ -180,16 +188,53 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
 *******************************************************************************/
 void EVAL_COM1_IRQHandler(void)
 {
-	if (USART_GetITStatus(EVAL_COM1, USART_IT_RXNE) != RESET) {
-		/* Send the received data to the PC Host */
-		USART_To_USB_Send_Data();
+	/* Idle line: send what was received to the PC Host */
+	USART_To_USB_Send_Data(0);
+}
+
+/*******************************************************************************
+* Function Name  : EVAL_COM1_TX_DMA_IRQHandler
+* Description    : This function handles EVAL_COM1 TX DMA interrupt request.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EVAL_COM1_TX_DMA_IRQHandler(void)
+{
+	if (DMA_GetITStatus(EVAL_COM1_TX_DMA_IT_TC) != RESET) {
+		DMA_ClearITPendingBit(EVAL_COM1_TX_DMA_IT_TC);
+		USART_Tx_DMA_Complete(0);
 	}
+}
+
+#if (VCP_PORTS > 1)
+/*******************************************************************************
+* Function Name  : EVAL_COM2_IRQHandler
+* Description    : This function handles EVAL_COM2 global interrupt request.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EVAL_COM2_IRQHandler(void)
+{
+	USART_To_USB_Send_Data(1);
+}
 
-	/* If overrun condition occurs, clear the ORE flag and recover communication */
-	if (USART_GetFlagStatus(EVAL_COM1, USART_FLAG_ORE) != RESET) {
-		(void)USART_ReceiveData(EVAL_COM1);
+/*******************************************************************************
+* Function Name  : EVAL_COM2_TX_DMA_IRQHandler
+* Description    : This function handles EVAL_COM2 TX DMA interrupt request.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EVAL_COM2_TX_DMA_IRQHandler(void)
+{
+	if (DMA_GetITStatus(EVAL_COM2_TX_DMA_IT_TC) != RESET) {
+		DMA_ClearITPendingBit(EVAL_COM2_TX_DMA_IT_TC);
+		USART_Tx_DMA_Complete(1);
 	}
 }
+#endif /* VCP_PORTS */
 
 /*******************************************************************************
 * Function Name  : USB_FS_WKUP_IRQHandler
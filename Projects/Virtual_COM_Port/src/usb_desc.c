@@ -35,9 +35,15 @@ const uint8_t Virtual_Com_Port_DeviceDescriptor[] = {
 	USB_DEVICE_DESCRIPTOR_TYPE,	/* bDescriptorType */
 	0x00,
 	0x02,			/* bcdUSB = 2.00 */
+#if (VCP_PORTS > 1)
+	0xEF,			/* bDeviceClass: Miscellaneous */
+	0x02,			/* bDeviceSubClass: Common Class */
+	0x01,			/* bDeviceProtocol: Interface Association Descriptor */
+#else
 	0x02,			/* bDeviceClass: CDC */
 	0x00,			/* bDeviceSubClass */
 	0x00,			/* bDeviceProtocol */
+#endif /* VCP_PORTS */
 	0x40,			/* bMaxPacketSize0 */
 	0x83,
 	0x04,			/* idVendor = 0x0483 */
@@ -57,11 +63,22 @@ const uint8_t Virtual_Com_Port_ConfigDescriptor[] = {
 	USB_CONFIGURATION_DESCRIPTOR_TYPE,	/* bDescriptorType: Configuration */
 	VIRTUAL_COM_PORT_SIZ_CONFIG_DESC,	/* wTotalLength:no of returned bytes */
 	0x00,
-	0x02,			/* bNumInterfaces: 2 interface */
+	2 * VCP_PORTS,		/* bNumInterfaces: 2 interfaces per port */
 	0x01,			/* bConfigurationValue: Configuration value */
 	0x00,			/* iConfiguration: Index of string descriptor describing the configuration */
 	0xC0,			/* bmAttributes: self powered */
 	0x32,			/* MaxPower 0 mA */
+#if (VCP_PORTS > 1)
+	/*Interface Association Descriptor: first port */
+	0x08,			/* bLength: IAD size */
+	0x0B,			/* bDescriptorType: Interface Association */
+	0x00,			/* bFirstInterface */
+	0x02,			/* bInterfaceCount */
+	0x02,			/* bFunctionClass: CDC */
+	0x02,			/* bFunctionSubClass: Abstract Control Model */
+	0x01,			/* bFunctionProtocol: Common AT commands */
+	0x00,			/* iFunction */
+#endif /* VCP_PORTS */
 	/*Interface Descriptor */
 	0x09,			/* bLength: Interface Descriptor size */
 	USB_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType: Interface */
@@ -130,6 +147,85 @@ const uint8_t Virtual_Com_Port_ConfigDescriptor[] = {
 	VIRTUAL_COM_PORT_DATA_SIZE,	/* wMaxPacketSize: */
 	0x00,
 	0x00			/* bInterval */
+#if (VCP_PORTS > 1)
+	,
+	/*Interface Association Descriptor: second port */
+	0x08,			/* bLength: IAD size */
+	0x0B,			/* bDescriptorType: Interface Association */
+	0x02,			/* bFirstInterface */
+	0x02,			/* bInterfaceCount */
+	0x02,			/* bFunctionClass: CDC */
+	0x02,			/* bFunctionSubClass: Abstract Control Model */
+	0x01,			/* bFunctionProtocol: Common AT commands */
+	0x00,			/* iFunction */
+	/*Interface Descriptor */
+	0x09,			/* bLength: Interface Descriptor size */
+	USB_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType: Interface */
+	0x02,			/* bInterfaceNumber: Number of Interface */
+	0x00,			/* bAlternateSetting: Alternate setting */
+	0x01,			/* bNumEndpoints: One endpoints used */
+	0x02,			/* bInterfaceClass: Communication Interface Class */
+	0x02,			/* bInterfaceSubClass: Abstract Control Model */
+	0x01,			/* bInterfaceProtocol: Common AT commands */
+	0x00,			/* iInterface: */
+	/*Header Functional Descriptor */
+	0x05,			/* bLength: Endpoint Descriptor size */
+	0x24,			/* bDescriptorType: CS_INTERFACE */
+	0x00,			/* bDescriptorSubtype: Header Func Desc */
+	0x10,			/* bcdCDC: spec release number */
+	0x01,
+	/*Call Management Functional Descriptor */
+	0x05,			/* bFunctionLength */
+	0x24,			/* bDescriptorType: CS_INTERFACE */
+	0x01,			/* bDescriptorSubtype: Call Management Func Desc */
+	0x00,			/* bmCapabilities: D0+D1 */
+	0x03,			/* bDataInterface: 3 */
+	/*ACM Functional Descriptor */
+	0x04,			/* bFunctionLength */
+	0x24,			/* bDescriptorType: CS_INTERFACE */
+	0x02,			/* bDescriptorSubtype: Abstract Control Management desc */
+	0x02,			/* bmCapabilities */
+	/*Union Functional Descriptor */
+	0x05,			/* bFunctionLength */
+	0x24,			/* bDescriptorType: CS_INTERFACE */
+	0x06,			/* bDescriptorSubtype: Union func desc */
+	0x02,			/* bMasterInterface: Communication class interface */
+	0x03,			/* bSlaveInterface0: Data Class Interface */
+	/*Endpoint 5 Descriptor */
+	0x07,			/* bLength: Endpoint Descriptor size */
+	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType: Endpoint */
+	0x85,			/* bEndpointAddress: (IN5) */
+	0x03,			/* bmAttributes: Interrupt */
+	VIRTUAL_COM_PORT_INT_SIZE,	/* wMaxPacketSize: */
+	0x00,
+	0xFF,			/* bInterval: */
+	/*Data class interface descriptor */
+	0x09,			/* bLength: Endpoint Descriptor size */
+	USB_INTERFACE_DESCRIPTOR_TYPE,	/* bDescriptorType: */
+	0x03,			/* bInterfaceNumber: Number of Interface */
+	0x00,			/* bAlternateSetting: Alternate setting */
+	0x02,			/* bNumEndpoints: Two endpoints used */
+	0x0A,			/* bInterfaceClass: CDC */
+	0x00,			/* bInterfaceSubClass: */
+	0x00,			/* bInterfaceProtocol: */
+	0x00,			/* iInterface: */
+	/*Endpoint 4 OUT Descriptor */
+	0x07,			/* bLength: Endpoint Descriptor size */
+	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType: Endpoint */
+	0x04,			/* bEndpointAddress: (OUT4) */
+	0x02,			/* bmAttributes: Bulk */
+	VIRTUAL_COM_PORT_DATA_SIZE,	/* wMaxPacketSize: */
+	0x00,
+	0x00,			/* bInterval: ignore for Bulk transfer */
+	/*Endpoint 4 IN Descriptor */
+	0x07,			/* bLength: Endpoint Descriptor size */
+	USB_ENDPOINT_DESCRIPTOR_TYPE,	/* bDescriptorType: Endpoint */
+	0x84,			/* bEndpointAddress: (IN4) */
+	0x02,			/* bmAttributes: Bulk */
+	VIRTUAL_COM_PORT_DATA_SIZE,	/* wMaxPacketSize: */
+	0x00,
+	0x00			/* bInterval */
+#endif /* VCP_PORTS */
 };
 
 /* USB String Descriptors */
@@ -32,22 +32,15 @@
 #include "hw_config.h"
 #include "usb_istr.h"
 #include "usb_pwr.h"
+#include "vcp_frame.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
-
-/* Interval between sending IN packets in frame number (1 frame = 1ms) */
-#define VCOMPORT_IN_FRAME_INTERVAL             5
-
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-uint8_t USB_Rx_Buffer[VIRTUAL_COM_PORT_DATA_SIZE];
-extern uint8_t USART_Rx_Buffer[];
-extern uint32_t USART_Rx_ptr_out;
-extern uint32_t USART_Rx_length;
-extern uint8_t USB_Tx_State;
-
 /* Private function prototypes -----------------------------------------------*/
+static void VCP_Out(uint8_t Port);
+
 /* Private functions ---------------------------------------------------------*/
 
 /*******************************************************************************
@@ -59,32 +52,8 @@ extern uint8_t USB_Tx_State;
 *******************************************************************************/
 void EP1_IN_Callback(void)
 {
-	uint16_t USB_Tx_ptr;
-	uint16_t USB_Tx_length;
-
-	if (USB_Tx_State == 1) {
-		if (USART_Rx_length == 0) {
-			USB_Tx_State = 0;
-		} else {
-			if (USART_Rx_length > VIRTUAL_COM_PORT_DATA_SIZE) {
-				USB_Tx_ptr = USART_Rx_ptr_out;
-				USB_Tx_length = VIRTUAL_COM_PORT_DATA_SIZE;
-
-				USART_Rx_ptr_out += VIRTUAL_COM_PORT_DATA_SIZE;
-				USART_Rx_length -= VIRTUAL_COM_PORT_DATA_SIZE;
-			} else {
-				USB_Tx_ptr = USART_Rx_ptr_out;
-				USB_Tx_length = USART_Rx_length;
-
-				USART_Rx_ptr_out += USART_Rx_length;
-				USART_Rx_length = 0;
-			}
-			UserToPMABufferCopy(&USART_Rx_Buffer[USB_Tx_ptr],
-					    ENDP1_TXADDR, USB_Tx_length);
-			SetEPTxCount(ENDP1, USB_Tx_length);
-			SetEPTxValid(ENDP1);
-		}
-	}
+	/* Chain the next packet of the transfer */
+	Handle_USBAsynchXferComplete(0);
 }
 
 /*******************************************************************************
@@ -96,19 +65,36 @@ void EP1_IN_Callback(void)
 *******************************************************************************/
 void EP3_OUT_Callback(void)
 {
-	uint16_t USB_Rx_Cnt;
-
-	/* Get the received data buffer and update the counter */
-	USB_Rx_Cnt = USB_SIL_Read(EP3_OUT, USB_Rx_Buffer);
-
-	/* USB data will be immediately processed, this allow next USB traffic being 
-	   NAKed till the end of the USART Xfer */
+	/* Queue the packet for the USART TX DMA, EP3 is only left NAKed while
+	   the ring is full */
+	VCP_Out(0);
+}
 
-	USB_To_USART_Send_Data(USB_Rx_Buffer, USB_Rx_Cnt);
+#if (VCP_PORTS > 1)
+/*******************************************************************************
+* Function Name  : EP4_IN_Callback
+* Description    : Data IN of the second port.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void EP4_IN_Callback(void)
+{
+	Handle_USBAsynchXferComplete(1);
+}
 
-	/* Enable the receive of data on EP3 */
-	SetEPRxValid(ENDP3);
+/*******************************************************************************
+* Function Name  : EP4_OUT_Callback
+* Description    : Data OUT of the second port.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void EP4_OUT_Callback(void)
+{
+	VCP_Out(1);
 }
+#endif /* VCP_PORTS */
 
 /*******************************************************************************
 * Function Name  : SOF_Callback / INTR_SOFINTR_Callback
@@ -119,17 +105,30 @@ void EP3_OUT_Callback(void)
 *******************************************************************************/
 void SOF_Callback(void)
 {
-	static uint32_t FrameCount = 0;
-
 	if (bDeviceState == CONFIGURED) {
-		if (FrameCount++ == VCOMPORT_IN_FRAME_INTERVAL) {
-			/* Reset the frame counter */
-			FrameCount = 0;
+		/* Check the data to be sent through IN pipe */
+		Handle_USBAsynchXfer();
+	}
+}
 
-			/* Check the data to be sent through IN pipe */
-			Handle_USBAsynchXfer();
-		}
+/*******************************************************************************
+* Function Name  : VCP_Out
+* Description    : Give an OUT packet to the USART bridge or to the frame
+*                  decoder of its port.
+* Input          : Port: CDC-ACM port number.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void VCP_Out(uint8_t Port)
+{
+#if defined (VCP_FRAME_PORT)
+	if (Port == VCP_FRAME_PORT) {
+		VCP_Frame_Receive();
+		return;
 	}
+#endif /* VCP_FRAME_PORT */
+
+	USB_To_USART_Send_Data(Port);
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -32,18 +32,27 @@
 #include "usb_desc.h"
 #include "usb_pwr.h"
 #include "hw_config.h"
+#include "vcp_frame.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 uint8_t Request = 0;
-
-LINE_CODING linecoding = {
-	115200,			/* baud rate */
-	0x00,			/* stop bits-1 */
-	0x00,			/* parity - none */
-	0x08			/* no. of bits 8 */
+/* Port addressed by the pending SET_LINE_CODING */
+static uint8_t Request_Port = 0;
+
+LINE_CODING linecoding[VCP_PORTS] = {
+	{
+	 115200,		/* baud rate */
+	 0x00,			/* stop bits-1 */
+	 0x00,			/* parity - none */
+	 0x08			/* no. of bits 8 */
+	 }
+#if (VCP_PORTS > 1)
+	,
+	{115200, 0x00, 0x00, 0x08}
+#endif
 };
 
 /* -------------------------------------------------------------------------- */
@@ -108,6 +117,8 @@ ONE_DESCRIPTOR String_Descriptor[4] = {
 
 /* Extern variables ----------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
+static uint8_t Virtual_Com_Port_GetPort(void);
+
 /* Extern function prototypes ------------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 /*******************************************************************************
@@ -119,6 +130,7 @@ ONE_DESCRIPTOR String_Descriptor[4] = {
 *******************************************************************************/
 void Virtual_Com_Port_init(void)
 {
+	uint8_t port;
 
 	/* Update the serial number string descriptor with the data from the unique
 	   ID */
@@ -132,8 +144,13 @@ void Virtual_Com_Port_init(void)
 	/* Perform basic device initialization operations */
 	USB_SIL_Init();
 
-	/* configure the USART to the default settings */
-	USART_Config_Default();
+	/* configure the USARTs to the default settings */
+	for (port = 0; port < VCP_PORTS; port++) {
+		USART_Config_Default(port);
+	}
+#if defined (VCP_FRAME_PORT)
+	VCP_Frame_Init();
+#endif /* VCP_FRAME_PORT */
 
 	bDeviceState = UNCONNECTED;
 }
@@ -186,6 +203,22 @@ void Virtual_Com_Port_Reset(void)
 	SetEPRxStatus(ENDP3, EP_RX_VALID);
 	SetEPTxStatus(ENDP3, EP_TX_DIS);
 
+#if (VCP_PORTS > 1)
+	/* Initialize Endpoint 4: data IN and OUT of the second port */
+	SetEPType(ENDP4, EP_BULK);
+	SetEPTxAddr(ENDP4, ENDP4_TXADDR);
+	SetEPTxStatus(ENDP4, EP_TX_NAK);
+	SetEPRxAddr(ENDP4, ENDP4_RXADDR);
+	SetEPRxCount(ENDP4, VIRTUAL_COM_PORT_DATA_SIZE);
+	SetEPRxStatus(ENDP4, EP_RX_VALID);
+
+	/* Initialize Endpoint 5: notifications of the second port */
+	SetEPType(ENDP5, EP_INTERRUPT);
+	SetEPTxAddr(ENDP5, ENDP5_TXADDR);
+	SetEPRxStatus(ENDP5, EP_RX_DIS);
+	SetEPTxStatus(ENDP5, EP_TX_NAK);
+#endif /* VCP_PORTS */
+
 	/* Set this device to response on default address */
 	SetDeviceAddress(0);
 
@@ -231,7 +264,7 @@ void Virtual_Com_Port_SetDeviceAddress(void)
 void Virtual_Com_Port_Status_In(void)
 {
 	if (Request == SET_LINE_CODING) {
-		USART_Config();
+		USART_Config(Request_Port);
 		Request = 0;
 	}
 }
@@ -269,6 +302,7 @@ RESULT Virtual_Com_Port_Data_Setup(uint8_t RequestNo)
 			CopyRoutine = Virtual_Com_Port_SetLineCoding;
 		}
 		Request = SET_LINE_CODING;
+		Request_Port = Virtual_Com_Port_GetPort();
 	}
 
 	if (CopyRoutine == NULL) {
@@ -358,7 +392,7 @@ RESULT Virtual_Com_Port_Get_Interface_Setting(uint8_t Interface,
 {
 	if (AlternateSetting > 0) {
 		return USB_UNSUPPORT;
-	} else if (Interface > 1) {
+	} else if (Interface > (2 * VCP_PORTS - 1)) {
 		return USB_UNSUPPORT;
 	}
 	return USB_SUCCESS;
@@ -374,10 +408,10 @@ RESULT Virtual_Com_Port_Get_Interface_Setting(uint8_t Interface,
 uint8_t *Virtual_Com_Port_GetLineCoding(uint16_t Length)
 {
 	if (Length == 0) {
-		pInformation->Ctrl_Info.Usb_wLength = sizeof(linecoding);
+		pInformation->Ctrl_Info.Usb_wLength = sizeof(LINE_CODING);
 		return NULL;
 	}
-	return (uint8_t *) & linecoding;
+	return (uint8_t *) & linecoding[Virtual_Com_Port_GetPort()];
 }
 
 /*******************************************************************************
@@ -390,10 +424,28 @@ uint8_t *Virtual_Com_Port_GetLineCoding(uint16_t Length)
 uint8_t *Virtual_Com_Port_SetLineCoding(uint16_t Length)
 {
 	if (Length == 0) {
-		pInformation->Ctrl_Info.Usb_wLength = sizeof(linecoding);
+		pInformation->Ctrl_Info.Usb_wLength = sizeof(LINE_CODING);
 		return NULL;
 	}
-	return (uint8_t *) & linecoding;
+	return (uint8_t *) & linecoding[Virtual_Com_Port_GetPort()];
+}
+
+/*******************************************************************************
+* Function Name  : Virtual_Com_Port_GetPort.
+* Description    : Port addressed by the current class request: each port
+*                  owns a communication and a data interface.
+* Input          : None.
+* Output         : None.
+* Return         : Port number.
+*******************************************************************************/
+static uint8_t Virtual_Com_Port_GetPort(void)
+{
+	uint8_t port = pInformation->USBwIndex0 / 2;
+
+	if (port >= VCP_PORTS) {
+		port = 0;
+	}
+	return port;
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
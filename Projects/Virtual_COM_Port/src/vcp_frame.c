@@ -0,0 +1,455 @@
+/**
+  ******************************************************************************
+  * @file    vcp_frame.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   COBS framed messages on the VCP_FRAME_PORT data pipes: OUT
+  *          packets are decoded from the packet memory straight into a pool
+  *          of frame buffers and outgoing frames are encoded straight into
+  *          the IN ring.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "usb_desc.h"
+#include "hw_config.h"
+#include "vcp_frame.h"
+
+#if defined (VCP_FRAME_PORT)
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+#if (VCP_FRAME_PORT >= VCP_PORTS)
+#error "VCP_FRAME_PORT is not a CDC-ACM port of the device"
+#elif (VCP_FRAME_PORT == 0)
+#define VCP_FRAME_EP                ENDP3
+#define VCP_FRAME_RXADDR            ENDP3_RXADDR
+#else
+#define VCP_FRAME_EP                ENDP4
+#define VCP_FRAME_RXADDR            ENDP4_RXADDR
+#endif /* VCP_FRAME_PORT */
+
+#if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)|| defined (STM32F37X)
+#define USB_LP_IRQ                  USB_LP_IRQn
+#else
+#define USB_LP_IRQ                  USB_LP_CAN1_RX0_IRQn
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+VCP_FRAME_STATS VCP_Frame_Stats;
+
+static VCP_FRAME VCP_Frame_Pool[VCP_FRAME_POOL];
+
+/* Buffer queues, free running indexes: the decoder takes from Free and gives
+   to Ready in the USB context, the application does the reverse */
+static uint8_t VCP_Frame_Free[VCP_FRAME_POOL];
+static __IO uint8_t VCP_Frame_Free_in;
+static __IO uint8_t VCP_Frame_Free_out;
+static uint8_t VCP_Frame_Ready[VCP_FRAME_POOL];
+static __IO uint8_t VCP_Frame_Ready_in;
+static __IO uint8_t VCP_Frame_Ready_out;
+
+/* Decoder: bytes left in the current COBS block, and whether the block ends
+   with a zero */
+static VCP_FRAME *VCP_Frame_Rx;
+static uint8_t VCP_Frame_Left;
+static uint8_t VCP_Frame_Zero;
+static uint8_t VCP_Frame_Error;
+
+/* OUT packet left in the packet memory while no buffer is free */
+static __IO uint8_t VCP_Frame_Parked;
+static uint16_t VCP_Frame_Offset;
+static uint16_t VCP_Frame_Count;
+
+/* Sent frames waiting for their last packet: bytes given to the endpoint
+   and position of the frame end, both free running */
+static uint32_t VCP_Frame_TxQueued;
+static __IO uint32_t VCP_Frame_TxSent;
+static uint32_t VCP_Frame_TxEnd[VCP_FRAME_TX_MARKS];
+static uint16_t VCP_Frame_TxStamp[VCP_FRAME_TX_MARKS];
+static __IO uint8_t VCP_Frame_TxMark_in;
+static __IO uint8_t VCP_Frame_TxMark_out;
+
+/* Extern variables ----------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+static void VCP_Frame_Decode(void);
+static void VCP_Frame_End(void);
+static uint16_t VCP_Frame_Now(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : VCP_Frame_Init.
+* Description    : Give all the buffers to the decoder and clear the
+*                  statistics.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Frame_Init(void)
+{
+	uint8_t *pStats = (uint8_t *) & VCP_Frame_Stats;
+	uint32_t i;
+
+	for (i = 0; i < sizeof(VCP_Frame_Stats); i++) {
+		pStats[i] = 0;
+	}
+
+	for (i = 0; i < VCP_FRAME_POOL; i++) {
+		VCP_Frame_Free[i] = i;
+	}
+	VCP_Frame_Free_in = VCP_FRAME_POOL;
+	VCP_Frame_Free_out = 0;
+	VCP_Frame_Ready_in = 0;
+	VCP_Frame_Ready_out = 0;
+
+	VCP_Frame_Rx = NULL;
+	VCP_Frame_Left = 0;
+	VCP_Frame_Zero = 0;
+	VCP_Frame_Error = 0;
+	VCP_Frame_Parked = 0;
+
+	VCP_Frame_TxQueued = 0;
+	VCP_Frame_TxSent = 0;
+	VCP_Frame_TxMark_in = 0;
+	VCP_Frame_TxMark_out = 0;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Frame_Receive.
+* Description    : OUT packet received: decode it in place. The endpoint is
+*                  re-armed once the whole packet is consumed.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Frame_Receive(void)
+{
+	VCP_Frame_Count = GetEPRxCount(VCP_FRAME_EP);
+	VCP_Frame_Offset = 0;
+
+	VCP_Frame_Decode();
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Frame_Resume.
+* Description    : Go on with a parked packet once a buffer is free again. To
+*                  be called from the USB context only.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Frame_Resume(void)
+{
+	if (VCP_Frame_Parked == 0) {
+		return;
+	}
+
+	/* A bus reset re-armed the endpoint, the packet is lost */
+	if (GetEPRxStatus(VCP_FRAME_EP) != EP_RX_NAK) {
+		VCP_Frame_Parked = 0;
+		VCP_Frame_Left = 0;
+		VCP_Frame_Error = 1;
+		return;
+	}
+
+	if (VCP_Frame_Free_in != VCP_Frame_Free_out) {
+		VCP_Frame_Parked = 0;
+		VCP_Frame_Decode();
+	}
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Frame_Sent.
+* Description    : IN packet queued on the endpoint: account the latency of
+*                  the frames it completes.
+* Input          : Length: size of the packet.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Frame_Sent(uint16_t Length)
+{
+	uint32_t latency;
+	uint8_t mark;
+
+	VCP_Frame_TxSent += Length;
+
+	while (VCP_Frame_TxMark_out != VCP_Frame_TxMark_in) {
+		mark = VCP_Frame_TxMark_out & (VCP_FRAME_TX_MARKS - 1);
+		if ((int32_t) (VCP_Frame_TxSent - VCP_Frame_TxEnd[mark]) < 0) {
+			break;
+		}
+
+		latency = (VCP_Frame_Now() - VCP_Frame_TxStamp[mark]) & FNR_FN;
+		VCP_Frame_Stats.TxLatencySum += latency;
+		if (latency > VCP_Frame_Stats.TxLatencyMax) {
+			VCP_Frame_Stats.TxLatencyMax = latency;
+		}
+		VCP_Frame_TxMark_out++;
+	}
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Frame_Get.
+* Description    : Oldest received frame, to be given back with
+*                  VCP_Frame_Release.
+* Input          : None.
+* Output         : None.
+* Return         : The frame, NULL when none is pending.
+*******************************************************************************/
+VCP_FRAME *VCP_Frame_Get(void)
+{
+	uint8_t index;
+
+	if (VCP_Frame_Ready_out == VCP_Frame_Ready_in) {
+		return NULL;
+	}
+
+	index = VCP_Frame_Ready[VCP_Frame_Ready_out & (VCP_FRAME_POOL - 1)];
+	VCP_Frame_Ready_out++;
+
+	return &VCP_Frame_Pool[index];
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Frame_Release.
+* Description    : Give a frame back to the decoder.
+* Input          : Frame: frame returned by VCP_Frame_Get.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void VCP_Frame_Release(VCP_FRAME * Frame)
+{
+	uint32_t latency;
+
+	latency = (VCP_Frame_Now() - Frame->Stamp) & FNR_FN;
+	VCP_Frame_Stats.RxLatencySum += latency;
+	if (latency > VCP_Frame_Stats.RxLatencyMax) {
+		VCP_Frame_Stats.RxLatencyMax = latency;
+	}
+
+	VCP_Frame_Free[VCP_Frame_Free_in & (VCP_FRAME_POOL - 1)] =
+	    Frame - VCP_Frame_Pool;
+	VCP_Frame_Free_in++;
+
+	/* The decoder waits for a buffer: resume it from the USB context */
+	if (VCP_Frame_Parked) {
+		NVIC_SetPendingIRQ(USB_LP_IRQ);
+	}
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Frame_Send.
+* Description    : COBS encode a frame with its delimiter into the IN ring.
+*                  The frame is flushed at the next SOF.
+* Input          : Data: payload.
+*                  Length: payload size.
+* Output         : None.
+* Return         : TRUE when queued, FALSE when the IN ring is full.
+*******************************************************************************/
+bool VCP_Frame_Send(const uint8_t * Data, uint16_t Length)
+{
+	uint8_t *ring;
+	uint32_t start;
+	uint32_t head;
+	uint32_t code_pos;
+	uint32_t free;
+	uint32_t needed;
+	uint8_t code;
+	uint8_t mark;
+	uint16_t i;
+
+	/* Code bytes, the one closing a full last block and the delimiter */
+	needed = Length + Length / 254 + 3;
+
+	ring = VCP_In_Window(VCP_FRAME_PORT, &start, &free);
+	if (free < needed) {
+		VCP_Frame_Stats.TxFull++;
+		return FALSE;
+	}
+
+	head = start;
+	code_pos = head;
+	head = (head + 1) % USART_RX_DATA_SIZE;
+	code = 1;
+
+	for (i = 0; i < Length; i++) {
+		if (Data[i] != 0) {
+			ring[head] = Data[i];
+			head = (head + 1) % USART_RX_DATA_SIZE;
+			code++;
+		}
+
+		if ((Data[i] == 0) || (code == 0xFF)) {
+			ring[code_pos] = code;
+			code_pos = head;
+			head = (head + 1) % USART_RX_DATA_SIZE;
+			code = 1;
+		}
+	}
+	ring[code_pos] = code;
+	ring[head] = 0;
+	head = (head + 1) % USART_RX_DATA_SIZE;
+
+	/* Latency mark on the delimiter, skipped when too many are pending */
+	VCP_Frame_TxQueued +=
+	    (head + USART_RX_DATA_SIZE - start) % USART_RX_DATA_SIZE;
+	if ((uint8_t) (VCP_Frame_TxMark_in - VCP_Frame_TxMark_out) <
+	    VCP_FRAME_TX_MARKS) {
+		mark = VCP_Frame_TxMark_in & (VCP_FRAME_TX_MARKS - 1);
+		VCP_Frame_TxEnd[mark] = VCP_Frame_TxQueued;
+		VCP_Frame_TxStamp[mark] = VCP_Frame_Now();
+		VCP_Frame_TxMark_in++;
+	}
+
+	VCP_Frame_Stats.TxFrames++;
+	VCP_In_Commit(VCP_FRAME_PORT, head);
+
+	return TRUE;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Frame_Decode.
+* Description    : Decode the current OUT packet from the packet memory. Parks
+*                  the packet when a new frame starts with no buffer free.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void VCP_Frame_Decode(void)
+{
+	__IO uint32_t *pma;
+	uint16_t word = 0;
+	uint8_t byte;
+
+	pma = (__IO uint32_t *) (PMAAddr +
+				 (VCP_FRAME_RXADDR +
+				  (VCP_Frame_Offset & ~1)) * 2);
+	if (VCP_Frame_Offset & 1) {
+		word = *pma++ >> 8;
+	}
+
+	while (VCP_Frame_Offset < VCP_Frame_Count) {
+		/* Two bytes per 32-bit packet memory word */
+		if ((VCP_Frame_Offset & 1) == 0) {
+			word = *pma++;
+		}
+		byte = (uint8_t) word;
+
+		if (byte == 0) {
+			VCP_Frame_End();
+		} else if (VCP_Frame_Left == 0) {
+			/* Code byte, a new frame needs a buffer */
+			if (VCP_Frame_Rx == NULL) {
+				if (VCP_Frame_Free_out == VCP_Frame_Free_in) {
+					VCP_Frame_Parked = 1;
+					VCP_Frame_Stats.RxParked++;
+					return;
+				}
+				VCP_Frame_Rx =
+				    &VCP_Frame_Pool[VCP_Frame_Free
+						    [VCP_Frame_Free_out &
+						     (VCP_FRAME_POOL - 1)]];
+				VCP_Frame_Free_out++;
+				VCP_Frame_Rx->Length = 0;
+				VCP_Frame_Zero = 0;
+				VCP_Frame_Error = 0;
+			}
+
+			if (VCP_Frame_Zero) {
+				if (VCP_Frame_Rx->Length < VCP_FRAME_MAX_SIZE) {
+					VCP_Frame_Rx->Data[VCP_Frame_Rx->
+							   Length++] = 0;
+				} else {
+					VCP_Frame_Error = 1;
+				}
+			}
+			VCP_Frame_Left = byte - 1;
+			VCP_Frame_Zero = (byte != 0xFF);
+		} else {
+			if (VCP_Frame_Rx->Length < VCP_FRAME_MAX_SIZE) {
+				VCP_Frame_Rx->Data[VCP_Frame_Rx->Length++] =
+				    byte;
+			} else {
+				VCP_Frame_Error = 1;
+			}
+			VCP_Frame_Left--;
+		}
+
+		word >>= 8;
+		VCP_Frame_Offset++;
+	}
+
+	SetEPRxValid(VCP_FRAME_EP);
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Frame_End.
+* Description    : Delimiter received: hand a complete frame to the
+*                  application, drop a broken one.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void VCP_Frame_End(void)
+{
+	if (VCP_Frame_Rx == NULL) {
+		/* Empty frame, or the rest of one broken by a bus reset */
+		VCP_Frame_Left = 0;
+		return;
+	}
+
+	if ((VCP_Frame_Left != 0) || VCP_Frame_Error) {
+		/* Truncated block or oversized frame: keep the buffer */
+		VCP_Frame_Stats.RxErrors++;
+		VCP_Frame_Rx->Length = 0;
+		VCP_Frame_Left = 0;
+		VCP_Frame_Zero = 0;
+		VCP_Frame_Error = 0;
+		return;
+	}
+
+	VCP_Frame_Rx->Stamp = VCP_Frame_Now();
+	VCP_Frame_Ready[VCP_Frame_Ready_in & (VCP_FRAME_POOL - 1)] =
+	    VCP_Frame_Rx - VCP_Frame_Pool;
+	VCP_Frame_Ready_in++;
+	VCP_Frame_Stats.RxFrames++;
+
+	VCP_Frame_Rx = NULL;
+}
+
+/*******************************************************************************
+* Function Name  : VCP_Frame_Now.
+* Description    : Current USB frame number.
+* Input          : None.
+* Output         : None.
+* Return         : Frame number.
+*******************************************************************************/
+static uint16_t VCP_Frame_Now(void)
+{
+	return GetFNR() & FNR_FN;
+}
+
+#endif /* VCP_FRAME_PORT */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,638 @@
+/**
+  ******************************************************************************
+  * @file    msc_bench.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Host throughput benchmark of the Mass_Storage BOT/SCSI stack.
+  *          usb_bot.c, usb_scsi.c, memory.c and scsi_data.c are linked
+  *          unchanged against a fake endpoint layer and a RAM disk, and
+  *          driven by a scripted host sending READ10/WRITE10 CBWs.
+  *
+  *          The USB full speed bus is modelled with BENCH_PACKETS_PER_FRAME
+  *          bulk packets of 64 bytes per 1 ms frame; the RAM disk may model
+  *          a media latency completing asynchronously through
+  *          MAL_Submit/MAL_Complete:
+  *           - a setup time and a throughput for every request,
+  *           - a seek time, up to the given value and proportional to the
+  *             distance, for a request not following the previous one,
+  *           - an erase stall for each erase block a write enters, the
+  *             first sector of a block written restarting its erase.
+  *          The disk is seeded with a random pattern before the first
+  *          scenario. For each scenario the benchmark reports:
+  *           - MB/s and bytes per frame over the modelled bus time,
+  *           - host CPU cycles (TSC) spent in the stack per 512 bytes sector,
+  *           - command latency percentiles, CBW to CSW, in bus time.
+  *          Every sector read back is checked against the data written.
+  *
+  *          Build and run on a PC from this directory:
+  *            gcc -O2 -include msc_bench_port.h -DMAL_MAX_BURST=4
+  *                -I../../../Projects/Mass_Storage/inc
+  *                -I../../../Libraries/STM32_USB-FS-Device_Driver/inc
+  *                -o msc_bench msc_bench.c
+  *                ../../../Projects/Mass_Storage/src/usb_bot.c
+  *                ../../../Projects/Mass_Storage/src/usb_scsi.c
+  *                ../../../Projects/Mass_Storage/src/memory.c
+  *                ../../../Projects/Mass_Storage/src/scsi_data.c
+  *            ./msc_bench [-n commands] [-s setup_us] [-r media_MBps]
+  *                        [-k seek_us] [-e erase_us]
+  *
+  *          -s 0 -r 0 -k 0 -e 0 gives an instantaneous, synchronous media.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "hw_config.h"
+#include "usb_lib.h"
+#include "usb_bot.h"
+#include "usb_scsi.h"
+#include "memory.h"
+#include "mass_mal.h"
+
+/* Warned again here, ignored by msc_bench_port.h in the stack sources */
+#pragma GCC diagnostic warning "-Wunused-parameter"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+	const char *Name;
+	uint8_t Write;
+	uint8_t Random;
+} BENCH_PATTERN;
+
+typedef struct {
+	uint8_t Busy;
+	uint8_t Dir;
+	uint32_t Offset;
+	uint32_t *Buff;
+	uint16_t Length;
+	uint16_t Status;
+	double Done;		/* completion date, us */
+} BENCH_SLOT;
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_DISK_SECTORS         32768	/* 16 MB RAM disk */
+#define BENCH_SECTOR_SIZE          512
+#define BENCH_PACKET_SIZE          64
+#define BENCH_PACKETS_PER_FRAME    19	/* bulk packets in a 1 ms FS frame */
+#define BENCH_PACKET_US            (1000.0 / BENCH_PACKETS_PER_FRAME)
+#define BENCH_STALL_US             1000000.0	/* no progress: deadlock */
+#define BENCH_DEFAULT_COMMANDS     2000
+#define BENCH_DEFAULT_SETUP_US     100.0
+#define BENCH_DEFAULT_MEDIA_MBPS   10.0
+#define BENCH_DEFAULT_SEEK_US      500.0	/* full stroke */
+#define BENCH_DEFAULT_ERASE_US     2000.0
+#define BENCH_ERASE_SIZE           (128 * 1024)	/* erase block, bytes */
+
+#define CBW_LENGTH                 31
+#define CSW_LENGTH                 13
+
+/* Private variables ---------------------------------------------------------*/
+/* Symbols the stack expects from the rest of the project */
+uint32_t Mass_Memory_Size[2];
+uint32_t Mass_Block_Size[2];
+uint32_t Mass_Block_Count[2];
+uint32_t Max_Lun = 0;
+
+/* Fake endpoints: one IN (EP1) and one OUT (EP2) packet buffer */
+static uint8_t EP1_Buffer[BENCH_PACKET_SIZE], EP2_Buffer[BENCH_PACKET_SIZE];
+static uint32_t EP1_Count, EP2_Count;
+static uint16_t EP1_Status = EP_TX_NAK, EP2_Status = EP_RX_NAK;
+
+/* RAM disk, the host shadow copy and the media model */
+static uint8_t Disk[BENCH_DISK_SECTORS * BENCH_SECTOR_SIZE];
+static uint8_t Shadow[BENCH_DISK_SECTORS * BENCH_SECTOR_SIZE];
+static BENCH_SLOT Slot[MAL_SLOTS];
+static double Media_Free;	/* date the media is idle again, us */
+static double Media_SetupUs = BENCH_DEFAULT_SETUP_US;
+static double Media_MBps = BENCH_DEFAULT_MEDIA_MBPS;
+static double Media_SeekUs = BENCH_DEFAULT_SEEK_US;
+static double Media_EraseUs = BENCH_DEFAULT_ERASE_US;
+static uint32_t Media_Next;	/* offset following the last request */
+static uint32_t Media_Erased = 0xFFFFFFFF;	/* erase block written last */
+static uint8_t Media_Irq;	/* a request completed since last resume */
+
+/* Bus time and measurements */
+static double Now;		/* us */
+static uint64_t Stack_Cycles;
+static uint32_t Submit_Stalls;
+static uint32_t Errors;
+static uint32_t Tag;
+static uint32_t Rand_State = 0x12345678;
+
+extern uint8_t Bot_State;
+
+static const BENCH_PATTERN Patterns[] = {
+	{"seq-read", 0, 0},
+	{"seq-write", 1, 0},
+	{"rand-read", 0, 1},
+	{"rand-write", 1, 1},
+};
+
+static const uint16_t Lengths[] = { 1, 8, 32, 64, 128 };
+
+/* Private function prototypes -----------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : Cycles
+* Description    : Host cycle counter (TSC), nanoseconds where not available.
+*******************************************************************************/
+static uint64_t Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/*******************************************************************************
+* Function Name  : Random
+* Description    : xorshift32 generator, reproducible between runs.
+*******************************************************************************/
+static uint32_t Random(void)
+{
+	Rand_State ^= Rand_State << 13;
+	Rand_State ^= Rand_State >> 17;
+	Rand_State ^= Rand_State << 5;
+	return Rand_State;
+}
+
+/*******************************************************************************
+* Fake USB SIL and endpoint register layer
+*******************************************************************************/
+uint32_t USB_SIL_Write(uint8_t bEpAddr, uint8_t * pBufferPointer,
+		       uint32_t wBufferSize)
+{
+	(void)bEpAddr;
+	memcpy(EP1_Buffer, pBufferPointer, wBufferSize);
+	EP1_Count = wBufferSize;
+	return 0;
+}
+
+uint32_t USB_SIL_Read(uint8_t bEpAddr, uint8_t * pBufferPointer)
+{
+	(void)bEpAddr;
+	memcpy(pBufferPointer, EP2_Buffer, EP2_Count);
+	return EP2_Count;
+}
+
+void SetEPTxStatus(uint8_t bEpNum, uint16_t wState)
+{
+	(void)bEpNum;
+	EP1_Status = wState;
+}
+
+void SetEPRxStatus(uint8_t bEpNum, uint16_t wState)
+{
+	(void)bEpNum;
+	EP2_Status = wState;
+}
+
+uint16_t GetEPRxStatus(uint8_t bEpNum)
+{
+	(void)bEpNum;
+	return EP2_Status;
+}
+
+void SetEPTxCount(uint8_t bEpNum, uint16_t wCount)
+{
+	(void)bEpNum;
+	EP1_Count = wCount;
+}
+
+void Led_RW_ON(void)
+{
+}
+
+void Led_RW_OFF(void)
+{
+}
+
+/*******************************************************************************
+* RAM disk behind the MAL interface
+*******************************************************************************/
+uint16_t MAL_Init(uint8_t lun)
+{
+	(void)lun;
+	return MAL_OK;
+}
+
+uint16_t MAL_GetStatus(uint8_t lun)
+{
+	Mass_Block_Count[0] = BENCH_DISK_SECTORS;
+	Mass_Block_Size[0] = BENCH_SECTOR_SIZE;
+	Mass_Memory_Size[0] = BENCH_DISK_SECTORS * BENCH_SECTOR_SIZE;
+	return (lun == 0) ? MAL_OK : MAL_FAIL;
+}
+
+uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t * Readbuff,
+		  uint16_t Transfer_Length)
+{
+	(void)lun;
+	memcpy(Readbuff, Disk + Memory_Offset, Transfer_Length);
+	return MAL_OK;
+}
+
+uint16_t MAL_Write(uint8_t lun, uint32_t Memory_Offset, uint32_t * Writebuff,
+		   uint16_t Transfer_Length)
+{
+	(void)lun;
+	memcpy(Disk + Memory_Offset, Writebuff, Transfer_Length);
+	return MAL_OK;
+}
+
+uint16_t MAL_GetMaxBlocks(uint8_t lun)
+{
+	(void)lun;
+	return MAL_MAX_BURST;
+}
+
+/*******************************************************************************
+* Function Name  : Media_Run
+* Description    : Completes the requests due at the current bus time. The data
+*                  is only moved at completion so that a buffer reused too
+*                  early by the stack shows up as a data mismatch.
+*******************************************************************************/
+static void Media_Run(void)
+{
+	uint8_t s;
+
+	for (s = 0; s < MAL_SLOTS; s++) {
+		if (Slot[s].Busy && (Slot[s].Done <= Now)) {
+			if (Slot[s].Dir == MAL_WRITE) {
+				MAL_Write(0, Slot[s].Offset, Slot[s].Buff,
+					  Slot[s].Length);
+			} else {
+				MAL_Read(0, Slot[s].Offset, Slot[s].Buff,
+					 Slot[s].Length);
+			}
+			Slot[s].Busy = 0;
+			Slot[s].Status = MAL_OK;
+			Media_Irq = 1;
+		}
+	}
+}
+
+uint16_t MAL_Submit(uint8_t lun, uint8_t s, uint8_t Dir,
+		    uint32_t Memory_Offset, uint32_t * Buff,
+		    uint16_t Transfer_Length)
+{
+	uint32_t first = Memory_Offset / BENCH_ERASE_SIZE;
+	uint32_t last = (Memory_Offset + Transfer_Length - 1) / BENCH_ERASE_SIZE;
+	uint32_t distance;
+	double start;
+
+	(void)lun;
+
+	/* the device would spin here: let the bus time run instead */
+	if (Slot[s].Busy) {
+		Submit_Stalls++;
+		Now = Slot[s].Done;
+		Media_Run();
+	}
+
+	Slot[s].Dir = Dir;
+	Slot[s].Offset = Memory_Offset;
+	Slot[s].Buff = Buff;
+	Slot[s].Length = Transfer_Length;
+	Slot[s].Busy = 1;
+
+	start = (Media_Free > Now) ? Media_Free : Now;
+	Slot[s].Done = start + Media_SetupUs;
+	if (Media_MBps != 0) {
+		Slot[s].Done += Transfer_Length / Media_MBps;
+	}
+	if (Memory_Offset != Media_Next) {
+		distance = (Memory_Offset > Media_Next)
+		    ? Memory_Offset - Media_Next : Media_Next - Memory_Offset;
+		Slot[s].Done += Media_SeekUs * distance / sizeof(Disk);
+	}
+	if (Dir == MAL_WRITE) {
+		Slot[s].Done += Media_EraseUs * (last - first
+						 + (first != Media_Erased));
+		Media_Erased = last;
+	}
+	Media_Next = Memory_Offset + Transfer_Length;
+	Media_Free = Slot[s].Done;
+	Media_Run();
+	return MAL_OK;
+}
+
+uint16_t MAL_Complete(uint8_t s)
+{
+	return Slot[s].Busy ? MAL_BUSY : Slot[s].Status;
+}
+
+void MAL_Process(void)
+{
+	Media_Run();
+}
+
+/*******************************************************************************
+* Function Name  : Stack_Call
+* Description    : Runs one USB interrupt worth of stack code: the endpoint
+*                  callback, if any, then Memory_Resume() as USB_LP_IRQHandler
+*                  does. Only this code is accounted in Stack_Cycles.
+*******************************************************************************/
+static void Stack_Call(void (*Callback) (void))
+{
+	uint64_t start = Cycles();
+
+	if (Callback != 0) {
+		Callback();
+	}
+	Memory_Resume();
+	Stack_Cycles += Cycles() - start;
+}
+
+/*******************************************************************************
+* Function Name  : Next_Event
+* Description    : Bus idle: jump to the next media completion or SOF.
+*******************************************************************************/
+static void Next_Event(void)
+{
+	double next = ((uint64_t) (Now / 1000.0) + 1) * 1000.0;	/* next SOF */
+	uint8_t s;
+
+	for (s = 0; s < MAL_SLOTS; s++) {
+		if (Slot[s].Busy && (Slot[s].Done < next)) {
+			next = (Slot[s].Done > Now) ? Slot[s].Done : Now;
+		}
+	}
+	Now = next;
+}
+
+/*******************************************************************************
+* Function Name  : Run_Command
+* Description    : Runs one READ10 or WRITE10 command, CBW to CSW, and
+*                  checks the data read back and the CSW.
+* Return         : Command latency in us of bus time, negative on error.
+*******************************************************************************/
+static double Run_Command(uint8_t Write, uint32_t LBA, uint16_t Blocks)
+{
+	uint8_t cbw[CBW_LENGTH];
+	uint32_t length = Blocks * BENCH_SECTOR_SIZE, in = 0, out = 0;
+	double start = Now, progress = Now;
+	uint8_t *shadow = Shadow + LBA * BENCH_SECTOR_SIZE;
+	uint32_t i;
+
+	if (EP2_Status != EP_RX_VALID) {
+		fprintf(stderr, "device not ready for a CBW\n");
+		return -1;
+	}
+
+	if (Write) {
+		for (i = 0; i < length; i += 4) {
+			*(uint32_t *) (shadow + i) = Random();
+		}
+	}
+
+	memset(cbw, 0, sizeof(cbw));
+	*(uint32_t *) & cbw[0] = BOT_CBW_SIGNATURE;
+	*(uint32_t *) & cbw[4] = ++Tag;
+	*(uint32_t *) & cbw[8] = length;
+	cbw[12] = Write ? 0x00 : 0x80;
+	cbw[14] = 10;
+	cbw[15] = Write ? SCSI_WRITE10 : SCSI_READ10;
+	cbw[17] = LBA >> 24;
+	cbw[18] = LBA >> 16;
+	cbw[19] = LBA >> 8;
+	cbw[20] = LBA;
+	cbw[22] = Blocks >> 8;
+	cbw[23] = Blocks;
+
+	memcpy(EP2_Buffer, cbw, CBW_LENGTH);
+	EP2_Count = CBW_LENGTH;
+	EP2_Status = EP_RX_NAK;
+	Now += BENCH_PACKET_US;
+	Stack_Call(Mass_Storage_Out);
+
+	for (;;) {
+		Media_Run();
+		if (Media_Irq) {
+			Media_Irq = 0;
+			Stack_Call(0);
+		}
+
+		if ((EP1_Status == EP_TX_STALL) || (EP2_Status == EP_RX_STALL)) {
+			fprintf(stderr, "tag %u: endpoint stalled\n", Tag);
+			return -1;
+		}
+
+		if (EP1_Status == EP_TX_VALID) {
+			EP1_Status = EP_TX_NAK;
+			Now += BENCH_PACKET_US;
+			progress = Now;
+
+			if ((EP1_Count == CSW_LENGTH)
+			    && (*(uint32_t *) EP1_Buffer == BOT_CSW_SIGNATURE)) {
+				if ((*(uint32_t *) & EP1_Buffer[4] != Tag)
+				    || (*(uint32_t *) & EP1_Buffer[8] != 0)
+				    || (EP1_Buffer[12] != CSW_CMD_PASSED)
+				    || (in + out != length)) {
+					fprintf(stderr, "tag %u: bad CSW\n",
+						Tag);
+					return -1;
+				}
+				Stack_Call(Mass_Storage_In);
+				return Now - start;
+			}
+
+			if (Write || (in + EP1_Count > length)) {
+				fprintf(stderr, "tag %u: unexpected data\n",
+					Tag);
+				return -1;
+			}
+			if (memcmp(EP1_Buffer, shadow + in, EP1_Count)) {
+				Errors++;
+			}
+			in += EP1_Count;
+			Stack_Call(Mass_Storage_In);
+		} else if (Write && (out < length)
+			   && (EP2_Status == EP_RX_VALID)) {
+			memcpy(EP2_Buffer, shadow + out, BENCH_PACKET_SIZE);
+			EP2_Count = BENCH_PACKET_SIZE;
+			EP2_Status = EP_RX_NAK;
+			out += BENCH_PACKET_SIZE;
+			Now += BENCH_PACKET_US;
+			progress = Now;
+			Stack_Call(Mass_Storage_Out);
+		} else {
+			/* nothing to move: the SOF interrupt runs the stack */
+			Next_Event();
+			if (Now - progress > BENCH_STALL_US) {
+				fprintf(stderr, "tag %u: no progress\n", Tag);
+				return -1;
+			}
+			Stack_Call(0);
+		}
+	}
+}
+
+/*******************************************************************************
+* Function Name  : Seed
+* Description    : Fills the disk and its shadow copy with a random pattern, so
+*                  that the read scenarios check real data.
+*******************************************************************************/
+static void Seed(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < sizeof(Shadow); i += 4) {
+		*(uint32_t *) (Shadow + i) = Random();
+	}
+	memcpy(Disk, Shadow, sizeof(Disk));
+}
+
+/*******************************************************************************
+* Function Name  : Compare_Double
+* Description    : qsort helper.
+*******************************************************************************/
+static int Compare_Double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*******************************************************************************
+* Function Name  : Run_Scenario
+* Description    : Runs a number of commands of one pattern and one transfer
+*                  length and prints one result line.
+*******************************************************************************/
+static int Run_Scenario(const BENCH_PATTERN * Pattern, uint16_t Blocks,
+			uint32_t Commands)
+{
+	double *latency, start = Now, bus, mbps;
+	uint64_t cycles = Stack_Cycles;
+	uint32_t cmd, lba = 0, errors = Errors, stalls = Submit_Stalls;
+	uint64_t bytes = 0;
+
+	latency = malloc(Commands * sizeof(double));
+	if (latency == NULL) {
+		return -1;
+	}
+
+	for (cmd = 0; cmd < Commands; cmd++) {
+		if (Pattern->Random) {
+			lba = Random() % (BENCH_DISK_SECTORS - Blocks + 1);
+		} else if (lba + Blocks > BENCH_DISK_SECTORS) {
+			lba = 0;
+		}
+
+		latency[cmd] = Run_Command(Pattern->Write, lba, Blocks);
+		if (latency[cmd] < 0) {
+			free(latency);
+			return -1;
+		}
+		bytes += Blocks * BENCH_SECTOR_SIZE;
+		lba += Blocks;
+	}
+
+	qsort(latency, Commands, sizeof(double), Compare_Double);
+	bus = Now - start;
+	mbps = bytes / bus;
+
+	printf("%-10s %5u %8.3f %7.1f %9.0f %8.0f %8.0f %8.0f %8.0f %6u %s\n",
+	       Pattern->Name, Blocks, mbps, bytes / (bus / 1000.0),
+	       (double)(Stack_Cycles - cycles) / (bytes / BENCH_SECTOR_SIZE),
+	       latency[Commands / 2], latency[(Commands * 9) / 10],
+	       latency[(Commands * 99) / 100], latency[Commands - 1],
+	       Submit_Stalls - stalls, (Errors == errors) ? "ok" : "MISMATCH");
+
+	free(latency);
+	return 0;
+}
+
+/*******************************************************************************
+* Function Name  : main
+*******************************************************************************/
+int main(int argc, char **argv)
+{
+	uint32_t commands = BENCH_DEFAULT_COMMANDS;
+	uint32_t p, l;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:s:r:k:e:")) != -1) {
+		switch (opt) {
+		case 'n':
+			commands = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			Media_SetupUs = atof(optarg);
+			break;
+		case 'r':
+			Media_MBps = atof(optarg);
+			break;
+		case 'k':
+			Media_SeekUs = atof(optarg);
+			break;
+		case 'e':
+			Media_EraseUs = atof(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-n commands] [-s setup_us]"
+				" [-r media_MBps] [-k seek_us] [-e erase_us]\n",
+				argv[0]);
+			return 2;
+		}
+	}
+	if (commands == 0) {
+		commands = 1;
+	}
+
+	/* The same start up as the device: media sized, BOT idle */
+	MAL_GetStatus(0);
+	Bot_State = BOT_IDLE;
+	EP2_Status = EP_RX_VALID;
+	Seed();
+
+	printf("bus: %u packets/frame, media: %.0f us setup, %.1f MB/s, "
+	       "%.0f us seek, %.0f us erase, burst %u blocks, %u slots\n",
+	       BENCH_PACKETS_PER_FRAME, Media_SetupUs, Media_MBps,
+	       Media_SeekUs, Media_EraseUs, MAL_MAX_BURST, MAL_SLOTS);
+	printf("%-10s %5s %8s %7s %9s %8s %8s %8s %8s %6s\n", "pattern",
+	       "blks", "MB/s", "B/frame", "cyc/sect", "p50 us", "p90 us",
+	       "p99 us", "max us", "stall");
+
+	for (p = 0; p < sizeof(Patterns) / sizeof(Patterns[0]); p++) {
+		for (l = 0; l < sizeof(Lengths) / sizeof(Lengths[0]); l++) {
+			if (Run_Scenario(&Patterns[p], Lengths[l], commands)) {
+				return 1;
+			}
+		}
+	}
+
+	return Errors ? 1 : 0;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file    msc_bench_port.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Host port of the Mass_Storage BOT/SCSI sources: force included
+  *          before each of them in place of the device specific platform
+  *          configuration.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MSC_BENCH_PORT_H
+#define __MSC_BENCH_PORT_H
+
+/* The project platform_config.h pulls the STM32 device and board headers:
+   mark it as already included and provide the few types it brings */
+#define __PLATFORM_CONFIG_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* The stack sources are linked unchanged: their handlers keep the lun
+   parameter of the command table prototype whether they use it or not */
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum { DISABLE = 0, ENABLE = !DISABLE } FunctionalState;
+
+/* Exported constants --------------------------------------------------------*/
+#define __IO    volatile
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+
+#endif /* __MSC_BENCH_PORT_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
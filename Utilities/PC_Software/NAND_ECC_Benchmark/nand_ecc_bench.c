@@ -0,0 +1,162 @@
+/**
+  ******************************************************************************
+  * @file    nand_ecc_bench.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Host benchmark of the Mass_Storage NAND Hamming ECC kernel:
+  *          syndrome generation and single bit correction throughput.
+  *
+  *          Build and run on a PC from this directory:
+  *            gcc -O2 -I../../../Projects/Mass_Storage/inc -o nand_ecc_bench
+  *                nand_ecc_bench.c ../../../Projects/Mass_Storage/src/nand_ecc.c
+  *            ./nand_ecc_bench [pages]
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nand_ecc.h"
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_POOL_PAGES           64	/* distinct pages cycled through */
+#define BENCH_DEFAULT_PAGES        200000
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t Pool[BENCH_POOL_PAGES][NAND_ECC_BLOCK_SIZE];
+static uint32_t PoolECC[BENCH_POOL_PAGES];
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : Now
+* Description    : Monotonic time in seconds.
+*******************************************************************************/
+static double Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*******************************************************************************
+* Function Name  : Check_Kernel
+* Description    : Exhaustive single bit correction and double bit detection
+*                  check on one page. Returns the number of failures.
+*******************************************************************************/
+static uint32_t Check_Kernel(void)
+{
+	uint8_t page[NAND_ECC_BLOCK_SIZE], ref[NAND_ECC_BLOCK_SIZE];
+	uint32_t ecc, bit, failures = 0;
+
+	memcpy(ref, Pool[0], sizeof(ref));
+	ecc = NAND_ECC_Calculate(ref);
+
+	for (bit = 0; bit < NAND_ECC_BLOCK_SIZE * 8; bit++) {
+		memcpy(page, ref, sizeof(page));
+		page[bit >> 3] ^= (uint8_t) (1 << (bit & 7));
+		if ((NAND_ECC_Correct(page, ecc, NAND_ECC_Calculate(page)) !=
+		     NAND_ECC_CORRECTED) || memcmp(page, ref, sizeof(page))) {
+			failures++;
+		}
+
+		page[(bit * 7 + 13) % NAND_ECC_BLOCK_SIZE] ^= 0x10;
+		page[bit >> 3] ^= (uint8_t) (1 << (bit & 7));
+		if (((bit * 7 + 13) % NAND_ECC_BLOCK_SIZE) != (bit >> 3)
+		    && NAND_ECC_Correct(page, ecc, NAND_ECC_Calculate(page)) !=
+		    NAND_ECC_UNCORRECTABLE) {
+			failures++;
+		}
+	}
+
+	for (bit = 0; bit < 24; bit++) {
+		memcpy(page, ref, sizeof(page));
+		if ((NAND_ECC_Correct(page, ecc ^ (1 << bit), ecc) !=
+		     NAND_ECC_CODE_ERROR) || memcmp(page, ref, sizeof(page))) {
+			failures++;
+		}
+	}
+
+	/* An erased page must match an erased (inverted) ECC field */
+	memset(page, 0xFF, sizeof(page));
+	if (NAND_ECC_Calculate(page) != 0) {
+		failures++;
+	}
+
+	return failures;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t pages = BENCH_DEFAULT_PAGES, index, sink = 0, failures;
+	double start, generate, correct, mbytes;
+
+	if (argc > 1) {
+		pages = (uint32_t) strtoul(argv[1], NULL, 0);
+	}
+
+	srand(0x5A5A);
+	for (index = 0; index < BENCH_POOL_PAGES * NAND_ECC_BLOCK_SIZE; index++) {
+		((uint8_t *) Pool)[index] = (uint8_t) rand();
+	}
+	for (index = 0; index < BENCH_POOL_PAGES; index++) {
+		PoolECC[index] = NAND_ECC_Calculate(Pool[index]);
+	}
+
+	failures = Check_Kernel();
+	printf("kernel check       : %s (%u failures)\n",
+	       failures ? "FAILED" : "passed", failures);
+
+	/* Syndrome generation only, as done on every page write */
+	start = Now();
+	for (index = 0; index < pages; index++) {
+		sink ^= NAND_ECC_Calculate(Pool[index % BENCH_POOL_PAGES]);
+	}
+	generate = Now() - start;
+
+	/* Read path: regenerate, compare and fix one flipped bit per page */
+	start = Now();
+	for (index = 0; index < pages; index++) {
+		uint8_t *page = Pool[index % BENCH_POOL_PAGES];
+		uint32_t bit = (index * 2654435761u) % (NAND_ECC_BLOCK_SIZE * 8);
+
+		page[bit >> 3] ^= (uint8_t) (1 << (bit & 7));
+		sink ^= NAND_ECC_Correct(page, PoolECC[index % BENCH_POOL_PAGES],
+					 NAND_ECC_Calculate(page));
+	}
+	correct = Now() - start;
+
+	mbytes = (double)pages * NAND_ECC_BLOCK_SIZE / (1024.0 * 1024.0);
+	printf("pages              : %u x %u bytes\n", pages,
+	       NAND_ECC_BLOCK_SIZE);
+	printf("generate           : %8.1f MB/s (%6.1f ns/page)\n",
+	       mbytes / generate, generate * 1e9 / pages);
+	printf("check + correct    : %8.1f MB/s (%6.1f ns/page)\n",
+	       mbytes / correct, correct * 1e9 / pages);
+	printf("(sink %08x)\n", sink);
+
+	return failures ? 1 : 0;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+#
+# @file    vcp_bench.py
+# @author  MCD Application Team
+# @version V4.0.0
+# @date    21-January-2013
+# @brief   Host side of the VirtualComport_Loopback benchmark mode: drives
+#          the device source/sink through pyusb and reads back its
+#          statistics.
+#
+# COPYRIGHT 2013 STMicroelectronics
+#
+# Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+# You may not use this file except in compliance with the License.
+# You may obtain a copy of the License at:
+#
+#        http://www.st.com/software_license_agreement_liberty_v2
+#
+# Usage: vcp_bench.py [-m source|sink|both] [-t seconds]
+#
+# The CDC driver is detached from the device for the run (root or a udev
+# rule granting access to 0483:5740 is needed on Linux).
+
+import argparse
+import struct
+import threading
+import time
+
+import usb.core
+import usb.util
+
+VID, PID = 0x0483, 0x5740
+EP_IN, EP_OUT = 0x81, 0x03
+
+VCP_BENCH_START = 0x51
+VCP_BENCH_STOP = 0x52
+VCP_BENCH_GET_STATS = 0x53
+VCP_BENCH_SOURCE = 0x01
+VCP_BENCH_SINK = 0x02
+VCP_BENCH_SEED = 0x2545F491
+
+STATS_FIELDS = ("Mode", "Frames", "InPackets", "InBytes", "OutPackets",
+                "OutBytes", "OutErrors", "MaxInPerFrame", "MaxOutPerFrame")
+VENDOR_OUT = 0x40               # vendor, device recipient, host to device
+VENDOR_IN = 0xC0
+
+CHUNK = 64 * 64
+
+
+class Prbs:
+    """Byte stream of the device xorshift32 generator (vcp_bench.c)."""
+
+    def __init__(self):
+        self.state = VCP_BENCH_SEED
+        self.left = b""
+
+    def take(self, n):
+        out = bytearray(self.left)
+        x = self.state
+        while len(out) < n:
+            x ^= (x << 13) & 0xFFFFFFFF
+            x ^= x >> 17
+            x ^= (x << 5) & 0xFFFFFFFF
+            out += struct.pack("<I", x)
+        self.state = x
+        self.left = bytes(out[n:])
+        return bytes(out[:n])
+
+
+def source(dev, stop, result):
+    prbs, total, errors = Prbs(), 0, 0
+    while not stop.is_set():
+        try:
+            data = bytes(dev.read(EP_IN, CHUNK, timeout=1000))
+        except usb.core.USBTimeoutError:
+            continue
+        expect = prbs.take(len(data))
+        errors += sum(1 for a, b in zip(data, expect) if a != b)
+        total += len(data)
+    result["in"], result["in_errors"] = total, errors
+
+
+def sink(dev, stop, result):
+    prbs, total, data = Prbs(), 0, b""
+    while not stop.is_set():
+        if not data:
+            data = prbs.take(CHUNK)
+        try:
+            sent = dev.write(EP_OUT, data, timeout=1000)
+        except usb.core.USBTimeoutError:
+            continue
+        total += sent
+        data = data[sent:]
+    result["out"] = total
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-m", "--mode", default="both",
+                        choices=("source", "sink", "both"))
+    parser.add_argument("-t", "--time", type=float, default=10.0)
+    args = parser.parse_args()
+
+    mode = {"source": VCP_BENCH_SOURCE, "sink": VCP_BENCH_SINK,
+            "both": VCP_BENCH_SOURCE | VCP_BENCH_SINK}[args.mode]
+
+    dev = usb.core.find(idVendor=VID, idProduct=PID)
+    if dev is None:
+        raise SystemExit("VirtualComport_Loopback device not found")
+    for intf in (0, 1):
+        if dev.is_kernel_driver_active(intf):
+            dev.detach_kernel_driver(intf)
+    usb.util.claim_interface(dev, 1)
+
+    stop, result, threads = threading.Event(), {}, []
+    dev.ctrl_transfer(VENDOR_OUT, VCP_BENCH_START, mode, 0, None)
+    start = time.monotonic()
+    if mode & VCP_BENCH_SOURCE:
+        threads.append(threading.Thread(target=source,
+                                         args=(dev, stop, result)))
+    if mode & VCP_BENCH_SINK:
+        threads.append(threading.Thread(target=sink,
+                                        args=(dev, stop, result)))
+    for t in threads:
+        t.start()
+    time.sleep(args.time)
+    stop.set()
+    for t in threads:
+        t.join()
+    elapsed = time.monotonic() - start
+
+    raw = dev.ctrl_transfer(VENDOR_IN, VCP_BENCH_GET_STATS, 0, 0,
+                            4 * len(STATS_FIELDS))
+    dev.ctrl_transfer(VENDOR_OUT, VCP_BENCH_STOP, 0, 0, None)
+    stats = dict(zip(STATS_FIELDS, struct.unpack("<%dI" % len(STATS_FIELDS),
+                                                 bytes(raw))))
+    usb.util.release_interface(dev, 1)
+
+    print("host: %.1f s" % elapsed)
+    if "in" in result:
+        print("  IN   %8.1f kB/s  %d pattern errors"
+              % (result["in"] / elapsed / 1000, result["in_errors"]))
+    if "out" in result:
+        print("  OUT  %8.1f kB/s" % (result["out"] / elapsed / 1000))
+    print("device:")
+    for name in STATS_FIELDS:
+        print("  %-15s %d" % (name, stats[name]))
+    if stats["Frames"]:
+        print("  IN  packets/frame %.2f (max %d)"
+              % (stats["InPackets"] / stats["Frames"],
+                 stats["MaxInPerFrame"]))
+        print("  OUT packets/frame %.2f (max %d)"
+              % (stats["OutPackets"] / stats["Frames"],
+                 stats["MaxOutPerFrame"]))
+
+
+if __name__ == "__main__":
+    main()
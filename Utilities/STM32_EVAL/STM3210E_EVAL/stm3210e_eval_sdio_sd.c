@@ -182,6 +182,24 @@
   *
   *            // Read operation as described in Section B
   *            Status = SD_ReadBlock(buffer, address, 512);
+  *
+  *          G - Programming Model (Queued asynchronous requests)
+  *          ====================================================
+  *            // Up to SD_QUEUE_DEPTH multi-block requests may be outstanding.
+  *            // They are run in order from the SDIO and DMA interrupts; the
+  *            // caller only polls req.State or waits for req.Callback.
+  *            req.Buffer = buffer;
+  *            req.Addr = address;
+  *            req.NumberOfBlocks = NUMBEROFBLOCKS;
+  *            req.Write = 0;
+  *            req.Callback = 0;
+  *            Status = SD_SubmitRequest(&req);
+  *            ...
+  *            if (req.State == SD_REQ_DONE) Status = req.Status;
+  *
+  *            // The card has no busy interrupt: after a write the end of the
+  *            // programming phase is only seen by polling, so SD_ProcessQueue()
+  *            // must also be called periodically (e.g. every USB SOF).
   *                 
   *          STM32 SDIO Pin assignment
   *          =========================
@@ -349,6 +367,11 @@ __IO SD_Error TransferError = SD_OK;
 __IO uint32_t TransferEnd = 0, DMAEndOfTransfer = 0;
 SD_CardInfo SDCardInfo;
 
+/* Asynchronous request queue, the head entry owns the bus */
+static SD_Request *SD_Queue[SD_QUEUE_DEPTH];
+static __IO uint8_t SD_QueueHead = 0, SD_QueueCount = 0;
+static __IO uint8_t SD_QueueLock = 0, SD_QueueKick = 0;
+
 SDIO_InitTypeDef SDIO_InitStructure;
 SDIO_CmdInitTypeDef SDIO_CmdInitStructure;
 SDIO_DataInitTypeDef SDIO_DataInitStructure;
@@ -369,6 +392,8 @@ static SD_Error SDEnWideBus(FunctionalState NewState);
 static SD_Error IsCardProgramming(uint8_t * pstatus);
 static SD_Error FindSCR(uint16_t rca, uint32_t * pscr);
 uint8_t convert_from_bytes_to_power_of_two(uint16_t NumberOfBytes);
+static void SD_QueueStep(void);
+static void SD_QueueComplete(SD_Request * req);
 
 /**
   * @}
@@ -1941,6 +1966,10 @@ SD_Error SD_ProcessIRQSrc(void)
 	SDIO_ITConfig(SDIO_IT_DCRCFAIL | SDIO_IT_DTIMEOUT | SDIO_IT_DATAEND |
 		      SDIO_IT_TXFIFOHE | SDIO_IT_RXFIFOHF | SDIO_IT_TXUNDERR |
 		      SDIO_IT_RXOVERR | SDIO_IT_STBITERR, DISABLE);
+
+	/*!< Complete the queued request owning the bus, if any */
+	SD_ProcessQueue();
+
 	return (TransferError);
 }
 
@@ -1956,6 +1985,175 @@ void SD_ProcessDMAIRQ(void)
 		DMA_ClearFlag(DMA2_FLAG_TC4 | DMA2_FLAG_TE4 | DMA2_FLAG_HT4 |
 			      DMA2_FLAG_GL4);
 	}
+
+	/*!< Complete the queued request owning the bus, if any */
+	SD_ProcessQueue();
+}
+
+/**
+  * @brief  Queues an asynchronous multi-block read or write request.
+  *         The request is started as soon as the previous ones are over and
+  *         completes from the SDIO and DMA interrupts: req->State becomes
+  *         SD_REQ_DONE, req->Status holds the result and req->Callback, if
+  *         any, is called from the completing context.
+  * @note   The request and its buffer must stay untouched until it is done.
+  * @param  req: pointer to the request, Buffer, Addr, NumberOfBlocks, Write
+  *         and Callback fields filled.
+  * @retval SD_Error: SD_OK if queued, SD_ERROR if the queue is full.
+  */
+SD_Error SD_SubmitRequest(SD_Request * req)
+{
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (SD_QueueCount >= SD_QUEUE_DEPTH) {
+		__set_PRIMASK(primask);
+		return (SD_ERROR);
+	}
+
+	req->Status = SD_OK;
+	req->State = SD_REQ_QUEUED;
+	SD_Queue[(SD_QueueHead + SD_QueueCount) % SD_QUEUE_DEPTH] = req;
+	SD_QueueCount++;
+
+	__set_PRIMASK(primask);
+
+	SD_ProcessQueue();
+
+	return (SD_OK);
+}
+
+/**
+  * @brief  Advances the asynchronous request queue. Called from the SDIO and
+  *         DMA interrupts and, to detect the end of the card busy phase which
+  *         raises no interrupt, periodically by the application.
+  * @note   A call made while another context is running the queue is only
+  *         recorded; the running pass will take it into account.
+  * @param  None
+  * @retval None
+  */
+void SD_ProcessQueue(void)
+{
+	SD_QueueKick = 1;
+
+	if (SD_QueueLock) {
+		return;
+	}
+	SD_QueueLock = 1;
+
+	while (SD_QueueKick) {
+		SD_QueueKick = 0;
+		SD_QueueStep();
+	}
+
+	SD_QueueLock = 0;
+}
+
+/**
+  * @brief  Runs one step of the request owning the bus.
+  * @param  None
+  * @retval None
+  */
+static void SD_QueueStep(void)
+{
+	SD_Request *req;
+	SDTransferState transferstate;
+
+	if (SD_QueueCount == 0) {
+		return;
+	}
+
+	req = SD_Queue[SD_QueueHead];
+
+	switch (req->State) {
+	case SD_REQ_QUEUED:
+		DMAEndOfTransfer = 0x00;
+		req->State = SD_REQ_DATA;
+
+		if (req->Write) {
+			req->Status =
+			    SD_WriteMultiBlocks(req->Buffer, req->Addr, 512,
+						req->NumberOfBlocks);
+		} else {
+			req->Status =
+			    SD_ReadMultiBlocks(req->Buffer, req->Addr, 512,
+					       req->NumberOfBlocks);
+		}
+
+		if (req->Status != SD_OK) {
+			SD_QueueComplete(req);
+		}
+		break;
+
+	case SD_REQ_DATA:
+		if (TransferError != SD_OK) {
+			/*!< The DMA will not end by itself */
+			DMA_Cmd(SD_SDIO_DMA_CHANNEL, DISABLE);
+			SD_StopTransfer();
+			req->Status = TransferError;
+		} else if ((TransferEnd != 0) && (DMAEndOfTransfer != 0x00)
+			   && !(SDIO->STA & (SDIO_FLAG_RXACT | SDIO_FLAG_TXACT))) {
+			req->Status = SD_StopTransfer();
+		} else {
+			/*!< Data still moving, wait for the other interrupt */
+			break;
+		}
+
+		DMAEndOfTransfer = 0x00;
+		SDIO_ClearFlag(SDIO_STATIC_FLAGS);
+
+		if (req->Status != SD_OK) {
+			SD_QueueComplete(req);
+		} else {
+			req->State = SD_REQ_BUSY;
+			SD_QueueKick = 1;
+		}
+		break;
+
+	case SD_REQ_BUSY:
+		/*!< One CMD13 per call, the card may be programming for ms */
+		transferstate = SD_GetStatus();
+
+		if (transferstate == SD_TRANSFER_BUSY) {
+			break;
+		}
+		if (transferstate == SD_TRANSFER_ERROR) {
+			req->Status = SD_ERROR;
+		}
+		SD_QueueComplete(req);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+  * @brief  Removes the head request from the queue and reports it.
+  * @param  req: pointer to the head request.
+  * @retval None
+  */
+static void SD_QueueComplete(SD_Request * req)
+{
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	SD_QueueHead = (SD_QueueHead + 1) % SD_QUEUE_DEPTH;
+	SD_QueueCount--;
+
+	__set_PRIMASK(primask);
+
+	/*!< Start the next request in the same pass */
+	SD_QueueKick = 1;
+
+	req->State = SD_REQ_DONE;
+	if (req->Callback != 0) {
+		req->Callback(req);
+	}
 }
 
 /**
@@ -219,6 +219,30 @@ extern "C" {
 		uint8_t CardType;
 	} SD_CardInfo;
 
+/** 
+  * @brief SD asynchronous request state
+  */
+	typedef enum {
+		SD_REQ_IDLE = 0,	/*!< Never submitted */
+		SD_REQ_QUEUED,	/*!< Waiting for the previous requests */
+		SD_REQ_DATA,	/*!< Data phase on the bus */
+		SD_REQ_BUSY,	/*!< Waiting for the card to return to transfer state */
+		SD_REQ_DONE	/*!< Finished, Status holds the result */
+	} SDRequestState;
+
+/** 
+  * @brief SD asynchronous multi-block request
+  */
+	typedef struct _SD_Request {
+		uint8_t *Buffer;	/*!< Word aligned data buffer */
+		uint64_t Addr;	/*!< Byte address on the card */
+		uint32_t NumberOfBlocks;	/*!< Number of 512 bytes blocks */
+		uint8_t Write;	/*!< 0: read from the card, 1: write to the card */
+		void (*Callback) (struct _SD_Request * req);	/*!< Completion hook, may be 0 */
+		__IO SDRequestState State;
+		__IO SD_Error Status;
+	} SD_Request;
+
 /**
   * @}
   */
@@ -330,6 +354,11 @@ extern "C" {
 #define SDIO_SECURE_DIGITAL_IO_COMBO_CARD          ((uint32_t)0x00000006)
 #define SDIO_HIGH_CAPACITY_MMC_CARD                ((uint32_t)0x00000007)
 
+/** 
+  * @brief Maximum number of outstanding asynchronous requests
+  */
+#define SD_QUEUE_DEPTH                             ((uint8_t)4)
+
 /**
   * @}
   */
@@ -375,6 +404,8 @@ extern "C" {
 	void SD_ProcessDMAIRQ(void);
 	SD_Error SD_WaitReadOperation(void);
 	SD_Error SD_WaitWriteOperation(void);
+	SD_Error SD_SubmitRequest(SD_Request * req);
+	void SD_ProcessQueue(void);
 #ifdef __cplusplus
 }
 #endif